@@ -16,12 +16,18 @@
 
 #include "complex_vector_split.h"
 #include "complex_vectorised_matrix.h"
+#include "gemm_engine.h"
 #include "hilbert_namespace.h"
+#include "kronecker_operator.h"
 #include "lazy_operation.h"
 #include "operation.h"
+#include "scratch_arena.h"
 #include "simd.h"
+#include "split_span.h"
 #include <complex>
 #include <memory>
+#include <span>
+#include <vector>
 
 /*
  * Conjugate transpose
@@ -35,7 +41,22 @@ Complex conjugate_transpose_lazy(const ComplexVectMatrix &left,
 std::unique_ptr<ComplexVectSplit>
 conjugate_transpose_row(const ComplexVectMatrix &left,
                         const ComplexVectMatrix &right, const size_t row) {
-  return left.get_column(row)->conj();
+  auto result = std::make_unique<ComplexVectSplit>(left.row_size());
+  left.column(row).gather(result->span(), true);
+  return result;
+}
+
+/*
+ * @return a split vector of `size` elements borrowed from the calling thread's
+ * `ScratchArena`, padded like a `ComplexVectSplit`. It lives until the
+ * enclosing `ScratchArena::Scope` ends, which each function gathering into it
+ * opens.
+ */
+SplitSpan scratch_span(const size_t size) {
+  auto &arena = ScratchArena::local();
+  const auto length = ComplexVectSplit::padded(size);
+  return SplitSpan(std::span(arena.allocate(size), length),
+                   std::span(arena.allocate(size), length), size);
 }
 
 /*
@@ -44,145 +65,178 @@ conjugate_transpose_row(const ComplexVectMatrix &left,
 Complex inner_product_mat_mat(const ComplexVectMatrix &left,
                               const ComplexVectMatrix &right, const size_t m,
                               const size_t n) {
-
-  auto left_split = left.split()->conj();
-  auto right_split = right.split();
-
-  auto elements = simd::cvmul(*left_split, *right_split);
-
-  __complex_precision result_real = 0;
-  __complex_precision result_imag = 0;
-
-  return simd::cvsve(*elements);
+  return simd::cdotc(left.row(0), right.row(0));
 }
 
 std::unique_ptr<ComplexVectSplit>
 inner_product_mat_mat_row(const ComplexVectMatrix &left,
                           const ComplexVectMatrix &right, const size_t row) {
-  ComplexVectSplit result;
-  result.add(inner_product_mat_mat(left, right, 0, 0));
-  return std::make_unique<ComplexVectSplit>(result);
+  auto result = std::make_unique<ComplexVectSplit>(1);
+  result->set(0, inner_product_mat_mat(left, right, 0, 0));
+  return result;
 }
 
 /*
- * Row-column multiplication
+ * Gathers column `col` of the lazy matrix `mat` into `result`.
+ */
+void gather_column(const Operation &mat, const size_t col,
+                   const SplitSpan result) {
+  for (size_t m = 0; m < mat.row_size(); m++) {
+    result.set(m, mat.get(m, col));
+  }
+}
+
+/*
+ * Row-column multiplication. A single element is the dot product of a row and
+ * a column, while a whole row is built as the sum of the rows of `right`
+ * scaled by the elements of the row of `left`, so that only contiguous rows
+ * are read.
  */
 Complex matrix_multiplication_op_op(const Operation &left,
                                     const Operation &right, const size_t row,
                                     const size_t col) {
+  ScratchArena::Scope scope;
   auto vect_left = left.get(row);
-  ComplexVectSplit vect_right;
-  for (size_t m = 0; m < right.row_size(); m++) {
-    vect_right.add(right.get(m, col));
-  }
-
-  auto elements = simd::cvmul(*vect_left, vect_right);
-
-  return simd::cvsve(*elements);
+  const auto vect_right = scratch_span(right.row_size());
+  gather_column(right, col, vect_right);
+  return simd::cdotu(*vect_left, vect_right);
 }
 
 std::unique_ptr<ComplexVectSplit>
 matrix_multiplication_op_op_row(const Operation &left, const Operation &right,
                                 const size_t row) {
-  ComplexVectSplit result;
-  for (size_t n = 0; n < right.row_size(); n++) {
-    result.add(matrix_multiplication_op_op(left, right, row, n));
+  auto row_left = left.get(row);
+  auto result = std::make_unique<ComplexVectSplit>(right.column_size());
+  for (size_t k = 0; k < right.row_size(); k++) {
+    simd::caxpy(row_left->get(k), *right.get(k), result->span());
   }
-  return std::make_unique<ComplexVectSplit>(result);
+  return result;
 }
 
 Complex matrix_multiplication_mat_mat(const ComplexVectMatrix &left,
                                       const ComplexVectMatrix &right,
                                       const size_t row, const size_t col) {
-  auto vect_left = left.get_row(row);
-  ComplexVectSplit vect_right;
-  for (size_t m = 0; m < right.row_size(); m++) {
-    vect_right.add(right.get(m, col));
-  }
-
-  auto elements = simd::cvmul(*vect_left, vect_right);
-
-  return simd::cvsve(*elements);
+  ScratchArena::Scope scope;
+  const auto vect_right = scratch_span(right.row_size());
+  right.column(col).gather(vect_right);
+  return simd::cdotu(left.row(row), vect_right);
 }
 
 std::unique_ptr<ComplexVectSplit>
 matrix_multiplication_mat_mat_row(const ComplexVectMatrix &left,
                                   const ComplexVectMatrix &right,
                                   const size_t row) {
-  auto row_left = left.get_row(row);
-  ComplexVectSplit result;
-  for (size_t n = 0; n < right.column_size(); n++) {
-    auto column_right = right.get_column(n);
-    auto elements = simd::cvmul(*row_left, *column_right);
-    result.add(simd::cvsve(*elements));
-  }
-  return std::make_unique<ComplexVectSplit>(result);
-}
-
-Complex matrix_multiplication_op_mat(const Operation &left,
-                                     const ComplexVectMatrix &right,
-                                     const size_t row, const size_t col) {
-  auto vect_left = left.get(row);
-  auto vect_right = right.get_column(col);
-
-  auto elements = simd::cvmul(*vect_left, *vect_right);
-
-  return simd::cvsve(*elements);
-}
-
-std::unique_ptr<ComplexVectSplit> matrix_multiplication_op_mat_row(
-    const Operation &left, const ComplexVectMatrix &right, const size_t row) {
-  auto row_left = left.get(row);
-  ComplexVectSplit result;
-  for (size_t n = 0; n < right.column_size(); n++) {
-    auto column_right = right.get_column(n);
-    auto elements = simd::cvmul(*row_left, *column_right);
-    result.add(simd::cvsve(*elements));
+  const auto row_left = left.row(row);
+  auto result = std::make_unique<ComplexVectSplit>(right.column_size());
+  for (size_t k = 0; k < right.row_size(); k++) {
+    simd::caxpy(row_left.get(k), right.row(k), result->span());
   }
-  return std::make_unique<ComplexVectSplit>(result);
+  return result;
 }
 
+/*
+ * Matrix-vector product. Vectors are 1xN rows, and the right-hand operand may
+ * hold several of them: row `row` of the result is the product of the matrix
+ * by row `row` of the right-hand operand. Once both are materialised, the
+ * whole result is computed by `GemmEngine::multiply_vectors`.
+ */
 Complex matrix_vector_mul_mat_mat(const ComplexVectMatrix &left,
                                   const ComplexVectMatrix &right,
                                   const size_t row, const size_t col) {
-  auto vect_left = left.get_row(col);
-  auto vect_right = right.split();
-  auto elements = simd::cvmul(*vect_left, *vect_right);
-  return simd::cvsve(*elements);
+  return simd::cdotu(left.row(col), right.row(row));
+}
+
+std::unique_ptr<ComplexVectSplit>
+matrix_vector_mul_mat_mat_range(const ComplexVectMatrix &left,
+                                const ComplexVectMatrix &right,
+                                const size_t row, const size_t col_begin,
+                                const size_t col_end) {
+  auto result = std::make_unique<ComplexVectSplit>(col_end - col_begin);
+  for (size_t col = col_begin; col < col_end; col++) {
+    result->set(col - col_begin, simd::cdotu(left.row(col), right.row(row)));
+  }
+  return result;
 }
 
 std::unique_ptr<ComplexVectSplit>
 matrix_vector_mul_mat_mat_row(const ComplexVectMatrix &left,
                               const ComplexVectMatrix &right,
                               const size_t row) {
-  ComplexVectSplit result;
-  for (size_t col = 0; col < right.column_size(); col++) {
-    result.add(matrix_vector_mul_mat_mat(left, right, row, col));
+  return matrix_vector_mul_mat_mat_range(left, right, row, 0,
+                                         left.row_size());
+}
+
+Complex matrix_vector_mul_op_mat(const Operation &left,
+                                 const ComplexVectMatrix &right,
+                                 const size_t row, const size_t col) {
+  return simd::cdotu(*left.get(col), right.row(row));
+}
+
+std::unique_ptr<ComplexVectSplit>
+matrix_vector_mul_op_mat_range(const Operation &left,
+                               const ComplexVectMatrix &right,
+                               const size_t row, const size_t col_begin,
+                               const size_t col_end) {
+  auto result = std::make_unique<ComplexVectSplit>(col_end - col_begin);
+  for (size_t col = col_begin; col < col_end; col++) {
+    result->set(col - col_begin, simd::cdotu(*left.get(col), right.row(row)));
   }
-  return std::make_unique<ComplexVectSplit>(result);
+  return result;
+}
+
+std::unique_ptr<ComplexVectSplit>
+matrix_vector_mul_op_mat_row(const Operation &left,
+                             const ComplexVectMatrix &right,
+                             const size_t row) {
+  return matrix_vector_mul_op_mat_range(left, right, row, 0, left.row_size());
 }
 
 Complex matrix_vector_mul_op_op(const Operation &left, const Operation &right,
                                 const size_t row, const size_t col) {
-  auto vect_left = left.get(col);
-  ComplexVectSplit vect_right;
-  for (size_t m = 0; m < right.column_size(); m++) {
-    vect_right.add(right.get(0, m));
-  }
-
-  auto elements = simd::cvmul(*vect_left, vect_right);
+  return simd::cdotu(*left.get(col), *right.get(row));
+}
 
-  return simd::cvsve(*elements);
+std::unique_ptr<ComplexVectSplit>
+matrix_vector_mul_op_op_range(const Operation &left, const Operation &right,
+                              const size_t row, const size_t col_begin,
+                              const size_t col_end) {
+  auto vect_right = right.get(row);
+  auto result = std::make_unique<ComplexVectSplit>(col_end - col_begin);
+  for (size_t col = col_begin; col < col_end; col++) {
+    result->set(col - col_begin, simd::cdotu(*left.get(col), *vect_right));
+  }
+  return result;
 }
 
 std::unique_ptr<ComplexVectSplit>
 matrix_vector_mul_op_op_row(const Operation &left, const Operation &right,
                             const size_t row) {
-  ComplexVectSplit result;
-  for (size_t col = 0; col < right.column_size(); col++) {
-    result.add(matrix_vector_mul_op_op(left, right, row, col));
+  return matrix_vector_mul_op_op_range(left, right, row, 0, left.row_size());
+}
+
+size_t matrix_vector_final_row_size(size_t row_size_left,
+                                    size_t column_size_left,
+                                    size_t row_size_right,
+                                    size_t column_size_right) {
+  return row_size_right;
+}
+
+size_t matrix_vector_final_column_size(size_t row_size_left,
+                                       size_t column_size_left,
+                                       size_t row_size_right,
+                                       size_t column_size_right) {
+  return row_size_left;
+}
+
+/*
+ * @throws std::invalid_argument if the vectors do not have as many elements
+ * as the matrix has columns.
+ */
+void check_matrix_vector_sizes(const size_t mat_column_size,
+                               const size_t vect_column_size) {
+  if (mat_column_size != vect_column_size) {
+    throw std::invalid_argument("Matrix and vector sizes do not match");
   }
-  return std::make_unique<ComplexVectSplit>(result);
 }
 
 size_t matrix_multiplication_final_row_size(size_t row_size_left,
@@ -217,6 +271,16 @@ outer_product_mat_mat_row(const ComplexVectMatrix &left,
   return simd::cvsmul(*vect_right, scal_left);
 }
 
+std::unique_ptr<ComplexVectSplit>
+outer_product_mat_mat_range(const ComplexVectMatrix &left,
+                            const ComplexVectMatrix &right, const size_t row,
+                            const size_t col_begin, const size_t col_end) {
+  auto scal_left = left.get(0, row);
+  auto vect_right = right.get_row(0, col_begin, col_end)->conj();
+
+  return simd::cvsmul(*vect_right, scal_left);
+}
+
 /*
  * Scalar Product
  */
@@ -229,9 +293,19 @@ Complex scalar_product_mat_mat(const ComplexVectMatrix &left,
 std::unique_ptr<ComplexVectSplit>
 scalar_product_mat_mat_row(const ComplexVectMatrix &left,
                            const ComplexVectMatrix &right, const size_t row) {
-  auto vect_left = left.get_row(row);
-  auto k = right.get(0, 0);
-  return simd::cvsmul(*vect_left, k);
+  auto result = std::make_unique<ComplexVectSplit>(left.column_size());
+  simd::caxpy(right.get(0, 0), left.row(row), result->span());
+  return result;
+}
+
+std::unique_ptr<ComplexVectSplit>
+scalar_product_mat_mat_range(const ComplexVectMatrix &left,
+                             const ComplexVectMatrix &right, const size_t row,
+                             const size_t col_begin, const size_t col_end) {
+  auto result = std::make_unique<ComplexVectSplit>(col_end - col_begin);
+  simd::caxpy(right.get(0, 0), *left.get_row(row, col_begin, col_end),
+              result->span());
+  return result;
 }
 
 /*
@@ -246,10 +320,18 @@ Complex sum_mat_mat(const ComplexVectMatrix &left,
 std::unique_ptr<ComplexVectSplit>
 sum_mat_mat_row(const ComplexVectMatrix &left, const ComplexVectMatrix &right,
                 const size_t row) {
-  auto vect_left = left.get_row(row);
-  auto vect_right = right.get_row(row);
+  auto result = std::make_unique<ComplexVectSplit>(left.row(row));
+  simd::caxpy(1, right.row(row), result->span());
+  return result;
+}
 
-  return simd::cvadd(*vect_left, *vect_right);
+std::unique_ptr<ComplexVectSplit>
+sum_mat_mat_range(const ComplexVectMatrix &left,
+                  const ComplexVectMatrix &right, const size_t row,
+                  const size_t col_begin, const size_t col_end) {
+  auto result = left.get_row(row, col_begin, col_end);
+  simd::caxpy(1, *right.get_row(row, col_begin, col_end), result->span());
+  return result;
 }
 
 Complex sum_op_op(const Operation &left, const Operation &right, const size_t m,
@@ -259,10 +341,18 @@ Complex sum_op_op(const Operation &left, const Operation &right, const size_t m,
 
 std::unique_ptr<ComplexVectSplit>
 sum_op_op_row(const Operation &left, const Operation &right, const size_t row) {
-  auto vect_left = left.get(row);
-  auto vect_right = right.get(row);
+  auto result = left.get(row);
+  simd::caxpy(1, *right.get(row), result->span());
+  return result;
+}
 
-  return simd::cvadd(*vect_left, *vect_right);
+std::unique_ptr<ComplexVectSplit>
+sum_op_op_range(const Operation &left, const Operation &right,
+                const size_t row, const size_t col_begin,
+                const size_t col_end) {
+  auto result = left.get(row, col_begin, col_end);
+  simd::caxpy(1, *right.get(row, col_begin, col_end), result->span());
+  return result;
 }
 
 size_t sum_row_size(const size_t left_row_size, const size_t left_column_size,
@@ -299,79 +389,101 @@ Complex tensor_product_op_mat(const Operation &left,
 
 /*
  * Tensor product left-hand elements, given the left-hand matrix of the
- * operation and the range.
+ * operation and the columns [col_begin, col_end) of the resulting row.
  */
 std::unique_ptr<ComplexVectSplit> tplhe(const ComplexVectMatrix &left,
-                                        const size_t row, const size_t row_size,
+                                        const size_t row,
+                                        const size_t col_begin,
+                                        const size_t col_end,
                                         const size_t right_row_size,
                                         const size_t right_column_size) {
   return left.get(
-      row_size,
+      col_end - col_begin,
       [row, right_row_size](size_t i) -> size_t {
         return row / right_row_size;
       },
-      [right_column_size](size_t i) -> size_t {
-        return i / right_column_size;
+      [col_begin, right_column_size](size_t i) -> size_t {
+        return (col_begin + i) / right_column_size;
       });
 }
 
 std::unique_ptr<ComplexVectSplit> tplhe(const Operation &left, const size_t row,
-                                        const size_t row_size,
+                                        const size_t col_begin,
+                                        const size_t col_end,
                                         const size_t right_row_size,
                                         const size_t right_column_size) {
   ComplexVectSplit result;
   size_t m = row / right_row_size;
-  auto left_row = left.get(m);
-  for (size_t n = 0; n < row_size; n++) {
-    result.add(left_row->get(n / right_column_size));
+  const auto left_begin = col_begin / right_column_size;
+  const auto left_end =
+      (col_end + right_column_size - 1) / right_column_size;
+  auto left_row = left.get(m, left_begin, left_end);
+  for (size_t n = col_begin; n < col_end; n++) {
+    result.add(left_row->get(n / right_column_size - left_begin));
   }
   return std::make_unique<ComplexVectSplit>(result);
 }
 
 std::unique_ptr<ComplexVectSplit> tprhe(const ComplexVectMatrix &right,
-                                        const size_t row, const size_t row_size,
+                                        const size_t row,
+                                        const size_t col_begin,
+                                        const size_t col_end,
                                         const size_t right_row_size,
                                         const size_t right_column_size) {
   return right.get(
-      row_size,
+      col_end - col_begin,
       [row, right_row_size](size_t i) -> size_t {
         return row % right_row_size;
       },
-      [right_column_size](size_t i) -> size_t {
-        return i % right_column_size;
+      [col_begin, right_column_size](size_t i) -> size_t {
+        return (col_begin + i) % right_column_size;
       });
 }
 
 std::unique_ptr<ComplexVectSplit>
-tensor_product_mat_mat_row(const ComplexVectMatrix &left,
-                           const ComplexVectMatrix &right, const size_t row) {
+tensor_product_mat_mat_range(const ComplexVectMatrix &left,
+                             const ComplexVectMatrix &right, const size_t row,
+                             const size_t col_begin, const size_t col_end) {
   const auto right_row_size = right.row_size();
   const auto right_column_size = right.column_size();
-  const auto final_row_size = left.row_size() * right_row_size;
 
-  auto vect_left =
-      tplhe(left, row, final_row_size, right_row_size, right_column_size);
-  auto vect_right =
-      tprhe(right, row, final_row_size, right_row_size, right_column_size);
+  auto vect_left = tplhe(left, row, col_begin, col_end, right_row_size,
+                         right_column_size);
+  auto vect_right = tprhe(right, row, col_begin, col_end, right_row_size,
+                          right_column_size);
 
   return simd::cvmul(*vect_left, *vect_right);
 }
 
 std::unique_ptr<ComplexVectSplit>
-tensor_product_op_mat_row(const Operation &left, const ComplexVectMatrix &right,
-                          const size_t row) {
+tensor_product_mat_mat_row(const ComplexVectMatrix &left,
+                           const ComplexVectMatrix &right, const size_t row) {
+  return tensor_product_mat_mat_range(
+      left, right, row, 0, left.column_size() * right.column_size());
+}
+
+std::unique_ptr<ComplexVectSplit>
+tensor_product_op_mat_range(const Operation &left,
+                            const ComplexVectMatrix &right, const size_t row,
+                            const size_t col_begin, const size_t col_end) {
   const auto right_row_size = right.row_size();
   const auto right_column_size = right.column_size();
-  const auto final_row_size = left.row_size() * right_row_size;
 
-  auto vect_left =
-      tplhe(left, row, final_row_size, right_row_size, right_column_size);
-  auto vect_right =
-      tprhe(right, row, final_row_size, right_row_size, right_column_size);
+  auto vect_left = tplhe(left, row, col_begin, col_end, right_row_size,
+                         right_column_size);
+  auto vect_right = tprhe(right, row, col_begin, col_end, right_row_size,
+                          right_column_size);
 
   return simd::cvmul(*vect_left, *vect_right);
 }
 
+std::unique_ptr<ComplexVectSplit>
+tensor_product_op_mat_row(const Operation &left, const ComplexVectMatrix &right,
+                          const size_t row) {
+  return tensor_product_op_mat_range(
+      left, right, row, 0, left.column_size() * right.column_size());
+}
+
 size_t tensor_product_final_row_size(size_t row_size_left,
                                      size_t column_size_left,
                                      size_t row_size_right,
@@ -408,31 +520,41 @@ AlgebraEngine::inner_product(const ComplexVectMatrix &vect_left,
 
 std::unique_ptr<LazyOperation>
 AlgebraEngine::matrix_multiplication(const ComplexVectMatrix &mat_left,
-                                     const ComplexVectMatrix &mat_right) {
+                                     const ComplexVectMatrix &mat_right,
+                                     const GemmMethod method) {
+  if (mat_left.column_size() != mat_right.row_size()) {
+    throw std::invalid_argument("Matrix sizes do not match");
+  }
   size_t final_row_size = mat_left.row_size();
   size_t final_column_size = mat_right.column_size();
   return std::make_unique<LazyOperation>(
       mat_left, mat_right, matrix_multiplication_mat_mat,
-      matrix_multiplication_mat_mat_row, final_row_size, final_column_size);
+      matrix_multiplication_mat_mat_row, final_row_size, final_column_size,
+      [method](const ComplexVectMatrix &left, const ComplexVectMatrix &right) {
+        return GemmEngine::multiply(left, right, method);
+      });
 }
 
 std::unique_ptr<LazyOperation>
 AlgebraEngine::matrix_vector_product(const ComplexVectMatrix &mat,
                                      const ComplexVectMatrix &vect) {
-  size_t final_column_size = vect.column_size();
-  return std::make_unique<LazyOperation>(mat, vect, matrix_vector_mul_mat_mat,
-                                         matrix_vector_mul_mat_mat_row, 1,
-                                         final_column_size);
+  check_matrix_vector_sizes(mat.column_size(), vect.column_size());
+  size_t final_row_size = vect.row_size();
+  size_t final_column_size = mat.row_size();
+  return std::make_unique<LazyOperation>(
+      mat, vect, matrix_vector_mul_mat_mat, matrix_vector_mul_mat_mat_row,
+      final_row_size, final_column_size, GemmEngine::multiply_vectors,
+      matrix_vector_mul_mat_mat_range);
 }
 
 std::unique_ptr<LazyOperation>
 AlgebraEngine::matrix_vector_product(std::unique_ptr<LazyOperation> mat,
                                      const ComplexVectMatrix &vect) {
+  check_matrix_vector_sizes(mat->column_size(), vect.column_size());
   auto op = std::move(mat);
-  op->append(vect, matrix_multiplication_op_mat,
-             matrix_multiplication_op_mat_row,
-             matrix_multiplication_final_row_size,
-             matrix_multiplication_final_column_size);
+  op->append(vect, matrix_vector_mul_op_mat, matrix_vector_mul_op_mat_row,
+             matrix_vector_final_row_size, matrix_vector_final_column_size,
+             GemmEngine::multiply_vectors, matrix_vector_mul_op_mat_range);
 
   return std::move(op);
 }
@@ -440,10 +562,12 @@ AlgebraEngine::matrix_vector_product(std::unique_ptr<LazyOperation> mat,
 std::unique_ptr<LazyOperation>
 AlgebraEngine::matrix_vector_product(std::unique_ptr<LazyOperation> mat,
                                      std::unique_ptr<LazyOperation> vect) {
+  check_matrix_vector_sizes(mat->column_size(), vect->column_size());
   auto op = std::move(mat);
   op->append(*std::move(vect), matrix_vector_mul_op_op,
-             matrix_vector_mul_op_op_row, matrix_multiplication_final_row_size,
-             matrix_multiplication_final_column_size);
+             matrix_vector_mul_op_op_row, matrix_vector_final_row_size,
+             matrix_vector_final_column_size, GemmEngine::multiply_vectors,
+             matrix_vector_mul_op_op_range);
 
   return std::move(op);
 }
@@ -455,7 +579,7 @@ AlgebraEngine::outer_product(const ComplexVectMatrix &mat_left,
   size_t final_column_size = mat_right.column_size();
   return std::make_unique<LazyOperation>(
       mat_left, mat_right, outer_product_mat_mat, outer_product_mat_mat_row,
-      final_row_size, final_column_size);
+      final_row_size, final_column_size, nullptr, outer_product_mat_mat_range);
 }
 
 std::unique_ptr<LazyOperation>
@@ -464,7 +588,8 @@ AlgebraEngine::scalar_product(const ComplexVectMatrix &mat, const Complex &k) {
   size_t final_column_size = mat.column_size();
   return std::make_unique<LazyOperation>(
       mat, ComplexVectMatrix(k), scalar_product_mat_mat,
-      scalar_product_mat_mat_row, final_row_size, final_column_size);
+      scalar_product_mat_mat_row, final_row_size, final_column_size, nullptr,
+      scalar_product_mat_mat_range);
 }
 
 std::unique_ptr<LazyOperation>
@@ -476,9 +601,9 @@ AlgebraEngine::sum(const ComplexVectMatrix &mat_left,
       mat_left.column_size() != mat_right_column_size) {
     throw std::invalid_argument("Matrix sizes do not match");
   }
-  return std::make_unique<LazyOperation>(mat_left, mat_right, sum_mat_mat,
-                                         sum_mat_mat_row, mat_left_row_size,
-                                         mat_right_column_size);
+  return std::make_unique<LazyOperation>(
+      mat_left, mat_right, sum_mat_mat, sum_mat_mat_row, mat_left_row_size,
+      mat_right_column_size, nullptr, sum_mat_mat_range);
 }
 
 std::unique_ptr<LazyOperation>
@@ -492,7 +617,7 @@ AlgebraEngine::sum(const ComplexVectMatrix &mat_left,
   }
   auto lazy = std::make_unique<LazyOperation>(mat_left);
   lazy->append(mat_right, sum_op_op, sum_op_op_row, sum_row_size,
-               sum_column_size);
+               sum_column_size, nullptr, sum_op_op_range);
   return std::move(lazy);
 }
 
@@ -503,7 +628,7 @@ AlgebraEngine::tensor_product(const ComplexVectMatrix &mat_left,
   size_t final_column_size = mat_left.column_size() * mat_right.column_size();
   return std::make_unique<LazyOperation>(
       mat_left, mat_right, tensor_product_mat_mat, tensor_product_mat_mat_row,
-      final_row_size, final_column_size);
+      final_row_size, final_column_size, nullptr, tensor_product_mat_mat_range);
 }
 
 std::unique_ptr<LazyOperation>
@@ -518,16 +643,24 @@ AlgebraEngine::tensor_product(const ComplexVectMatrix &mat,
 
   auto lazy = std::make_unique<LazyOperation>(
       mat, mat, tensor_product_mat_mat, tensor_product_mat_mat_row,
-      final_row_size, final_column_size);
+      final_row_size, final_column_size, nullptr, tensor_product_mat_mat_range);
 
   for (size_t _ = 2; _ < times; _++) {
     lazy->append(mat, tensor_product_op_mat, tensor_product_op_mat_row,
                  tensor_product_final_row_size,
-                 tensor_product_final_column_size);
+                 tensor_product_final_column_size, nullptr,
+                 tensor_product_op_mat_range);
   }
   return lazy;
 }
 
+std::unique_ptr<KroneckerOperator>
+AlgebraEngine::kronecker_power(const ComplexVectMatrix &mat,
+                               const size_t times) {
+  return std::make_unique<KroneckerOperator>(
+      std::vector<ComplexVectMatrix>(times, mat));
+}
+
 bool AlgebraEngine::is_unitary(const ComplexVectMatrix &mat) {
   if (mat.row_size() != mat.column_size()) {
     return false;
@@ -16,7 +16,9 @@
 #define ALGEBRA_ENGINE_H
 
 #include "complex_vectorised_matrix.h"
+#include "gemm_engine.h"
 #include "hilbert_namespace.h"
+#include "kronecker_operator.h"
 #include "lazy_operation.h"
 
 #include <memory>
@@ -32,10 +34,25 @@ public:
   inner_product(const ComplexVectMatrix &vect_left,
                 const ComplexVectMatrix &vect_right);
 
+  /*
+   * Elements and rows are computed on demand, while `to_matrix` computes the
+   * whole product at once with `GemmEngine`, by the given `method`.
+   * @throws std::invalid_argument if the columns of `mat_left` are not as
+   * many as the rows of `mat_right`.
+   */
   static std::unique_ptr<LazyOperation>
   matrix_multiplication(const ComplexVectMatrix &mat_left,
-                        const ComplexVectMatrix &mat_right);
-
+                        const ComplexVectMatrix &mat_right,
+                        GemmMethod method = GemmMethod::Standard);
+
+  /*
+   * The product of `mat` by each row of `vect`, a 1xN vector or several of
+   * them, as the rows of the result. Elements and rows are computed on
+   * demand, while `to_matrix` materialises the operands and multiplies them
+   * with `GemmEngine::multiply_vectors`, streaming the matrix once.
+   * @throws std::invalid_argument if the vectors do not have as many
+   * elements as `mat` has columns.
+   */
   static std::unique_ptr<LazyOperation>
   matrix_vector_product(const ComplexVectMatrix &mat,
                         const ComplexVectMatrix &vect);
@@ -65,9 +82,21 @@ public:
   tensor_product(const ComplexVectMatrix &mat_left,
                  const ComplexVectMatrix &mat_right);
 
+  /*
+   * Every element is computed through all `times` levels of the product,
+   * so to multiply vectors by a large power, see `kronecker_power`.
+   */
   static std::unique_ptr<LazyOperation>
   tensor_product(const ComplexVectMatrix &mat, size_t times);
 
+  /*
+   * The tensor product of `times` copies of `mat` as a `KroneckerOperator`,
+   * which keeps the factors and applies them to vectors one mode at a time.
+   * @throws std::invalid_argument if `times` is zero or `mat` is empty.
+   */
+  static std::unique_ptr<KroneckerOperator>
+  kronecker_power(const ComplexVectMatrix &mat, size_t times);
+
   static bool is_unitary(const ComplexVectMatrix &mat);
 };
 
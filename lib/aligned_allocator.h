@@ -0,0 +1,99 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*
+ * Minimal standard allocator returning memory aligned to `Alignment` bytes, so
+ * that buffers can be fed to SIMD aligned loads and stores and never straddle
+ * a cache line at their start.
+ */
+template <typename T, std::size_t Alignment = 64> class AlignedAllocator {
+public:
+  using value_type = T;
+
+  static_assert(Alignment >= alignof(T), "Alignment is too small for T");
+  static_assert((Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two");
+
+  template <typename U> struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() noexcept = default;
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) noexcept {}
+
+  [[nodiscard]] T *allocate(const std::size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+  }
+
+  void deallocate(T *p, std::size_t) noexcept {
+    ::operator delete(p, std::align_val_t(Alignment));
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const noexcept {
+    return false;
+  }
+};
+
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+/*
+ * `AlignedAllocator` that leaves new elements default-initialised, i.e. not
+ * written at all for arithmetic types, so that the pages of a large buffer are
+ * first touched, and so placed on a NUMA node, by the threads that will work
+ * on them rather than by the thread resizing it (see `Numa::first_touch`).
+ */
+template <typename T, std::size_t Alignment = 64>
+class FirstTouchAllocator : public AlignedAllocator<T, Alignment> {
+public:
+  template <typename U> struct rebind {
+    using other = FirstTouchAllocator<U, Alignment>;
+  };
+
+  FirstTouchAllocator() noexcept = default;
+
+  template <typename U>
+  FirstTouchAllocator(const FirstTouchAllocator<U, Alignment> &) noexcept {}
+
+  template <typename U> void construct(U *p) noexcept {
+    ::new (static_cast<void *>(p)) U;
+  }
+
+  template <typename U, typename... Args>
+  void construct(U *p, Args &&...args) {
+    ::new (static_cast<void *>(p)) U(std::forward<Args>(args)...);
+  }
+};
+
+template <typename T>
+using FirstTouchVector = std::vector<T, FirstTouchAllocator<T>>;
+
+#endif // !ALIGNED_ALLOCATOR_H
@@ -0,0 +1,197 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "circuit.h"
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace.h"
+#include "permutation_gate.h"
+#include "unitary_gate.h"
+#include <array>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+size_t GateOp::control_mask() const {
+  size_t mask = 0;
+  for (auto c : controls) {
+    mask |= size_t(1) << c;
+  }
+  return mask;
+}
+
+std::unique_ptr<ComplexVectMatrix> GateOp::target_matrix() const {
+  switch (kind) {
+  case GateKind::Hadamard:
+    return ComplexVectMatrix::hadamard_2x2();
+  case GateKind::PauliX:
+    return ComplexVectMatrix::pauli_x();
+  case GateKind::PauliY:
+    return ComplexVectMatrix::pauli_y();
+  case GateKind::PauliZ:
+    return ComplexVectMatrix::pauli_z();
+  case GateKind::Phase:
+    return std::make_unique<ComplexVectMatrix>(ComplexMatrix(
+        {{1, 0},
+         {0, std::polar<__complex_precision>(
+                 1, static_cast<__complex_precision>(angle))}}));
+  case GateKind::Swap:
+    return PermutationGate::swap()->to_matrix();
+  case GateKind::Unitary:
+    if (matrix != nullptr) {
+      return std::make_unique<ComplexVectMatrix>(*matrix);
+    }
+    break;
+  }
+  if (elements == nullptr) {
+    throw std::invalid_argument("Unitary gate has no matrix");
+  }
+  // Only the elements are known, in double precision.
+  const auto dim = size_t(1) << targets.size();
+  ComplexVector m(elements->begin(), elements->end());
+  return std::make_unique<ComplexVectMatrix>(m, dim, dim);
+}
+
+std::array<std::complex<double>, 4> GateOp::target_elements() const {
+  using C = std::complex<double>;
+  const auto h = 1 / std::numbers::sqrt2;
+  switch (kind) {
+  case GateKind::Hadamard:
+    return {C(h), C(h), C(h), C(-h)};
+  case GateKind::PauliX:
+    return {C(0), C(1), C(1), C(0)};
+  case GateKind::PauliY:
+    return {C(0), C(0, -1), C(0, 1), C(0)};
+  case GateKind::PauliZ:
+    return {C(1), C(0), C(0), C(-1)};
+  case GateKind::Phase:
+    return {C(1), C(0), C(0), std::polar(1.0, angle)};
+  case GateKind::Unitary:
+    if (targets.size() == 1) {
+      const auto e = target_dense_elements();
+      return {e[0], e[1], e[2], e[3]};
+    }
+    break;
+  case GateKind::Swap:
+    break;
+  }
+  throw std::invalid_argument("Not a single-target gate");
+}
+
+std::vector<std::complex<double>> GateOp::target_dense_elements() const {
+  if (elements != nullptr) {
+    return *elements;
+  }
+  if (kind != GateKind::Unitary && kind != GateKind::Swap) {
+    const auto e = target_elements();
+    return {e.begin(), e.end()};
+  }
+  const auto m = target_matrix();
+  std::vector<std::complex<double>> e;
+  e.reserve(m->row_size() * m->column_size());
+  for (size_t r = 0; r < m->row_size(); r++) {
+    for (size_t c = 0; c < m->column_size(); c++) {
+      e.emplace_back(m->get(r, c));
+    }
+  }
+  return e;
+}
+
+std::unique_ptr<UnitaryGate> GateOp::to_unitary() const {
+  return UnitaryGate::controlled(*target_matrix(), targets, controls);
+}
+
+Circuit::Circuit(const size_t num_qubits) : num_qubits_(num_qubits) {
+  if (num_qubits == 0) {
+    throw std::invalid_argument("A circuit needs at least one qubit");
+  }
+}
+
+Circuit &Circuit::record(GateOp op) {
+  size_t used = 0;
+  for (const auto *qubits : {&op.targets, &op.controls}) {
+    for (auto q : *qubits) {
+      if (q >= num_qubits_) {
+        throw std::out_of_range("Qubit " + std::to_string(q) +
+                                " is out of range");
+      }
+      if (used & (size_t(1) << q)) {
+        throw std::invalid_argument("Qubit " + std::to_string(q) +
+                                    " is used twice");
+      }
+      used |= size_t(1) << q;
+    }
+  }
+  ops_.push_back(std::move(op));
+  return *this;
+}
+
+Circuit &Circuit::h(const size_t target, const std::vector<size_t> &controls) {
+  return record({GateKind::Hadamard, {target}, controls});
+}
+
+Circuit &Circuit::x(const size_t target, const std::vector<size_t> &controls) {
+  return record({GateKind::PauliX, {target}, controls});
+}
+
+Circuit &Circuit::y(const size_t target, const std::vector<size_t> &controls) {
+  return record({GateKind::PauliY, {target}, controls});
+}
+
+Circuit &Circuit::z(const size_t target, const std::vector<size_t> &controls) {
+  return record({GateKind::PauliZ, {target}, controls});
+}
+
+Circuit &Circuit::phase(const size_t target, const double angle,
+                        const std::vector<size_t> &controls) {
+  return record({GateKind::Phase, {target}, controls, angle});
+}
+
+Circuit &Circuit::r_k(const size_t target, const int k,
+                      const std::vector<size_t> &controls,
+                      const bool inverse) {
+  const auto angle = 2 * std::numbers::pi / std::pow(2, k);
+  return phase(target, inverse ? -angle : angle, controls);
+}
+
+Circuit &Circuit::cnot(const size_t control, const size_t target) {
+  return x(target, {control});
+}
+
+Circuit &Circuit::swap(const size_t a, const size_t b,
+                       const std::vector<size_t> &controls) {
+  return record({GateKind::Swap, {a, b}, controls});
+}
+
+Circuit &Circuit::unitary(const ComplexVectMatrix &u,
+                          const std::vector<size_t> &targets,
+                          const std::vector<size_t> &controls) {
+  const auto dim = size_t(1) << targets.size();
+  if (targets.empty() || u.row_size() != dim || u.column_size() != dim) {
+    throw std::invalid_argument("Gate must be a 2^t x 2^t matrix");
+  }
+  return record({GateKind::Unitary, targets, controls, 0,
+                 std::make_shared<const ComplexVectMatrix>(u)});
+}
+
+Circuit &Circuit::append(const Circuit &other) {
+  if (other.num_qubits_ != num_qubits_) {
+    throw std::invalid_argument("Circuits have different qubits");
+  }
+  ops_.insert(ops_.end(), other.ops_.begin(), other.ops_.end());
+  return *this;
+}
@@ -0,0 +1,134 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef CIRCUIT_H
+#define CIRCUIT_H
+
+#include "complex_vectorised_matrix.h"
+#include "unitary_gate.h"
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+enum class GateKind { Hadamard, PauliX, PauliY, PauliZ, Phase, Swap, Unitary };
+
+/*
+ * A recorded gate: its kind, the qubits it acts on, its controls and its
+ * parameters. `angle` is only meaningful for `Phase`, diag(1, e^(i angle)),
+ * and `matrix` only for `Unitary`, where it spans all the targets. A
+ * `Unitary` can carry its row-major `elements` in double precision instead,
+ * as fused gates do.
+ */
+struct GateOp {
+  GateKind kind;
+  std::vector<size_t> targets;
+  std::vector<size_t> controls;
+  double angle = 0;
+  std::shared_ptr<const ComplexVectMatrix> matrix = nullptr;
+  std::shared_ptr<const std::vector<std::complex<double>>> elements = nullptr;
+
+  /*
+   * @return the controls as a bitmask, where bit `q` stands for qubit `q`.
+   */
+  [[nodiscard]] size_t control_mask() const;
+
+  /*
+   * @return the uncontrolled gate matrix over the targets.
+   */
+  [[nodiscard]] std::unique_ptr<ComplexVectMatrix> target_matrix() const;
+
+  /*
+   * @return the row-major entries of a single-target gate, in double
+   * precision, so that a double-precision state is not limited by the
+   * rounding of `target_matrix()`. A `Unitary` is widened from its matrix.
+   */
+  [[nodiscard]] std::array<std::complex<double>, 4> target_elements() const;
+
+  /*
+   * @return the row-major entries of the uncontrolled gate over the targets,
+   * of any width, in double precision as `target_elements()`.
+   */
+  [[nodiscard]] std::vector<std::complex<double>>
+  target_dense_elements() const;
+
+  /*
+   * @return the gate, controls included, as a dense gate.
+   */
+  [[nodiscard]] std::unique_ptr<UnitaryGate> to_unitary() const;
+};
+
+/*
+ * This class records a circuit as a typed gate sequence instead of applying
+ * each gate as soon as it is called, so that the whole circuit can be
+ * optimised before an `Executor` runs it. Qubits are numbered as in
+ * `DenseState`. Every recording method returns the circuit, so that calls can
+ * be chained.
+ */
+class Circuit final {
+public:
+  explicit Circuit(size_t num_qubits);
+
+  Circuit &h(size_t target, const std::vector<size_t> &controls = {});
+
+  Circuit &x(size_t target, const std::vector<size_t> &controls = {});
+
+  Circuit &y(size_t target, const std::vector<size_t> &controls = {});
+
+  Circuit &z(size_t target, const std::vector<size_t> &controls = {});
+
+  /*
+   * Records diag(1, e^(i angle)) on `target`.
+   */
+  Circuit &phase(size_t target, double angle,
+                 const std::vector<size_t> &controls = {});
+
+  /*
+   * Records the QFT rotation R_k, diag(1, e^(2 pi i / 2^k)), or its inverse.
+   */
+  Circuit &r_k(size_t target, int k, const std::vector<size_t> &controls = {},
+               bool inverse = false);
+
+  Circuit &cnot(size_t control, size_t target);
+
+  Circuit &swap(size_t a, size_t b, const std::vector<size_t> &controls = {});
+
+  /*
+   * Records the 2^t x 2^t `u` on `targets`, where bit `q` of a local basis
+   * index stands for `targets[q]`.
+   */
+  Circuit &unitary(const ComplexVectMatrix &u,
+                   const std::vector<size_t> &targets,
+                   const std::vector<size_t> &controls = {});
+
+  /*
+   * Appends all the gates of `other`, which must have the same qubits.
+   */
+  Circuit &append(const Circuit &other);
+
+  [[nodiscard]] size_t num_qubits() const { return num_qubits_; }
+
+  [[nodiscard]] const std::vector<GateOp> &ops() const { return ops_; }
+
+  [[nodiscard]] size_t size() const { return ops_.size(); }
+
+private:
+  Circuit &record(GateOp op);
+
+  size_t num_qubits_;
+  std::vector<GateOp> ops_;
+};
+
+#endif // !CIRCUIT_H
@@ -13,10 +13,25 @@
 // limitations under the License.
 
 #include "circuit_engine.h"
+#include "circuit.h"
+#include "complex_vectorised_matrix.h"
+#include "dense_state.h"
+#include "executor.h"
+#include "fft_engine.h"
 #include "gate_engine.h"
 #include "state_vector.h"
 #include <memory>
 
+/*
+ * Records the reversal of the order of the qubits.
+ */
+void reverse_qubits(Circuit &circuit) {
+  const auto n = circuit.num_qubits();
+  for (size_t q = 0; q < n / 2; q++) {
+    circuit.swap(q, n - 1 - q);
+  }
+}
+
 std::unique_ptr<StateVector> CircuitEngine::qft(const StateVector &j) {
   std::vector<Qubit> result(j.size());
 
@@ -25,7 +40,7 @@ std::unique_ptr<StateVector> CircuitEngine::qft(const StateVector &j) {
     auto j_k = GateEngine::hadamard(j.get(i));
     for (size_t k_next = i + 1; k_next < j.size(); k_next++) {
       j_k = GateEngine::controlled_u(*j_k, j.get(k_next),
-                                     *GateEngine::r_k(k_next + 1));
+                                     *GateEngine::r_k(k_next - i + 1));
     }
     result[last_index - i] = *j_k;
   }
@@ -44,10 +59,60 @@ std::unique_ptr<StateVector> CircuitEngine::inverse_qft(const StateVector &k) {
     auto k_i = swapped[i];
     for (size_t j = last_index; j > i; j--) {
       k_i = *GateEngine::controlled_u(k_i, result[j],
-                                      *GateEngine::r_k(j + 1, true));
+                                      *GateEngine::r_k(j - i + 1, true));
     }
     result[i] = *GateEngine::hadamard(k_i);
   }
 
   return std::make_unique<StateVector>(result);
 }
+
+std::unique_ptr<Circuit> CircuitEngine::qft_circuit(const size_t num_qubits) {
+  auto circuit = std::make_unique<Circuit>(num_qubits);
+  for (size_t i = 0; i < num_qubits; i++) {
+    const auto target = num_qubits - 1 - i;
+    circuit->h(target);
+    for (size_t k = 2; k <= target + 1; k++) {
+      circuit->r_k(target, static_cast<int>(k), {target + 1 - k});
+    }
+  }
+  reverse_qubits(*circuit);
+  return circuit;
+}
+
+std::unique_ptr<Circuit>
+CircuitEngine::inverse_qft_circuit(const size_t num_qubits) {
+  auto circuit = std::make_unique<Circuit>(num_qubits);
+  reverse_qubits(*circuit);
+  for (size_t target = 0; target < num_qubits; target++) {
+    for (size_t k = target + 1; k >= 2; k--) {
+      circuit->r_k(target, static_cast<int>(k), {target + 1 - k}, true);
+    }
+    circuit->h(target);
+  }
+  return circuit;
+}
+
+template <typename T>
+void CircuitEngine::qft(BasicDenseState<T> &state, const QftMode mode) {
+  if (mode == QftMode::Fft) {
+    FftEngine::transform(state.real_data(), state.imag_data(), state.size());
+    return;
+  }
+  Executor().run(*qft_circuit(state.num_qubits()), state);
+}
+
+template <typename T>
+void CircuitEngine::inverse_qft(BasicDenseState<T> &state, const QftMode mode) {
+  if (mode == QftMode::Fft) {
+    FftEngine::transform(state.real_data(), state.imag_data(), state.size(),
+                         true);
+    return;
+  }
+  Executor().run(*inverse_qft_circuit(state.num_qubits()), state);
+}
+
+template void CircuitEngine::qft(BasicDenseState<float> &, QftMode);
+template void CircuitEngine::qft(BasicDenseState<double> &, QftMode);
+template void CircuitEngine::inverse_qft(BasicDenseState<float> &, QftMode);
+template void CircuitEngine::inverse_qft(BasicDenseState<double> &, QftMode);
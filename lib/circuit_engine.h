@@ -15,9 +15,17 @@
 #ifndef CIRCUIT_ENGINE_H
 #define CIRCUIT_ENGINE_H
 
+#include "circuit.h"
+#include "dense_state.h"
 #include "state_vector.h"
 #include <memory.h>
 
+/*
+ * How a QFT on a dense state is computed: as a circuit of gates, or as an FFT
+ * of the amplitudes, in O(N log N).
+ */
+enum class QftMode { Gates, Fft };
+
 class CircuitEngine {
 public:
   CircuitEngine() = delete;
@@ -25,6 +33,25 @@ public:
   static std::unique_ptr<StateVector> qft(const StateVector &j);
 
   static std::unique_ptr<StateVector> inverse_qft(const StateVector &k);
+
+  /*
+   * In-place QFT of a dense state, mapping each |j> to
+   * 1/sqrt(2^n) sum_k e^(2 pi i jk / 2^n) |k>.
+   */
+  template <typename T>
+  static void qft(BasicDenseState<T> &state, QftMode mode = QftMode::Gates);
+
+  template <typename T>
+  static void inverse_qft(BasicDenseState<T> &state,
+                          QftMode mode = QftMode::Gates);
+
+  /*
+   * Records the gates of the QFT over `num_qubits` qubits, including the
+   * final reversal of the qubits, without applying them.
+   */
+  static std::unique_ptr<Circuit> qft_circuit(size_t num_qubits);
+
+  static std::unique_ptr<Circuit> inverse_qft_circuit(size_t num_qubits);
 };
 
 #endif // !CIRCUIT_ENGINE_H
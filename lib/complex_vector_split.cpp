@@ -0,0 +1,38 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "complex_vector_split.h"
+#include "hilbert_namespace.h"
+#include "simd.h"
+#include <algorithm>
+#include <memory>
+
+#ifdef __APPLE__
+#include <Accelerate/Accelerate.h>
+#endif
+
+std::unique_ptr<ComplexVectSplit> ComplexVectSplit::conj() {
+  auto result = std::make_unique<ComplexVectSplit>(size_);
+  std::copy(real_.begin(), real_.end(), result->real_.begin());
+  const auto length = padded_size();
+
+#ifdef __APPLE__
+  __complex_precision k = -1;
+  vDSP_vsmul(imag_.data(), 1, &k, result->imag_data(), 1, length);
+#else
+  simd::backend().vneg(imag_.data(), result->imag_data(), length);
+#endif
+  return result;
+}
@@ -15,97 +15,166 @@
 #ifndef COMPLEX_VECTOR_SPLIT_H
 #define COMPLEX_VECTOR_SPLIT_H
 
+#include "aligned_allocator.h"
 #include "hilbert_namespace.h"
+#include "split_span.h"
+#include <algorithm>
 #include <memory>
+#include <span>
 #include <stdexcept>
-#include <vector>
-
-#ifdef __APPLE__
-#include <Accelerate/Accelerate.h>
-#else
 #include <cstddef>
-#include <immintrin.h>
-#endif
+#include <vector>
 
 /*
  * This class represents a vector of complex numbers, with real and imaginary
  * parts split into two different vectors to facilitate SIMD operations.
+ *
+ * Both parts are 64-byte aligned and padded with zeros to a whole number of
+ * SIMD registers, so that kernels can use aligned loads and stores and need no
+ * scalar tail. Every operation keeps the padding at zero.
  */
 class ComplexVectSplit {
 public:
+  // Elements per SIMD register, the storage is padded to a multiple of it. An
+  // AVX-512 register is a whole cache line, so that each row of a matrix is
+  // aligned as well.
+  static constexpr size_t simd_width = 16;
+
   ComplexVectSplit() = default;
 
-  explicit ComplexVectSplit(const std::vector<Complex> v) {
-    for (auto k : v) {
-      real_.push_back(k.real());
-      imag_.push_back(k.imag());
+  /*
+   * Creates `size` zero elements.
+   */
+  explicit ComplexVectSplit(const size_t size)
+      : size_(size), real_(padded(size)), imag_(padded(size)) {}
+
+  explicit ComplexVectSplit(const std::vector<Complex> v)
+      : ComplexVectSplit(v.size()) {
+    for (size_t i = 0; i < size_; i++) {
+      set(i, v[i]);
     }
   }
 
   ComplexVectSplit(std::vector<__complex_precision> real,
                    std::vector<__complex_precision> imag)
-      : real_(real), imag_(imag) {
-    if (real_.size() != imag_.size()) {
+      : ComplexVectSplit(real.size()) {
+    if (real.size() != imag.size()) {
       throw std::invalid_argument("Real and imag sizes do not match");
     }
+    std::copy(real.begin(), real.end(), real_.begin());
+    std::copy(imag.begin(), imag.end(), imag_.begin());
+  }
+
+  /*
+   * Copies the elements seen by `view`.
+   */
+  explicit ComplexVectSplit(const ConstSplitSpan view)
+      : ComplexVectSplit(view.size()) {
+    std::ranges::copy(view.real(), real_.begin());
+    std::ranges::copy(view.imag(), imag_.begin());
+  }
+
+  /*
+   * @return a view over the elements, valid until the vector is resized.
+   */
+  [[nodiscard]] ConstSplitSpan span() const {
+    return ConstSplitSpan(std::span(real_), std::span(imag_), size_);
+  }
+
+  [[nodiscard]] SplitSpan span() {
+    return SplitSpan(std::span(real_), std::span(imag_), size_);
+  }
+
+  // Lets a vector be passed wherever a read-only view is expected.
+  operator ConstSplitSpan() const { return span(); }
+
+  /*
+   * @return a view over the real parts, `size()` long.
+   */
+  [[nodiscard]] std::span<const __complex_precision> real_span() const {
+    return std::span(real_).first(size_);
+  }
+
+  /*
+   * @return a view over the imaginary parts, `size()` long.
+   */
+  [[nodiscard]] std::span<const __complex_precision> imag_span() const {
+    return std::span(imag_).first(size_);
   }
 
   [[nodiscard]] std::unique_ptr<std::vector<__complex_precision>> real() const {
-    return std::make_unique<std::vector<__complex_precision>>(real_);
+    return std::make_unique<std::vector<__complex_precision>>(
+        real_.begin(), real_.begin() + size_);
   }
 
   [[nodiscard]] std::unique_ptr<std::vector<__complex_precision>> imag() const {
-    return std::make_unique<std::vector<__complex_precision>>(imag_);
+    return std::make_unique<std::vector<__complex_precision>>(
+        imag_.begin(), imag_.begin() + size_);
+  }
+
+  /*
+   * @return the aligned real parts, `padded_size()` long.
+   */
+  [[nodiscard]] const __complex_precision *real_data() const {
+    return real_.data();
   }
 
+  [[nodiscard]] __complex_precision *real_data() { return real_.data(); }
+
+  /*
+   * @return the aligned imaginary parts, `padded_size()` long.
+   */
+  [[nodiscard]] const __complex_precision *imag_data() const {
+    return imag_.data();
+  }
+
+  [[nodiscard]] __complex_precision *imag_data() { return imag_.data(); }
+
   [[nodiscard]] Complex get(const size_t i) const {
     return Complex(real_[i], imag_[i]);
   }
 
   [[nodiscard]] std::unique_ptr<std::vector<Complex>> get() const {
-    std::vector<Complex> result(real_.size());
-    for (size_t i = 0; i < real_.size(); i++) {
+    std::vector<Complex> result(size_);
+    for (size_t i = 0; i < size_; i++) {
       result[i] = Complex(real_[i], imag_[i]);
     }
     return std::make_unique<std::vector<Complex>>(result);
   }
 
-  [[nodiscard]] size_t size() const { return real_.size(); }
+  void set(const size_t i, const Complex c) {
+    real_[i] = c.real();
+    imag_[i] = c.imag();
+  }
+
+  [[nodiscard]] size_t size() const { return size_; }
+
+  [[nodiscard]] size_t padded_size() const { return real_.size(); }
 
   void add(const Complex c) {
-    real_.emplace_back(c.real());
-    imag_.emplace_back(c.imag());
-  }
-
-  std::unique_ptr<ComplexVectSplit> conj() {
-    __complex_precision k = -1;
-    std::vector<__complex_precision> imag_conj(imag_.size());
-
-#ifdef __APPLE__
-    vDSP_vsmul(imag_.data(), 1, &k, imag_conj.data(), 1, imag_conj.size());
-#else
-    __m256 scalar_vec = _mm256_set1_ps(k);
-
-    size_t i = 0;
-    size_t element_size = sizeof(__complex_precision) * 8;
-    size_t elements_per_block = 256 / element_size;
-    auto src = imag_.data();
-    for (; i + elements_per_block <= imag_conj.size();
-         i += elements_per_block) {
-      __m256 vec = _mm256_loadu_ps(src + i);
-      __m256 result = _mm256_mul_ps(vec, scalar_vec);
-      _mm256_storeu_ps(imag_conj.data() + i, result);
-    }
-    for (; i < imag_conj.size(); i++) {
-      imag_conj[i] = src[i] * k;
+    if (size_ == real_.size()) {
+      real_.resize(padded(size_ + 1));
+      imag_.resize(padded(size_ + 1));
     }
-#endif
-    return std::make_unique<ComplexVectSplit>(real_, imag_conj);
+    set(size_++, c);
+  }
+
+  /*
+   * @return the element-wise complex conjugate.
+   */
+  std::unique_ptr<ComplexVectSplit> conj();
+
+  /*
+   * @return `size` rounded up to a whole number of SIMD registers.
+   */
+  static size_t padded(const size_t size) {
+    return (size + simd_width - 1) / simd_width * simd_width;
   }
 
 private:
-  std::vector<__complex_precision> real_;
-  std::vector<__complex_precision> imag_;
+  size_t size_ = 0;
+  AlignedVector<__complex_precision> real_;
+  AlignedVector<__complex_precision> imag_;
 };
 
 #endif // !COMPLEX_VECTOR_SPLIT_H
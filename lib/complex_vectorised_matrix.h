@@ -15,57 +15,76 @@
 #ifndef COMPLEX_VECTORISED_MATRIX_H
 #define COMPLEX_VECTORISED_MATRIX_H
 
+#include "aligned_allocator.h"
 #include "complex_vector_split.h"
 #include "hilbert_namespace.h"
 #include "simd.h"
+#include "split_span.h"
+#include <algorithm>
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <span>
+#include <stdexcept>
 
 /*
  * This class represents a matrix in a vectorised form, in order to have all the
- * elements in a contiguous space and improve efficiency.
+ * elements in a contiguous space and improve efficiency. Real and imaginary
+ * parts are split like in `ComplexVectSplit`, and every row starts on a
+ * 64-byte boundary and is padded with zeros to a whole number of SIMD
+ * registers, so that a row can be handed to a kernel as a `ConstSplitSpan`
+ * without any copy. Columns are seen through a `StridedSplitSpan`.
  */
 class ComplexVectMatrix final {
 public:
   explicit ComplexVectMatrix(const ComplexMatrix &m)
-      : row_size_(m.size()), column_size_(m.front().size()),
-        vectorised_matrix_(ComplexVector(row_size_ * column_size_)) {
-    const auto elements_size = row_size_ * column_size_;
-    for (size_t i = 0; i < elements_size; i++) {
-      vectorised_matrix_[i] = m.at(i / column_size_).at(i % column_size_);
+      : ComplexVectMatrix(m.size(), m.front().size()) {
+    for (size_t i = 0; i < row_size_; i++) {
+      for (size_t j = 0; j < column_size_; j++) {
+        set(i, j, m.at(i).at(j));
+      }
     }
   }
 
-  ComplexVectMatrix(ComplexVector m, const size_t row_size,
+  /*
+   * Creates a `row_size` x `column_size` matrix from its elements, row after
+   * row.
+   * @throws std::invalid_argument if `m` does not hold as many elements.
+   */
+  ComplexVectMatrix(const ComplexVector &m, const size_t row_size,
                     const size_t column_size)
-      : row_size_(row_size), column_size_(column_size),
-        vectorised_matrix_(std::move(m)) {}
-
-  explicit ComplexVectMatrix(const ComplexVector &v)
-      : row_size_(1), column_size_(v.size()),
-        vectorised_matrix_(ComplexVector(row_size_ * column_size_)) {
-    const auto elements_size = row_size_ * column_size_;
-    for (size_t i = 0; i < elements_size; i++) {
-      vectorised_matrix_[i] = v.at(i);
+      : ComplexVectMatrix(row_size, column_size) {
+    if (m.size() != row_size * column_size) {
+      throw std::invalid_argument("Elements do not match the matrix size");
+    }
+    for (size_t i = 0; i < m.size(); i++) {
+      set(i / column_size_, i % column_size_, m[i]);
     }
   }
 
+  explicit ComplexVectMatrix(const ComplexVector &v)
+      : ComplexVectMatrix(v, 1, v.size()) {}
+
   explicit ComplexVectMatrix(const Complex &c)
-      : row_size_(1), column_size_(1), vectorised_matrix_(ComplexVector(1)) {
-    vectorised_matrix_[0] = c;
-  }
+      : ComplexVectMatrix(ComplexVector({c}), 1, 1) {}
 
-  ComplexVectMatrix()
-      : row_size_(0), column_size_(0), vectorised_matrix_(ComplexVector(0)) {}
+  /*
+   * Creates a `row_size` x `column_size` matrix of zeros.
+   */
+  ComplexVectMatrix(const size_t row_size, const size_t column_size)
+      : row_size_(row_size), column_size_(column_size),
+        stride_(ComplexVectSplit::padded(column_size)),
+        real_(row_size * stride_), imag_(row_size * stride_) {}
+
+  ComplexVectMatrix() : ComplexVectMatrix(0, 0) {}
 
   bool operator==(const ComplexVectMatrix &other) const {
     if (row_size_ != other.row_size_ || column_size_ != other.column_size_) {
       return false;
     }
 
-    auto diff = simd::cvsub(ComplexVectSplit(vectorised_matrix_),
-                            ComplexVectSplit(other.vectorised_matrix_));
+    // Both matrices share the layout, so their padding lines up and is zero.
+    auto diff = simd::cvsub(elements(), other.elements());
     if (!approx_equal(simd::cvsve(*diff), Complex(0, 0))) {
       return false;
     }
@@ -73,52 +92,148 @@ public:
   }
 
   [[nodiscard]] Complex get(const size_t m, const size_t n) const {
-    return vectorised_matrix_.at(m * column_size_ + n);
+    if (m >= row_size_ || n >= column_size_) {
+      throw std::out_of_range("Element is out of range");
+    }
+    return Complex(real_[m * stride_ + n], imag_[m * stride_ + n]);
   }
 
   [[nodiscard]] std::unique_ptr<ComplexVectSplit>
   get(size_t row_size, std::function<size_t(size_t i)> m_functor,
       std::function<size_t(size_t i)> n_functor) const {
-    ComplexVectSplit result;
+    auto result = std::make_unique<ComplexVectSplit>(row_size);
     for (size_t i = 0; i < row_size; i++) {
-      auto m = m_functor(i);
-      auto n = n_functor(i);
-      auto index = m * column_size_ + n;
-      result.add(vectorised_matrix_.at(index));
+      result->set(i, get(m_functor(i), n_functor(i)));
+    }
+    return result;
+  }
+
+  /*
+   * @return a view over row `m`, valid as long as the matrix.
+   */
+  [[nodiscard]] ConstSplitSpan row(const size_t m) const {
+    check_row(m);
+    return ConstSplitSpan(std::span(real_).subspan(m * stride_, stride_),
+                          std::span(imag_).subspan(m * stride_, stride_),
+                          column_size_);
+  }
+
+  /*
+   * @return a writable view over row `m`, valid as long as the matrix.
+   */
+  [[nodiscard]] SplitSpan row(const size_t m) {
+    check_row(m);
+    return SplitSpan(std::span(real_).subspan(m * stride_, stride_),
+                     std::span(imag_).subspan(m * stride_, stride_),
+                     column_size_);
+  }
+
+  /*
+   * @return a view over column `n`, valid as long as the matrix.
+   */
+  [[nodiscard]] StridedSplitSpan column(const size_t n) const {
+    if (n >= column_size_) {
+      throw std::out_of_range("Column is out of range");
     }
-    return std::make_unique<ComplexVectSplit>(result);
+    return StridedSplitSpan(real_.data() + n, imag_.data() + n, row_size_,
+                            stride_);
   }
 
   [[nodiscard]] std::unique_ptr<ComplexVectSplit>
   get_row(const size_t row) const {
-    auto start_index = row * column_size_;
-    auto end_index = start_index + column_size_;
-    return std::make_unique<ComplexVectSplit>(
-        std::vector<Complex>(vectorised_matrix_.begin() + start_index,
-                             vectorised_matrix_.begin() + end_index));
+    return std::make_unique<ComplexVectSplit>(this->row(row));
   }
 
+  /*
+   * @return a copy of the columns [col_begin, col_end) of row `row`.
+   * @throws std::out_of_range if the columns are not in the row.
+   */
   [[nodiscard]] std::unique_ptr<ComplexVectSplit>
-  get_column(const size_t column) const {
-    ComplexVectSplit result;
-    for (size_t m = 0; m < row_size_; m++) {
-      result.add(vectorised_matrix_[m * column_size_ + column]);
+  get_row(const size_t row, const size_t col_begin,
+          const size_t col_end) const {
+    if (col_begin > col_end || col_end > column_size_) {
+      throw std::out_of_range("Invalid column range");
     }
-    return std::make_unique<ComplexVectSplit>(result);
+    const auto view = this->row(row);
+    const auto size = col_end - col_begin;
+    auto result = std::make_unique<ComplexVectSplit>(size);
+    const auto span = result->span();
+    std::ranges::copy(view.real().subspan(col_begin, size),
+                      span.real().begin());
+    std::ranges::copy(view.imag().subspan(col_begin, size),
+                      span.imag().begin());
+    return result;
+  }
+
+  [[nodiscard]] std::unique_ptr<ComplexVectSplit>
+  get_column(const size_t column) const {
+    auto result = std::make_unique<ComplexVectSplit>(row_size_);
+    this->column(column).gather(result->span());
+    return result;
+  }
+
+  /*
+   * Copies row `row` into the caller's buffers, which must hold
+   * `column_size()` elements.
+   */
+  void get_row(const size_t row, __complex_precision *real,
+               __complex_precision *imag) const {
+    const auto view = this->row(row);
+    std::ranges::copy(view.real(), real);
+    std::ranges::copy(view.imag(), imag);
+  }
+
+  /*
+   * Copies column `column` into the caller's buffers, which must hold
+   * `row_size()` elements.
+   */
+  void get_column(const size_t column, __complex_precision *real,
+                  __complex_precision *imag) const {
+    this->column(column).gather(
+        SplitSpan(std::span(real, row_size_), std::span(imag, row_size_),
+                  row_size_));
   }
 
+  /*
+   * @return a copy of all the elements, row after row.
+   */
   [[nodiscard]] std::unique_ptr<ComplexVectSplit> split() const {
-    ComplexVectSplit result;
-    for (auto k : vectorised_matrix_) {
-      result.add(k);
+    auto result = std::make_unique<ComplexVectSplit>(row_size_ * column_size_);
+    for (size_t m = 0; m < row_size_; m++) {
+      const auto view = row(m);
+      std::ranges::copy(view.real(), result->real_data() + m * column_size_);
+      std::ranges::copy(view.imag(), result->imag_data() + m * column_size_);
     }
-    return std::make_unique<ComplexVectSplit>(result);
+    return result;
   }
 
   [[nodiscard]] size_t row_size() const { return row_size_; }
 
   [[nodiscard]] size_t column_size() const { return column_size_; }
 
+  /*
+   * @return the distance between the starts of two rows, in elements.
+   */
+  [[nodiscard]] size_t stride() const { return stride_; }
+
+  /*
+   * @return the aligned real parts, row after row, `stride()` apart.
+   */
+  [[nodiscard]] const __complex_precision *real_data() const {
+    return real_.data();
+  }
+
+  [[nodiscard]] __complex_precision *real_data() { return real_.data(); }
+
+  /*
+   * @return the aligned imaginary parts, row after row, `stride()` apart.
+   */
+  [[nodiscard]] const __complex_precision *imag_data() const {
+    return imag_.data();
+  }
+
+  [[nodiscard]] __complex_precision *imag_data() { return imag_.data(); }
+
   /*
    * Frequently used matrices and vectors.
    */
@@ -157,9 +272,30 @@ public:
   }
 
 private:
+  void set(const size_t m, const size_t n, const Complex c) {
+    real_[m * stride_ + n] = c.real();
+    imag_[m * stride_ + n] = c.imag();
+  }
+
+  void check_row(const size_t m) const {
+    if (m >= row_size_) {
+      throw std::out_of_range("Row is out of range");
+    }
+  }
+
+  /*
+   * @return a view over every row, padding included.
+   */
+  [[nodiscard]] ConstSplitSpan elements() const {
+    return ConstSplitSpan(std::span(real_), std::span(imag_), real_.size());
+  }
+
   const size_t row_size_;
   const size_t column_size_;
-  ComplexVector vectorised_matrix_;
+  // Distance between the starts of two rows.
+  const size_t stride_;
+  AlignedVector<__complex_precision> real_;
+  AlignedVector<__complex_precision> imag_;
 };
 
 #endif // !COMPLEX_VECTORISED_MATRIX_H
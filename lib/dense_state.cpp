@@ -0,0 +1,397 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "dense_state.h"
+#include "complex_vectorised_matrix.h"
+#include "diagonal_gate.h"
+#include "hilbert_namespace.h"
+#include "numa.h"
+#include "parallel.h"
+#include "permutation_gate.h"
+#include "qubit.h"
+#include "reduction.h"
+#include "simd.h"
+#include "state_vector.h"
+#include "unitary_gate.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Beyond this, 2^n amplitudes do not fit a 64-bit index anymore.
+constexpr size_t max_dense_qubits = 48;
+
+// Number of qubits expanded serially before the parallel expansion begins.
+constexpr size_t kron_low_qubits = 10;
+
+template <typename T>
+BasicDenseState<T>::BasicDenseState(const size_t num_qubits)
+    : num_qubits_(num_qubits) {
+  if (num_qubits == 0 || num_qubits > max_dense_qubits) {
+    throw std::invalid_argument("Unsupported number of qubits: " +
+                                std::to_string(num_qubits));
+  }
+  real_.resize(size_t(1) << num_qubits);
+  imag_.resize(size_t(1) << num_qubits);
+  Numa::first_touch(real_.data(), real_.size());
+  Numa::first_touch(imag_.data(), imag_.size());
+  real_[0] = 1;
+}
+
+template <typename T>
+BasicDenseState<T>::BasicDenseState(const StateVector &state)
+    : BasicDenseState(state.size()) {
+  const auto n = num_qubits_;
+  std::vector<Amplitude> alpha(n), beta(n);
+  for (size_t t = 0; t < n; t++) {
+    auto q = state.get(n - 1 - t).to_vector();
+    alpha[t] = q->get(0, 0);
+    beta[t] = q->get(0, 1);
+  }
+
+  // Expand the low qubits serially, doubling the table at each qubit.
+  const auto low_qubits = std::min(n, kron_low_qubits);
+  const size_t low_size = size_t(1) << low_qubits;
+  std::vector<Amplitude> low(low_size);
+  low[0] = 1;
+  for (size_t t = 0; t < low_qubits; t++) {
+    const size_t half = size_t(1) << t;
+    for (size_t i = 0; i < half; i++) {
+      low[i | half] = low[i] * beta[t];
+      low[i] *= alpha[t];
+    }
+  }
+
+  // Each high block is the low table scaled by the product of the high qubits.
+  const size_t high_blocks = size_t(1) << (n - low_qubits);
+  parallel_for(high_blocks, [&](size_t start, size_t end) {
+    for (size_t b = start; b < end; b++) {
+      Amplitude factor(1);
+      for (size_t t = low_qubits; t < n; t++) {
+        factor *= ((b >> (t - low_qubits)) & 1) ? beta[t] : alpha[t];
+      }
+      const auto offset = b * low_size;
+      for (size_t l = 0; l < low_size; l++) {
+        set(offset + l, factor * low[l]);
+      }
+    }
+  });
+}
+
+template <typename T>
+BasicDenseState<T>::BasicDenseState(const ComplexVectMatrix &vect)
+    : BasicDenseState(
+          static_cast<size_t>(std::countr_zero(vect.column_size()))) {
+  if (vect.row_size() != 1 ||
+      (size_t(1) << num_qubits_) != vect.column_size()) {
+    throw std::invalid_argument("Input must be a 1x2^n vector");
+  }
+  const auto amplitudes = vect.row(0);
+  std::ranges::copy(amplitudes.real(), real_.begin());
+  std::ranges::copy(amplitudes.imag(), imag_.begin());
+}
+
+template <typename T>
+bool BasicDenseState<T>::operator==(const BasicDenseState &other) const {
+  if (num_qubits_ != other.num_qubits_) {
+    return false;
+  }
+  for (size_t i = 0; i < size(); i++) {
+    if (!approx_equal(get(i), other.get(i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+void BasicDenseState<T>::check_qubit(const size_t qubit) const {
+  if (qubit >= num_qubits_) {
+    throw std::out_of_range("Qubit " + std::to_string(qubit) +
+                            " is out of range");
+  }
+}
+
+template <typename T>
+void BasicDenseState<T>::check_controls(const size_t target,
+                                        const size_t controls) const {
+  check_qubit(target);
+  if ((controls >> num_qubits_) != 0) {
+    throw std::out_of_range("Controls are out of range");
+  }
+  if (controls & (size_t(1) << target)) {
+    throw std::invalid_argument("Target cannot be a control");
+  }
+}
+
+template <typename T>
+size_t BasicDenseState<T>::check_targets(const std::vector<size_t> &targets,
+                                         const size_t controls) const {
+  size_t targets_mask = 0;
+  for (auto target : targets) {
+    check_controls(target, controls);
+    if (targets_mask & (size_t(1) << target)) {
+      throw std::invalid_argument("Targets must be distinct");
+    }
+    targets_mask |= size_t(1) << target;
+  }
+  return targets_mask;
+}
+
+template <typename T>
+void BasicDenseState<T>::apply_gate(const ComplexVectMatrix &gate,
+                                    const size_t target) {
+  apply_controlled_gate(gate, target, 0);
+}
+
+template <typename T>
+void BasicDenseState<T>::apply_controlled_gate(const ComplexVectMatrix &gate,
+                                               const size_t target,
+                                               const size_t controls) {
+  if (gate.row_size() != 2 || gate.column_size() != 2) {
+    throw std::invalid_argument("Gate must be a 2x2 matrix");
+  }
+  if (DiagonalGate::is_diagonal(gate)) {
+    apply_controlled_gate(DiagonalGate(gate), target, controls);
+    return;
+  }
+  if (PermutationGate::is_permutation(gate)) {
+    apply_controlled_gate(PermutationGate(gate), {target}, controls);
+    return;
+  }
+  check_controls(target, controls);
+
+  const std::array<Amplitude, 4> u = {
+      Amplitude(gate.get(0, 0)), Amplitude(gate.get(0, 1)),
+      Amplitude(gate.get(1, 0)), Amplitude(gate.get(1, 1))};
+  auto *real = real_.data();
+  auto *imag = imag_.data();
+  parallel_for_slices(size(), size_t(1) << target, controls,
+                      [&](size_t offset, size_t length, size_t low_controls) {
+                        simd::gate_1q(real + offset, imag + offset, length,
+                                      target, low_controls, u);
+                      });
+}
+
+template <typename T>
+void BasicDenseState<T>::apply_gate(const DiagonalGate &gate,
+                                    const size_t target) {
+  apply_controlled_gate(gate, target, 0);
+}
+
+template <typename T>
+void BasicDenseState<T>::apply_controlled_gate(const DiagonalGate &gate,
+                                               const size_t target,
+                                               const size_t controls) {
+  check_controls(target, controls);
+  if (gate.d0() == Complex(1) && gate.d1() == Complex(1)) {
+    return;
+  }
+
+  const Amplitude d0(gate.d0());
+  const Amplitude d1(gate.d1());
+  auto *real = real_.data();
+  auto *imag = imag_.data();
+  parallel_for_slices(size(), size_t(1) << target, controls,
+                      [&](size_t offset, size_t length, size_t low_controls) {
+                        simd::gate_diagonal(real + offset, imag + offset,
+                                            length, target, low_controls, d0,
+                                            d1);
+                      });
+}
+
+template <typename T>
+void BasicDenseState<T>::apply_gate(const PermutationGate &gate,
+                                    const std::vector<size_t> &targets) {
+  apply_controlled_gate(gate, targets, 0);
+}
+
+template <typename T>
+void BasicDenseState<T>::apply_controlled_gate(
+    const PermutationGate &gate, const std::vector<size_t> &targets,
+    const size_t controls) {
+  if (targets.size() != gate.num_qubits()) {
+    throw std::invalid_argument("Gate expects " +
+                                std::to_string(gate.num_qubits()) +
+                                " targets");
+  }
+  const auto targets_mask = check_targets(targets, controls);
+  auto *real = real_.data();
+  auto *imag = imag_.data();
+
+  if (gate.is_pauli_x()) {
+    parallel_for_slices(
+        size(), targets_mask, controls,
+        [&](size_t offset, size_t length, size_t low_controls) {
+          simd::permute_flip(real + offset, imag + offset, length, targets[0],
+                             low_controls);
+        });
+    return;
+  }
+  if (gate.is_swap()) {
+    parallel_for_slices(
+        size(), targets_mask, controls,
+        [&](size_t offset, size_t length, size_t low_controls) {
+          simd::permute_swap(real + offset, imag + offset, length, targets[0],
+                             targets[1], low_controls);
+        });
+    return;
+  }
+
+  // Any other permutation is gathered and scattered one block at a time.
+  const auto &permutation = gate.permutation();
+  const auto local_size = permutation.size();
+  std::vector<size_t> offsets(local_size, 0);
+  for (size_t l = 0; l < local_size; l++) {
+    for (size_t q = 0; q < targets.size(); q++) {
+      if ((l >> q) & 1) {
+        offsets[l] |= size_t(1) << targets[q];
+      }
+    }
+  }
+  parallel_for_slices(
+      size(), targets_mask, controls,
+      [&](size_t offset, size_t length, size_t low_controls) {
+        const auto fixed = (targets_mask | low_controls) & (length - 1);
+        const auto count = length >> std::popcount(fixed);
+        std::vector<Amplitude> local(local_size);
+        for (size_t j = 0; j < count; j++) {
+          const auto base =
+              offset + (simd::insert_zero_bits(j, fixed) | low_controls);
+          for (size_t l = 0; l < local_size; l++) {
+            local[permutation[l]] = get(base | offsets[l]);
+          }
+          for (size_t l = 0; l < local_size; l++) {
+            set(base | offsets[l], local[l]);
+          }
+        }
+      });
+}
+
+template <typename T>
+void BasicDenseState<T>::apply_gate(const UnitaryGate &gate) {
+  apply_controlled_gate(gate, 0);
+}
+
+template <typename T>
+void BasicDenseState<T>::apply_controlled_gate(const UnitaryGate &gate,
+                                               const size_t controls) {
+  if (gate.num_qubits() == 1) {
+    apply_controlled_gate(gate.matrix(), gate.qubits()[0], controls);
+    return;
+  }
+  const auto targets_mask = check_targets(gate.qubits(), controls);
+
+  const auto &matrix = gate.matrix();
+  const auto elements = matrix.row_size() * matrix.stride();
+  std::vector<T> gate_real, gate_imag;
+  const T *matrix_real = nullptr;
+  const T *matrix_imag = nullptr;
+  if constexpr (std::is_same_v<T, __complex_precision>) {
+    matrix_real = matrix.real_data();
+    matrix_imag = matrix.imag_data();
+  } else {
+    gate_real.assign(matrix.real_data(), matrix.real_data() + elements);
+    gate_imag.assign(matrix.imag_data(), matrix.imag_data() + elements);
+    matrix_real = gate_real.data();
+    matrix_imag = gate_imag.data();
+  }
+  auto *real = real_.data();
+  auto *imag = imag_.data();
+  parallel_for_slices(size(), targets_mask, controls,
+                      [&](size_t offset, size_t length, size_t low_controls) {
+                        simd::gate_kq(real + offset, imag + offset, length,
+                                      gate.qubits(), low_controls, matrix_real,
+                                      matrix_imag, matrix.stride());
+                      });
+}
+
+template <typename T> double BasicDenseState<T>::norm() const {
+  return Reduction::norm(real_.data(), imag_.data(), size());
+}
+
+template <typename T>
+double BasicDenseState<T>::probability(const size_t qubit) const {
+  check_qubit(qubit);
+  const auto bit = size_t(1) << qubit;
+  return Reduction::mass(real_.data(), imag_.data(), size(), bit, bit);
+}
+
+template <typename T>
+std::complex<double>
+BasicDenseState<T>::inner_product(const BasicDenseState &other) const {
+  if (num_qubits_ != other.num_qubits_) {
+    throw std::invalid_argument("States have different qubits");
+  }
+  return Reduction::inner_product(real_.data(), imag_.data(),
+                                  other.real_.data(), other.imag_.data(),
+                                  size());
+}
+
+template <typename T>
+std::unique_ptr<StateVector> BasicDenseState<T>::to_state_vector() const {
+  size_t pivot = 0;
+  T pivot_norm = 0;
+  for (size_t i = 0; i < size(); i++) {
+    const auto norm = std::norm(get(i));
+    if (norm > pivot_norm) {
+      pivot = i;
+      pivot_norm = norm;
+    }
+  }
+  if (pivot_norm == 0) {
+    throw std::invalid_argument("State has no amplitude");
+  }
+
+  // If the state is a product state, the amplitudes along each qubit axis
+  // through the pivot are proportional to that qubit.
+  std::vector<Qubit> qubits(num_qubits_);
+  for (size_t t = 0; t < num_qubits_; t++) {
+    const size_t bit = size_t(1) << t;
+    auto alpha = get(pivot & ~bit);
+    auto beta = get(pivot | bit);
+    const auto reference = std::abs(alpha) > 0 ? alpha : beta;
+    const auto phase = std::conj(reference) / std::abs(reference);
+    const auto norm = std::sqrt(std::norm(alpha) + std::norm(beta));
+    qubits[num_qubits_ - 1 - t] =
+        Qubit(Complex(alpha * phase / norm), Complex(beta * phase / norm));
+  }
+
+  auto result = std::make_unique<StateVector>(qubits);
+  const BasicDenseState expanded(*result);
+  const auto global_phase = get(pivot) / expanded.get(pivot);
+  for (size_t i = 0; i < size(); i++) {
+    if (!approx_equal(get(i), global_phase * expanded.get(i))) {
+      throw std::runtime_error("State is entangled");
+    }
+  }
+  return result;
+}
+
+template <typename T>
+std::unique_ptr<ComplexVectMatrix> BasicDenseState<T>::to_vector() const {
+  auto result = std::make_unique<ComplexVectMatrix>(1, size());
+  const auto amplitudes = result->row(0);
+  std::ranges::copy(real_, amplitudes.real().begin());
+  std::ranges::copy(imag_, amplitudes.imag().begin());
+  return result;
+}
+
+template class BasicDenseState<float>;
+template class BasicDenseState<double>;
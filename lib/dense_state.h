@@ -0,0 +1,187 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DENSE_STATE_H
+#define DENSE_STATE_H
+
+#include "aligned_allocator.h"
+#include "complex_vectorised_matrix.h"
+#include "diagonal_gate.h"
+#include "hilbert_namespace.h"
+#include "permutation_gate.h"
+#include "state_vector.h"
+#include "unitary_gate.h"
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*
+ * This class represents a full state-vector as its 2^n complex amplitudes,
+ * stored in a contiguous, 64-byte aligned buffer with real and imaginary parts
+ * split (as in `ComplexVectSplit`), so that gates can be applied in place by
+ * SIMD kernels. Unlike `StateVector`, it can hold entangled states.
+ *
+ * Qubit `t` corresponds to bit `t` of the amplitude index. A `StateVector`
+ * lists its qubits most significant first, as in the tensor product
+ * q_0 ⊗ q_1 ⊗ ... ⊗ q_{n-1}, so its element `i` is qubit `n - 1 - i` here.
+ *
+ * The amplitudes are first touched by a static loop on the `ThreadPool`, so
+ * that on NUMA machines each thread's share lies on its own node. Gates are
+ * applied in place, slice by slice over the same static chunks (see
+ * `parallel_for_slices`), so that each thread mostly sweeps its own share.
+ *
+ * `T` is the precision of the amplitudes, float or double: `DenseState` fits
+ * twice as many amplitudes in each register and cache line, while
+ * `DoubleDenseState` keeps deep circuits over many qubits accurate. Gates,
+ * product states and vectors are given and returned in `__complex_precision`.
+ */
+template <typename T> class BasicDenseState final {
+public:
+  using Amplitude = std::complex<T>;
+
+  // A `BasicDenseState` can be moved but not copied, as it can be very large.
+  BasicDenseState(BasicDenseState &&) = default;
+  BasicDenseState &operator=(BasicDenseState &&) = default;
+  BasicDenseState(const BasicDenseState &) = delete;
+  BasicDenseState &operator=(const BasicDenseState &) = delete;
+
+  /*
+   * Creates the state |0...0> over `num_qubits` qubits.
+   */
+  explicit BasicDenseState(size_t num_qubits);
+
+  /*
+   * Creates the state as the Kronecker expansion of the given product state.
+   */
+  explicit BasicDenseState(const StateVector &state);
+
+  /*
+   * Creates the state from a 1x2^n vector of amplitudes.
+   */
+  explicit BasicDenseState(const ComplexVectMatrix &vect);
+
+  bool operator==(const BasicDenseState &other) const;
+
+  [[nodiscard]] Amplitude get(const size_t i) const {
+    return Amplitude(real_[i], imag_[i]);
+  }
+
+  void set(const size_t i, const Amplitude &c) {
+    real_[i] = c.real();
+    imag_[i] = c.imag();
+  }
+
+  [[nodiscard]] size_t num_qubits() const { return num_qubits_; }
+
+  [[nodiscard]] size_t size() const { return real_.size(); }
+
+  [[nodiscard]] T *real_data() { return real_.data(); }
+
+  [[nodiscard]] const T *real_data() const { return real_.data(); }
+
+  [[nodiscard]] T *imag_data() { return imag_.data(); }
+
+  [[nodiscard]] const T *imag_data() const { return imag_.data(); }
+
+  /*
+   * Applies the 2x2 `gate` to qubit `target`, in place.
+   */
+  void apply_gate(const ComplexVectMatrix &gate, size_t target);
+
+  /*
+   * Applies the 2x2 `gate` to qubit `target`, in place, only on the amplitudes
+   * where all the qubits in `controls` are set. `controls` is a bitmask,
+   * where bit `q` stands for qubit `q`. Diagonal and permutation gates are
+   * detected and applied through their dedicated kernels.
+   */
+  void apply_controlled_gate(const ComplexVectMatrix &gate, size_t target,
+                             size_t controls);
+
+  void apply_gate(const DiagonalGate &gate, size_t target);
+
+  void apply_controlled_gate(const DiagonalGate &gate, size_t target,
+                             size_t controls);
+
+  /*
+   * Applies the permutation `gate` to the qubits in `targets`, in place, as
+   * pure data movement, where all the qubits in `controls` are set. The q-th
+   * target stands for bit q of the gate's local basis index.
+   */
+  void apply_controlled_gate(const PermutationGate &gate,
+                             const std::vector<size_t> &targets,
+                             size_t controls);
+
+  void apply_gate(const PermutationGate &gate,
+                  const std::vector<size_t> &targets);
+
+  /*
+   * Applies the dense k-qubit `gate` to its qubits, in place and in a single
+   * pass, where all the qubits in `controls` are set.
+   */
+  void apply_controlled_gate(const UnitaryGate &gate, size_t controls);
+
+  void apply_gate(const UnitaryGate &gate);
+
+  /*
+   * @return the Euclidean norm of the amplitudes, 1 for a normalised state.
+   * This and the other reductions below are summed in double precision, in an
+   * order that does not depend on the number of threads (see `Reduction`).
+   */
+  [[nodiscard]] double norm() const;
+
+  /*
+   * @return the probability of measuring qubit `qubit` as 1, that is the mass
+   * of the amplitudes with bit `qubit` set, for a normalised state.
+   */
+  [[nodiscard]] double probability(size_t qubit) const;
+
+  /*
+   * @return <this|other>.
+   */
+  [[nodiscard]] std::complex<double>
+  inner_product(const BasicDenseState &other) const;
+
+  /*
+   * Factorises the state back into its qubits. Each qubit is returned with
+   * the global phase chosen so that alpha is real and non-negative (or beta,
+   * when alpha is zero).
+   * @throws std::invalid_argument if every amplitude is zero.
+   * @throws std::runtime_error if the state is entangled.
+   */
+  [[nodiscard]] std::unique_ptr<StateVector> to_state_vector() const;
+
+  /*
+   * @return the amplitudes as a 1x2^n `ComplexVectMatrix`.
+   */
+  [[nodiscard]] std::unique_ptr<ComplexVectMatrix> to_vector() const;
+
+private:
+  void check_qubit(size_t qubit) const;
+
+  void check_controls(size_t target, size_t controls) const;
+
+  size_t check_targets(const std::vector<size_t> &targets,
+                       size_t controls) const;
+
+  size_t num_qubits_;
+  FirstTouchVector<T> real_;
+  FirstTouchVector<T> imag_;
+};
+
+using DenseState = BasicDenseState<__complex_precision>;
+
+using DoubleDenseState = BasicDenseState<double>;
+
+#endif // !DENSE_STATE_H
@@ -0,0 +1,67 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef DIAGONAL_GATE_H
+#define DIAGONAL_GATE_H
+
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace.h"
+#include <memory>
+#include <stdexcept>
+
+/*
+ * This class represents a single-qubit diagonal gate diag(d0, d1), such as
+ * Pauli-Z, S, T or the QFT rotations R_k. Only the diagonal is stored, so that
+ * the gate can be applied as an element-wise complex multiplication.
+ */
+class DiagonalGate final {
+public:
+  DiagonalGate(const Complex d0, const Complex d1) : d0_(d0), d1_(d1) {}
+
+  explicit DiagonalGate(const ComplexVectMatrix &gate) {
+    if (!is_diagonal(gate)) {
+      throw std::invalid_argument("Gate must be a 2x2 diagonal matrix");
+    }
+    d0_ = gate.get(0, 0);
+    d1_ = gate.get(1, 1);
+  }
+
+  /*
+   * Whether `gate` is a 2x2 matrix whose off-diagonal elements are exactly
+   * zero.
+   */
+  static bool is_diagonal(const ComplexVectMatrix &gate) {
+    return gate.row_size() == 2 && gate.column_size() == 2 &&
+           gate.get(0, 1) == Complex(0) && gate.get(1, 0) == Complex(0);
+  }
+
+  [[nodiscard]] Complex d0() const { return d0_; }
+
+  [[nodiscard]] Complex d1() const { return d1_; }
+
+  [[nodiscard]] std::unique_ptr<ComplexVectMatrix> to_matrix() const {
+    return std::make_unique<ComplexVectMatrix>(
+        ComplexMatrix({{d0_, 0}, {0, d1_}}));
+  }
+
+  static std::unique_ptr<DiagonalGate> pauli_z() {
+    return std::make_unique<DiagonalGate>(1, -1);
+  }
+
+private:
+  Complex d0_;
+  Complex d1_;
+};
+
+#endif // !DIAGONAL_GATE_H
@@ -0,0 +1,332 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "executor.h"
+#include "circuit.h"
+#include "dense_state.h"
+#include "diagonal_gate.h"
+#include "gate_fusion.h"
+#include "hilbert_namespace.h"
+#include "parallel.h"
+#include "permutation_gate.h"
+#include "simd.h"
+#include "system_info.h"
+#include "unitary_gate.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <complex>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+enum class Kernel { Flip, Swap, Diagonal, Dense1q, DenseKq };
+
+// Chunks hold at least one AVX-512 register, so that each is 64-byte aligned.
+constexpr size_t min_local_qubits = 4;
+
+/*
+ * A gate resolved to the kernel applying it, on physical qubits. Controls
+ * below the chunk size are passed to the kernel, the others select chunks.
+ */
+template <typename T> struct KernelOp {
+  Kernel kernel;
+  std::vector<size_t> targets;
+  size_t low_controls = 0;
+  size_t high_controls = 0;
+  std::array<std::complex<T>, 4> u;
+  std::vector<T> gate_real;
+  std::vector<T> gate_imag;
+  size_t gate_stride = 0;
+};
+
+/*
+ * @return the kernel applying `op`: data movement for X and SWAP, a phase
+ * sweep for diagonal gates and the dense kernels for the others.
+ */
+Kernel kernel_of(const GateOp &op) {
+  if (op.targets.size() == 1) {
+    const auto m = op.target_matrix();
+    if (DiagonalGate::is_diagonal(*m)) {
+      return Kernel::Diagonal;
+    }
+    if (PermutationGate::is_permutation(*m)) {
+      return Kernel::Flip;
+    }
+    return Kernel::Dense1q;
+  }
+  return op.kind == GateKind::Swap ? Kernel::Swap : Kernel::DenseKq;
+}
+
+/*
+ * Whether fusion may merge `op` with its neighbours: only uncontrolled gates
+ * that run on a dense kernel anyway. A controlled, permutation or diagonal
+ * gate has a cheaper kernel than a dense gate over all its qubits.
+ */
+bool is_fusable(const GateOp &op) {
+  if (!op.controls.empty()) {
+    return false;
+  }
+  const auto kernel = kernel_of(op);
+  return kernel == Kernel::Dense1q || kernel == Kernel::DenseKq;
+}
+
+/*
+ * Resolves `op` to its kernel, where logical qubit `q` is physical qubit
+ * `position[q]` and chunks span `local_qubits` qubits.
+ */
+template <typename T>
+KernelOp<T> prepare_kernel(const GateOp &op,
+                           const std::vector<size_t> &position,
+                           const size_t local_qubits) {
+  KernelOp<T> k;
+  k.kernel = kernel_of(op);
+  for (auto t : op.targets) {
+    k.targets.push_back(position[t]);
+  }
+  for (auto c : op.controls) {
+    const auto p = position[c];
+    (p < local_qubits ? k.low_controls : k.high_controls) |= size_t(1) << p;
+  }
+
+  if (op.targets.size() == 1) {
+    const auto u = op.target_elements();
+    std::ranges::transform(u, k.u.begin(), [](const std::complex<double> c) {
+      return std::complex<T>(c);
+    });
+  } else if (k.kernel == Kernel::DenseKq) {
+    for (const auto &e : op.target_dense_elements()) {
+      k.gate_real.push_back(static_cast<T>(e.real()));
+      k.gate_imag.push_back(static_cast<T>(e.imag()));
+    }
+    k.gate_stride = size_t(1) << op.targets.size();
+  }
+  return k;
+}
+
+/*
+ * Applies `k` to the `length` amplitudes starting at `real` and `imag`, where
+ * all the qubits in `controls` are set.
+ */
+template <typename T>
+void apply_kernel(const KernelOp<T> &k, T *real, T *imag, const size_t length,
+                  const size_t controls) {
+  switch (k.kernel) {
+  case Kernel::Flip:
+    simd::permute_flip(real, imag, length, k.targets[0], controls);
+    return;
+  case Kernel::Swap:
+    simd::permute_swap(real, imag, length, k.targets[0], k.targets[1],
+                       controls);
+    return;
+  case Kernel::Diagonal:
+    if (k.u[0] != std::complex<T>(1) || k.u[3] != std::complex<T>(1)) {
+      simd::gate_diagonal(real, imag, length, k.targets[0], controls, k.u[0],
+                          k.u[3]);
+    }
+    return;
+  case Kernel::Dense1q:
+    simd::gate_1q(real, imag, length, k.targets[0], controls, k.u);
+    return;
+  case Kernel::DenseKq:
+    simd::gate_kq(real, imag, length, k.targets, controls, k.gate_real.data(),
+                  k.gate_imag.data(), k.gate_stride);
+    return;
+  }
+}
+
+template <typename T> size_t Executor::cache_local_qubits() {
+  const auto amplitude_bytes = 2 * sizeof(T);
+  const auto amplitudes = SystemInfo::l2_cache_bytes() / 2 / amplitude_bytes;
+  return std::max<size_t>(min_local_qubits, std::bit_width(amplitudes) - 1);
+}
+
+template <typename T>
+void Executor::run(const Circuit &circuit, BasicDenseState<T> &state) {
+  if (circuit.num_qubits() != state.num_qubits()) {
+    throw std::invalid_argument("Circuit and state have different qubits");
+  }
+
+  std::vector<GateOp> ops;
+  if (max_fused_qubits_ == 0) {
+    ops = circuit.ops();
+  } else {
+    // Runs of fusable gates are merged, the other gates are kept in place.
+    auto fusion = GateFusion(max_fused_qubits_);
+    std::vector<DenseGate> run;
+    const auto flush = [&] {
+      using Elements = std::vector<std::complex<double>>;
+      for (auto &gate : fusion.fuse(run)) {
+        ops.push_back({GateKind::Unitary, std::move(gate.qubits), {}, 0,
+                       nullptr,
+                       std::make_shared<const Elements>(
+                           std::move(gate.elements))});
+      }
+      run.clear();
+    };
+    for (const auto &op : circuit.ops()) {
+      if (is_fusable(op)) {
+        run.push_back({op.targets, op.target_dense_elements()});
+      } else {
+        flush();
+        ops.push_back(op);
+      }
+    }
+    flush();
+    fusion_stats_ = {circuit.size(), ops.size()};
+  }
+
+  if (mode_ == ExecutionMode::CacheBlocked) {
+    run_blocked(ops, state);
+  } else {
+    run_direct(ops, state);
+  }
+}
+
+template <typename T>
+void Executor::run_direct(const std::vector<GateOp> &ops,
+                          BasicDenseState<T> &state) {
+  std::vector<size_t> identity(state.num_qubits());
+  std::iota(identity.begin(), identity.end(), 0);
+  auto *real = state.real_data();
+  auto *imag = state.imag_data();
+  for (const auto &op : ops) {
+    const auto k = prepare_kernel<T>(op, identity, state.num_qubits());
+    size_t targets = 0;
+    for (auto t : k.targets) {
+      targets |= size_t(1) << t;
+    }
+    // Each thread sweeps the slices of the chunk `Numa::first_touch` gave it.
+    parallel_for_slices(
+        state.size(), targets, k.low_controls,
+        [&](size_t offset, size_t length, size_t controls) {
+          apply_kernel(k, real + offset, imag + offset, length, controls);
+        });
+  }
+}
+
+template <typename T>
+void Executor::run_blocked(const std::vector<GateOp> &ops,
+                           BasicDenseState<T> &state) {
+  const auto n = state.num_qubits();
+  size_t widest = 1;
+  for (const auto &op : ops) {
+    widest = std::max(widest, op.targets.size());
+  }
+  const auto local_qubits =
+      std::max(local_qubits_ == 0 ? cache_local_qubits<T>() : local_qubits_,
+               std::max(widest, min_local_qubits));
+  blocking_stats_ = BlockingStats();
+  if (local_qubits >= n) {
+    run_direct(ops, state);
+    return;
+  }
+
+  auto *real = state.real_data();
+  auto *imag = state.imag_data();
+  const size_t chunk_size = size_t(1) << local_qubits;
+
+  // Logical qubit q is stored as physical qubit position[q].
+  std::vector<size_t> position(n), logical(n);
+  std::iota(position.begin(), position.end(), 0);
+  std::iota(logical.begin(), logical.end(), 0);
+
+  std::vector<KernelOp<T>> pending;
+  const auto flush = [&] {
+    if (pending.empty()) {
+      return;
+    }
+    // The static chunks of `Numa::first_touch` keep every chunk on the
+    // thread, and so on the NUMA node, that first touched it.
+    parallel_for_static(
+        state.size(),
+        [&](size_t start, size_t end) {
+          for (size_t c = start >> local_qubits; c < end >> local_qubits;
+               c++) {
+            const size_t base = c << local_qubits;
+            for (const auto &k : pending) {
+              if ((base & k.high_controls) == k.high_controls) {
+                apply_kernel(k, real + base, imag + base, chunk_size,
+                             k.low_controls);
+              }
+            }
+          }
+        },
+        chunk_size);
+    blocking_stats_.passes++;
+    pending.clear();
+  };
+  // Swaps follow the same static chunks as the passes.
+  const auto swap_physical = [&](const size_t a, const size_t b) {
+    parallel_for_slices(
+        state.size(), (size_t(1) << a) | (size_t(1) << b), 0,
+        [&](size_t offset, size_t length, size_t controls) {
+          simd::permute_swap(real + offset, imag + offset, length, a, b,
+                             controls);
+        });
+    std::swap(logical[a], logical[b]);
+    position[logical[a]] = a;
+    position[logical[b]] = b;
+    blocking_stats_.swaps++;
+  };
+  // Index of the next op from `from` targeting logical qubit `q`.
+  const auto next_use = [&ops](const size_t q, const size_t from) {
+    for (size_t i = from; i < ops.size(); i++) {
+      const auto &targets = ops[i].targets;
+      if (std::find(targets.begin(), targets.end(), q) != targets.end()) {
+        return i;
+      }
+    }
+    return ops.size();
+  };
+
+  for (size_t i = 0; i < ops.size(); i++) {
+    const auto &targets = ops[i].targets;
+    for (auto t : targets) {
+      if (position[t] < local_qubits) {
+        continue;
+      }
+      // Evict the low qubit whose next use as a target is the furthest.
+      flush();
+      size_t victim = local_qubits;
+      size_t victim_use = 0;
+      for (size_t p = 0; p < local_qubits; p++) {
+        if (std::find(targets.begin(), targets.end(), logical[p]) !=
+            targets.end()) {
+          continue;
+        }
+        const auto use = next_use(logical[p], i);
+        if (victim == local_qubits || use > victim_use) {
+          victim = p;
+          victim_use = use;
+        }
+      }
+      swap_physical(position[t], victim);
+    }
+    pending.push_back(prepare_kernel<T>(ops[i], position, local_qubits));
+  }
+  flush();
+
+  for (size_t q = 0; q < n; q++) {
+    if (position[q] != q) {
+      swap_physical(position[q], q);
+    }
+  }
+}
+
+template size_t Executor::cache_local_qubits<float>();
+template size_t Executor::cache_local_qubits<double>();
+template void Executor::run(const Circuit &, BasicDenseState<float> &);
+template void Executor::run(const Circuit &, BasicDenseState<double> &);
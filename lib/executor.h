@@ -0,0 +1,108 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include "circuit.h"
+#include "dense_state.h"
+#include "gate_fusion.h"
+#include "hilbert_namespace.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * How an `Executor` walks the state. `Direct` sweeps the whole state once per
+ * gate, each thread over its own static chunk. `CacheBlocked` keeps the low
+ * qubits resident in cache: a gate on a high qubit first swaps it into the
+ * low range, and the gates pending on the low qubits are applied chunk by
+ * chunk, one cache-sized block at a time.
+ */
+enum class ExecutionMode { Direct, CacheBlocked };
+
+/*
+ * Counters of a cache-blocked run: the qubit swaps inserted (including the
+ * ones restoring the qubit order at the end) and the passes over the chunks.
+ */
+struct BlockingStats {
+  size_t swaps = 0;
+  size_t passes = 0;
+};
+
+/*
+ * This class runs a recorded `Circuit` against a dense state. Each gate is
+ * resolved to the kernel matching it (data movement for X and SWAP, a phase
+ * sweep for diagonal gates, the dense kernels for the others). With fusion
+ * enabled, runs of uncontrolled gates bound for the dense kernels are first
+ * merged into dense gates of up to `max_fused_qubits` qubits, while the
+ * other gates keep their own kernels.
+ *
+ * States of either precision can be run. Gates are built, and fused gates
+ * multiplied, in double precision, then rounded to the precision of the
+ * state, so that a `DoubleDenseState` is only limited by the gates recorded
+ * as `__complex_precision` matrices.
+ */
+class Executor final {
+public:
+  /*
+   * @param max_fused_qubits the widest fused gate, 0 to disable fusion.
+   * @param mode how the state is walked.
+   * @param local_qubits the cache-resident qubits of `CacheBlocked`, 0 to
+   * derive them from the L2 cache size.
+   */
+  explicit Executor(size_t max_fused_qubits = 0,
+                    ExecutionMode mode = ExecutionMode::Direct,
+                    size_t local_qubits = 0)
+      : max_fused_qubits_(max_fused_qubits), mode_(mode),
+        local_qubits_(local_qubits) {}
+
+  template <typename T>
+  void run(const Circuit &circuit, BasicDenseState<T> &state);
+
+  /*
+   * @return the statistics of the last fused run.
+   */
+  [[nodiscard]] const FusionStats &fusion_stats() const {
+    return fusion_stats_;
+  }
+
+  /*
+   * @return the statistics of the last cache-blocked run.
+   */
+  [[nodiscard]] const BlockingStats &blocking_stats() const {
+    return blocking_stats_;
+  }
+
+  /*
+   * @return the number of low qubits whose amplitudes, of precision `T`, fill
+   * half the L2 cache.
+   */
+  template <typename T = __complex_precision>
+  [[nodiscard]] static size_t cache_local_qubits();
+
+private:
+  template <typename T>
+  void run_direct(const std::vector<GateOp> &ops, BasicDenseState<T> &state);
+
+  template <typename T>
+  void run_blocked(const std::vector<GateOp> &ops, BasicDenseState<T> &state);
+
+  size_t max_fused_qubits_;
+  ExecutionMode mode_;
+  size_t local_qubits_;
+  FusionStats fusion_stats_;
+  BlockingStats blocking_stats_;
+};
+
+#endif // !EXECUTOR_H
@@ -0,0 +1,458 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "fft_engine.h"
+#include "aligned_allocator.h"
+#include "hilbert_namespace.h"
+#include "parallel.h"
+#include "simd.h"
+#include <array>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef __APPLE__
+#include <Accelerate/Accelerate.h>
+#else
+#include "simd_backend.h"
+#include <immintrin.h>
+#endif
+
+#ifndef __APPLE__
+// Stages whose butterflies span at most 2^fft_block_qubits amplitudes run
+// block by block, so that each block stays in cache across all of them.
+constexpr size_t fft_block_qubits = 13;
+
+// The bit-reversal permutation moves tiles of 2^fft_tile_qubits x
+// 2^fft_tile_qubits amplitudes, a cache line of floats per row.
+constexpr size_t fft_tile_qubits = 4;
+
+// Twiddle factors computed by recurrence between two trigonometric seeds.
+constexpr size_t fft_twiddle_run = 64;
+
+constexpr auto fft_byte_reverse = [] {
+  std::array<uint8_t, 256> table{};
+  for (size_t i = 0; i < table.size(); i++) {
+    for (size_t b = 0; b < 8; b++) {
+      table[i] |= static_cast<uint8_t>(((i >> b) & 1) << (7 - b));
+    }
+  }
+  return table;
+}();
+
+/*
+ * Reverses the `n` low bits of `i`.
+ */
+size_t fft_reverse_bits(const size_t i, const size_t n) {
+  if (n == 0) {
+    return 0;
+  }
+  size_t r = 0;
+  for (size_t b = 0; b < sizeof(size_t); b++) {
+    r = (r << 8) | fft_byte_reverse[(i >> (8 * b)) & 0xff];
+  }
+  return r >> (8 * sizeof(size_t) - n);
+}
+
+/*
+ * Swaps amplitudes `i` and `r`, scaling both, or only scales `i` when they
+ * are the same.
+ */
+template <typename T>
+inline void fft_swap_scaled(T *real, T *imag, const size_t i, const size_t r,
+                            const T scale) {
+  const auto i_real = real[i] * scale;
+  const auto i_imag = imag[i] * scale;
+  real[i] = real[r] * scale;
+  imag[i] = imag[r] * scale;
+  real[r] = i_real;
+  imag[r] = i_imag;
+}
+
+/*
+ * Permutes the amplitudes into bit-reversed order, scaling them on the way.
+ *
+ * An index is split into a high part `a` and a low part `d` of
+ * fft_tile_qubits bits each, around a middle part `c`, so that (a, c, d) goes
+ * to (rev d, rev c, rev a). The tiles of all the (a, d) for a given `c` and
+ * for `rev c` are swapped together: both touch 2^fft_tile_qubits cache lines
+ * only, instead of one line per amplitude.
+ */
+template <typename T>
+void fft_bit_reverse(T *real, T *imag, const size_t length, const T scale) {
+  const auto n = static_cast<size_t>(std::countr_zero(length));
+  if (n < 2 * fft_tile_qubits) {
+    for (size_t i = 0; i < length; i++) {
+      const auto r = fft_reverse_bits(i, n);
+      if (r >= i) {
+        fft_swap_scaled(real, imag, i, r, scale);
+      }
+    }
+    return;
+  }
+
+  const size_t tile = size_t(1) << fft_tile_qubits;
+  const size_t middle_qubits = n - 2 * fft_tile_qubits;
+  const size_t high_shift = n - fft_tile_qubits;
+  std::array<size_t, tile> reverse_tile;
+  for (size_t x = 0; x < tile; x++) {
+    reverse_tile[x] = fft_reverse_bits(x, fft_tile_qubits);
+  }
+  parallel_for(size_t(1) << middle_qubits, [&](size_t start, size_t end) {
+    for (size_t c = start; c < end; c++) {
+      const auto rc = fft_reverse_bits(c, middle_qubits);
+      if (rc < c) {
+        continue;
+      }
+      for (size_t a = 0; a < tile; a++) {
+        for (size_t d = 0; d < tile; d++) {
+          const size_t i = (a << high_shift) | (c << fft_tile_qubits) | d;
+          const size_t r = (reverse_tile[d] << high_shift) |
+                           (rc << fft_tile_qubits) | reverse_tile[a];
+          // Within the same tile, each pair is swapped once.
+          if (rc != c || r >= i) {
+            fft_swap_scaled(real, imag, i, r, scale);
+          }
+        }
+      }
+    }
+  });
+}
+
+/*
+ * Twiddle factors of every stage: the stage of half-size h uses the entries
+ * [h, 2h), where entry h + j is e^(+-pi i j / h). The largest stage is
+ * computed by a rotation recurrence in double precision, reseeded with
+ * trigonometry every fft_twiddle_run entries so that its drift stays below
+ * double rounding, and the others are subsampled from it.
+ */
+template <typename T>
+void fft_twiddles(const size_t length, const bool inverse,
+                  AlignedVector<T> &w_real, AlignedVector<T> &w_imag) {
+  w_real.assign(length, 0);
+  w_imag.assign(length, 0);
+  const size_t half = length / 2;
+  const double step = (inverse ? -1 : 1) * std::numbers::pi /
+                      static_cast<double>(half);
+  const std::complex<double> rotation = std::polar(1.0, step);
+  parallel_for(half, [&](size_t start, size_t end) {
+    std::complex<double> w;
+    for (size_t j = start; j < end; j++) {
+      if (j == start || j % fft_twiddle_run == 0) {
+        w = std::polar(1.0, step * static_cast<double>(j));
+      }
+      w_real[half + j] = static_cast<T>(w.real());
+      w_imag[half + j] = static_cast<T>(w.imag());
+      w *= rotation;
+    }
+  });
+  for (size_t h = half / 2; h >= 1; h /= 2) {
+    for (size_t j = 0; j < h; j++) {
+      w_real[h + j] = w_real[2 * h + 2 * j];
+      w_imag[h + j] = w_imag[2 * h + 2 * j];
+    }
+  }
+}
+
+/*
+ * Radix-2 stage of half-size `h` on the butterflies [first, last): butterfly
+ * t pairs a = (t / h) * 2h + t % h with a + h.
+ */
+template <typename T>
+void fft_radix2_scalar(T *real, T *imag, const size_t first, const size_t last,
+                       const size_t h, const T *w_real, const T *w_imag) {
+  for (size_t t = first; t < last; t++) {
+    const size_t j = t % h;
+    const size_t a = (t / h) * 2 * h + j;
+    const std::complex<T> w(w_real[h + j], w_imag[h + j]);
+    const auto x = std::complex<T>(real[a + h], imag[a + h]) * w;
+    const std::complex<T> y(real[a], imag[a]);
+    real[a] = (y + x).real();
+    imag[a] = (y + x).imag();
+    real[a + h] = (y - x).real();
+    imag[a + h] = (y - x).imag();
+  }
+}
+
+/*
+ * Every stage, as radix-2 butterflies one at a time, in parallel.
+ */
+template <typename T>
+void fft_radix2_stages(T *real, T *imag, const size_t length, const T *w_real,
+                       const T *w_imag) {
+  for (size_t h = 1; h < length; h *= 2) {
+    parallel_for(length / 2, [&](size_t start, size_t end) {
+      fft_radix2_scalar(real, imag, start, end, h, w_real, w_imag);
+    });
+  }
+}
+
+// The butterflies below are compiled for AVX2 and FMA, whatever the flags of
+// the library, and only run when the CPU supports them (see `simd::isa`).
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), \
+                             apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+/*
+ * Complex product of split registers.
+ */
+inline void fft_cmul_avx(const __m256 a_r, const __m256 a_i, const __m256 b_r,
+                         const __m256 b_i, __m256 &r, __m256 &i) {
+  r = _mm256_fmsub_ps(a_r, b_r, _mm256_mul_ps(a_i, b_i));
+  i = _mm256_fmadd_ps(a_r, b_i, _mm256_mul_ps(a_i, b_r));
+}
+
+/*
+ * `fft_radix2_scalar` eight butterflies at a time, when h >= 8.
+ */
+void fft_radix2(__complex_precision *real, __complex_precision *imag,
+                const size_t first, const size_t last, const size_t h,
+                const __complex_precision *w_real,
+                const __complex_precision *w_imag) {
+  if (h < 8) {
+    fft_radix2_scalar(real, imag, first, last, h, w_real, w_imag);
+    return;
+  }
+  for (size_t t = first; t < last; t += 8) {
+    const size_t j = t % h;
+    const size_t a = (t / h) * 2 * h + j;
+    const __m256 y_r = _mm256_load_ps(real + a);
+    const __m256 y_i = _mm256_load_ps(imag + a);
+    __m256 x_r, x_i;
+    fft_cmul_avx(_mm256_load_ps(w_real + h + j), _mm256_load_ps(w_imag + h + j),
+                 _mm256_load_ps(real + a + h), _mm256_load_ps(imag + a + h),
+                 x_r, x_i);
+    _mm256_store_ps(real + a, _mm256_add_ps(y_r, x_r));
+    _mm256_store_ps(imag + a, _mm256_add_ps(y_i, x_i));
+    _mm256_store_ps(real + a + h, _mm256_sub_ps(y_r, x_r));
+    _mm256_store_ps(imag + a + h, _mm256_sub_ps(y_i, x_i));
+  }
+}
+
+/*
+ * The three stages of half-size 1, 2 and 4 in registers, on the 8-amplitude
+ * chunks [first, last). In each stage a lane is combined with its partner
+ * lane l ^ h, obtained with a permute: lane l becomes a + s w b, where a and
+ * b are the upper and lower amplitudes of its butterfly, w is its twiddle
+ * and s is -1 on the lanes with bit h set.
+ */
+void fft_radix8_low(__complex_precision *real, __complex_precision *imag,
+                    const size_t first, const size_t last,
+                    const __complex_precision *w_real,
+                    const __complex_precision *w_imag) {
+  __m256i partner[3];
+  __m256 upper[3], sw_real[3], sw_imag[3];
+  for (size_t s = 0; s < 3; s++) {
+    const size_t h = size_t(1) << s;
+    alignas(32) int idx[8];
+    alignas(32) __complex_precision mask[8], k_real[8], k_imag[8];
+    for (size_t l = 0; l < 8; l++) {
+      const bool is_upper = (l & h) != 0;
+      const __complex_precision sign = is_upper ? -1 : 1;
+      idx[l] = static_cast<int>(l ^ h);
+      mask[l] = is_upper ? -0.0f : 0.0f;
+      k_real[l] = sign * w_real[h + l % h];
+      k_imag[l] = sign * w_imag[h + l % h];
+    }
+    partner[s] = _mm256_load_si256(reinterpret_cast<const __m256i *>(idx));
+    upper[s] = _mm256_load_ps(mask);
+    sw_real[s] = _mm256_load_ps(k_real);
+    sw_imag[s] = _mm256_load_ps(k_imag);
+  }
+
+  for (size_t i = first * 8; i < last * 8; i += 8) {
+    __m256 x_r = _mm256_load_ps(real + i);
+    __m256 x_i = _mm256_load_ps(imag + i);
+    for (size_t s = 0; s < 3; s++) {
+      const __m256 p_r = _mm256_permutevar8x32_ps(x_r, partner[s]);
+      const __m256 p_i = _mm256_permutevar8x32_ps(x_i, partner[s]);
+      const __m256 a_r = _mm256_blendv_ps(x_r, p_r, upper[s]);
+      const __m256 a_i = _mm256_blendv_ps(x_i, p_i, upper[s]);
+      const __m256 b_r = _mm256_blendv_ps(p_r, x_r, upper[s]);
+      const __m256 b_i = _mm256_blendv_ps(p_i, x_i, upper[s]);
+      __m256 t_r, t_i;
+      fft_cmul_avx(sw_real[s], sw_imag[s], b_r, b_i, t_r, t_i);
+      x_r = _mm256_add_ps(a_r, t_r);
+      x_i = _mm256_add_ps(a_i, t_i);
+    }
+    _mm256_store_ps(real + i, x_r);
+    _mm256_store_ps(imag + i, x_i);
+  }
+}
+
+/*
+ * Stages of half-size `h` and `2h` fused, on the quads [first, last): quad t
+ * holds a = (t / h) * 4h + t % h and a + h, a + 2h, a + 3h, so that each
+ * amplitude is loaded and stored once for two stages. Requires h >= 8.
+ */
+void fft_radix4(__complex_precision *real, __complex_precision *imag,
+                const size_t first, const size_t last, const size_t h,
+                const __complex_precision *w_real,
+                const __complex_precision *w_imag) {
+  for (size_t t = first; t < last; t += 8) {
+    const size_t j = t % h;
+    const size_t a = (t / h) * 4 * h + j;
+    const size_t b = a + h, c = a + 2 * h, d = a + 3 * h;
+    const __m256 w1_r = _mm256_load_ps(w_real + h + j);
+    const __m256 w1_i = _mm256_load_ps(w_imag + h + j);
+    const __m256 w2_r = _mm256_load_ps(w_real + 2 * h + j);
+    const __m256 w2_i = _mm256_load_ps(w_imag + 2 * h + j);
+    const __m256 w3_r = _mm256_load_ps(w_real + 3 * h + j);
+    const __m256 w3_i = _mm256_load_ps(w_imag + 3 * h + j);
+
+    const __m256 a_r = _mm256_load_ps(real + a);
+    const __m256 a_i = _mm256_load_ps(imag + a);
+    const __m256 c_r = _mm256_load_ps(real + c);
+    const __m256 c_i = _mm256_load_ps(imag + c);
+    __m256 x_r, x_i, y_r, y_i;
+
+    // First stage: (a, b) and (c, d), with twiddle w1.
+    fft_cmul_avx(w1_r, w1_i, _mm256_load_ps(real + b),
+                 _mm256_load_ps(imag + b), x_r, x_i);
+    fft_cmul_avx(w1_r, w1_i, _mm256_load_ps(real + d),
+                 _mm256_load_ps(imag + d), y_r, y_i);
+    const __m256 a1_r = _mm256_add_ps(a_r, x_r);
+    const __m256 a1_i = _mm256_add_ps(a_i, x_i);
+    const __m256 b1_r = _mm256_sub_ps(a_r, x_r);
+    const __m256 b1_i = _mm256_sub_ps(a_i, x_i);
+    const __m256 c1_r = _mm256_add_ps(c_r, y_r);
+    const __m256 c1_i = _mm256_add_ps(c_i, y_i);
+    const __m256 d1_r = _mm256_sub_ps(c_r, y_r);
+    const __m256 d1_i = _mm256_sub_ps(c_i, y_i);
+
+    // Second stage: (a, c) with twiddle w2, (b, d) with twiddle w3.
+    fft_cmul_avx(w2_r, w2_i, c1_r, c1_i, x_r, x_i);
+    fft_cmul_avx(w3_r, w3_i, d1_r, d1_i, y_r, y_i);
+    _mm256_store_ps(real + a, _mm256_add_ps(a1_r, x_r));
+    _mm256_store_ps(imag + a, _mm256_add_ps(a1_i, x_i));
+    _mm256_store_ps(real + c, _mm256_sub_ps(a1_r, x_r));
+    _mm256_store_ps(imag + c, _mm256_sub_ps(a1_i, x_i));
+    _mm256_store_ps(real + b, _mm256_add_ps(b1_r, y_r));
+    _mm256_store_ps(imag + b, _mm256_add_ps(b1_i, y_i));
+    _mm256_store_ps(real + d, _mm256_sub_ps(b1_r, y_r));
+    _mm256_store_ps(imag + d, _mm256_sub_ps(b1_i, y_i));
+  }
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
+
+void fft_check_length(const size_t length) {
+  if (length == 0 || !std::has_single_bit(length)) {
+    throw std::invalid_argument("Length must be a power of two, got " +
+                                std::to_string(length));
+  }
+}
+
+void FftEngine::transform(__complex_precision *real, __complex_precision *imag,
+                          const size_t length, const bool inverse) {
+  fft_check_length(length);
+  const auto scale = static_cast<__complex_precision>(
+      1 / std::sqrt(static_cast<double>(length)));
+
+#ifdef __APPLE__
+  const auto log2n = static_cast<vDSP_Length>(std::countr_zero(length));
+  FFTSetup setup = vDSP_create_fftsetup(log2n, kFFTRadix2);
+  DSPSplitComplex split = {real, imag};
+  // vDSP's forward direction uses e^(-i), the opposite of the QFT.
+  vDSP_fft_zip(setup, &split, 1, log2n,
+               inverse ? kFFTDirection_Forward : kFFTDirection_Inverse);
+  vDSP_destroy_fftsetup(setup);
+  vDSP_vsmul(real, 1, &scale, real, 1, length);
+  vDSP_vsmul(imag, 1, &scale, imag, 1, length);
+#else
+  fft_bit_reverse(real, imag, length, scale);
+  if (length == 1) {
+    return;
+  }
+  AlignedVector<__complex_precision> w_real, w_imag;
+  fft_twiddles(length, inverse, w_real, w_imag);
+
+  // Without AVX2, every stage runs radix-2 butterflies one at a time.
+  if (simd::isa() < Isa::Avx2) {
+    fft_radix2_stages(real, imag, length, w_real.data(), w_imag.data());
+    return;
+  }
+
+  // Stages within a cache block, block by block.
+  const size_t block = std::min(length, size_t(1) << fft_block_qubits);
+  parallel_for(length / block, [&](size_t start, size_t end) {
+    for (size_t b = start; b < end; b++) {
+      size_t h = 1;
+      if (block >= 8) {
+        fft_radix8_low(real + b * block, imag + b * block, 0, block / 8,
+                       w_real.data(), w_imag.data());
+        h = 8;
+      }
+      for (; h < block; h *= 2) {
+        fft_radix2(real + b * block, imag + b * block, 0, block / 2, h,
+                   w_real.data(), w_imag.data());
+      }
+    }
+  });
+
+  // Stages across blocks, two at a time, and a last single one if needed.
+  size_t h = block;
+  for (; 4 * h <= length; h *= 4) {
+    parallel_for(length / 32, [&](size_t start, size_t end) {
+      fft_radix4(real, imag, start * 8, end * 8, h, w_real.data(),
+                 w_imag.data());
+    });
+  }
+  if (h < length) {
+    parallel_for(length / 16, [&](size_t start, size_t end) {
+      fft_radix2(real, imag, start * 8, end * 8, h, w_real.data(),
+                 w_imag.data());
+    });
+  }
+#endif
+}
+
+void FftEngine::transform(double *real, double *imag, const size_t length,
+                          const bool inverse) {
+  fft_check_length(length);
+  const auto scale = 1 / std::sqrt(static_cast<double>(length));
+
+#ifdef __APPLE__
+  const auto log2n = static_cast<vDSP_Length>(std::countr_zero(length));
+  FFTSetupD setup = vDSP_create_fftsetupD(log2n, kFFTRadix2);
+  DSPDoubleSplitComplex split = {real, imag};
+  vDSP_fft_zipD(setup, &split, 1, log2n,
+                inverse ? kFFTDirection_Forward : kFFTDirection_Inverse);
+  vDSP_destroy_fftsetupD(setup);
+  vDSP_vsmulD(real, 1, &scale, real, 1, length);
+  vDSP_vsmulD(imag, 1, &scale, imag, 1, length);
+#else
+  fft_bit_reverse(real, imag, length, scale);
+  if (length == 1) {
+    return;
+  }
+  AlignedVector<double> w_real, w_imag;
+  fft_twiddles(length, inverse, w_real, w_imag);
+  fft_radix2_stages(real, imag, length, w_real.data(), w_imag.data());
+#endif
+}
@@ -0,0 +1,45 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef FFT_ENGINE_H
+#define FFT_ENGINE_H
+
+#include "hilbert_namespace.h"
+#include <cstddef>
+
+class FftEngine {
+public:
+  FftEngine() = delete;
+
+  /*
+   * In-place unitary DFT of `length` (a power of two) split amplitudes:
+   * b_k = 1/sqrt(N) sum_j a_j e^(2 pi i jk / N), which is the QFT of a dense
+   * state, or its inverse with e^(-2 pi i jk / N).
+   *
+   * The input is bit-reversed (and scaled) first, then the stages whose
+   * butterflies fit in a cache block run block by block, and the remaining
+   * stages run two at a time (radix-4) over the whole vector, in parallel.
+   * `real` and `imag` must be 32-byte aligned.
+   */
+  static void transform(__complex_precision *real, __complex_precision *imag,
+                        size_t length, bool inverse = false);
+
+  /*
+   * `transform` in double precision, with radix-2 stages only.
+   */
+  static void transform(double *real, double *imag, size_t length,
+                        bool inverse = false);
+};
+
+#endif // !FFT_ENGINE_H
@@ -15,24 +15,20 @@
 #include "gate_engine.h"
 #include "algebra_engine.h"
 #include "complex_vectorised_matrix.h"
+#include "dense_state.h"
+#include "diagonal_gate.h"
 #include "hilbert_namespace.h"
 #include "lazy_operation.h"
+#include "permutation_gate.h"
 #include "qubit.h"
+#include "state_vector.h"
 #include <complex>
 #include <memory>
 #include <numbers>
 #include <stdexcept>
 
-std::unique_ptr<LazyOperation> make_controlled_u(const ComplexVectMatrix &u) {
-  auto proj_i = ComplexVectMatrix(
-      ComplexMatrix{{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}});
-  auto ket_1_density_mat = ComplexVectMatrix(ComplexMatrix{{0, 0}, {0, 1}});
-  auto proj_u = AlgebraEngine::tensor_product(ket_1_density_mat, u);
-  return AlgebraEngine::sum(proj_i, *proj_u);
-}
-
 std::unique_ptr<ComplexVectMatrix>
-reduced_density_matrix(const LazyOperation &s) {
+reduced_density_matrix(const ComplexVectMatrix &s) {
   if (s.row_size() != 1 || s.column_size() != 4) {
     throw std::invalid_argument(
         "Cannot compute reduced density matrix for state vector of size != 4");
@@ -48,7 +44,7 @@ reduced_density_matrix(const LazyOperation &s) {
                       beta * std::conj(beta) + delta * std::conj(delta)}}));
 }
 
-std::unique_ptr<Qubit> trace_out_target(const LazyOperation &s) {
+std::unique_ptr<Qubit> trace_out_target(const ComplexVectMatrix &s) {
   auto reduced = reduced_density_matrix(s);
   Complex zero(0), one(1);
   Complex alpha, beta;
@@ -84,19 +80,81 @@ GateEngine::apply_gate(const ComplexVectMatrix &gate,
   return AlgebraEngine::matrix_vector_product(gate, state);
 }
 
+template <typename T>
+void GateEngine::apply_gate(const ComplexVectMatrix &gate,
+                            BasicDenseState<T> &state, const size_t target) {
+  state.apply_gate(gate, target);
+}
+
 std::unique_ptr<Qubit> GateEngine::controlled_u(const Qubit &target,
                                                 const Qubit &control,
                                                 const ComplexVectMatrix &u) {
   if (!AlgebraEngine::is_unitary(u)) {
     throw std::runtime_error("U is not unitary");
   }
-  auto state =
-      AlgebraEngine::tensor_product(*control.to_vector(), *target.to_vector());
-  auto transformed_state = AlgebraEngine::matrix_vector_product(
-      std::move(make_controlled_u(u)), std::move(state));
-  return trace_out_target(*transformed_state);
+  // control ⊗ target: the control is qubit 1, the target is qubit 0.
+  auto state = DenseState(StateVector({control, target}));
+  state.apply_controlled_gate(u, 0, 0b10);
+  return trace_out_target(*state.to_vector());
+}
+
+template <typename T>
+void GateEngine::controlled_u(BasicDenseState<T> &state, const size_t target,
+                              const size_t controls,
+                              const ComplexVectMatrix &u) {
+  state.apply_controlled_gate(u, target, controls);
+}
+
+template <typename T>
+void GateEngine::controlled_phase(BasicDenseState<T> &state,
+                                  const size_t target, const size_t controls,
+                                  const DiagonalGate &phase) {
+  state.apply_controlled_gate(phase, target, controls);
+}
+
+template <typename T>
+void GateEngine::cnot(BasicDenseState<T> &state, const size_t control,
+                      const size_t target) {
+  state.apply_controlled_gate(*PermutationGate::pauli_x(), {target},
+                              size_t(1) << control);
+}
+
+template <typename T>
+void GateEngine::toffoli(BasicDenseState<T> &state, const size_t control_a,
+                         const size_t control_b, const size_t target) {
+  state.apply_controlled_gate(*PermutationGate::pauli_x(), {target},
+                              (size_t(1) << control_a) |
+                                  (size_t(1) << control_b));
+}
+
+template <typename T>
+void GateEngine::swap(BasicDenseState<T> &state, const size_t a,
+                      const size_t b) {
+  state.apply_gate(*PermutationGate::swap(), {a, b});
 }
 
+template void GateEngine::apply_gate(const ComplexVectMatrix &,
+                                     BasicDenseState<float> &, size_t);
+template void GateEngine::controlled_u(BasicDenseState<float> &, size_t, size_t,
+                                       const ComplexVectMatrix &);
+template void GateEngine::controlled_phase(BasicDenseState<float> &, size_t,
+                                           size_t, const DiagonalGate &);
+template void GateEngine::cnot(BasicDenseState<float> &, size_t, size_t);
+template void GateEngine::toffoli(BasicDenseState<float> &, size_t, size_t,
+                                  size_t);
+template void GateEngine::swap(BasicDenseState<float> &, size_t, size_t);
+
+template void GateEngine::apply_gate(const ComplexVectMatrix &,
+                                     BasicDenseState<double> &, size_t);
+template void GateEngine::controlled_u(BasicDenseState<double> &, size_t,
+                                       size_t, const ComplexVectMatrix &);
+template void GateEngine::controlled_phase(BasicDenseState<double> &, size_t,
+                                           size_t, const DiagonalGate &);
+template void GateEngine::cnot(BasicDenseState<double> &, size_t, size_t);
+template void GateEngine::toffoli(BasicDenseState<double> &, size_t, size_t,
+                                  size_t);
+template void GateEngine::swap(BasicDenseState<double> &, size_t, size_t);
+
 std::unique_ptr<Qubit> GateEngine::hadamard(const Qubit &qubit) {
   auto result = AlgebraEngine::matrix_vector_product(
       *ComplexVectMatrix::hadamard_2x2(), *qubit.to_vector());
@@ -113,3 +171,9 @@ std::unique_ptr<ComplexVectMatrix> GateEngine::r_k(const int k, bool inverse) {
   return std::make_unique<ComplexVectMatrix>(
       ComplexMatrix({{1, 0}, {0, Complex(rotation_real, rotation_imag)}}));
 }
+
+std::unique_ptr<DiagonalGate> GateEngine::r_k_diagonal(const int k,
+                                                       bool inverse) {
+  auto r = r_k(k, inverse);
+  return std::make_unique<DiagonalGate>(*r);
+}
@@ -15,7 +15,10 @@
 #ifndef GATE_ENGINE_H
 #define GATE_ENGINE_H
 
+#include "dense_state.h"
+#include "diagonal_gate.h"
 #include "lazy_operation.h"
+#include "permutation_gate.h"
 #include "qubit.h"
 #include <memory>
 
@@ -26,14 +29,54 @@ public:
   static std::unique_ptr<LazyOperation>
   apply_gate(const ComplexVectMatrix &gate, const ComplexVectMatrix &state);
 
+  /*
+   * Applies the 2x2 `gate` to qubit `target` of `state`, in place.
+   */
+  template <typename T>
+  static void apply_gate(const ComplexVectMatrix &gate,
+                         BasicDenseState<T> &state, size_t target);
+
   static std::unique_ptr<Qubit> controlled_u(const Qubit &target,
                                              const Qubit &control,
                                              const ComplexVectMatrix &u);
 
+  /*
+   * Applies `u` to qubit `target` of `state`, in place, where all the qubits
+   * in the `controls` bitmask are set.
+   */
+  template <typename T>
+  static void controlled_u(BasicDenseState<T> &state, size_t target,
+                           size_t controls, const ComplexVectMatrix &u);
+
+  /*
+   * Applies the diagonal gate `phase` to qubit `target` of `state`, where all
+   * the qubits in `controls` are set. A phase diag(1, e^(i phi)) only touches
+   * the amplitudes with the target and every control set.
+   */
+  template <typename T>
+  static void controlled_phase(BasicDenseState<T> &state, size_t target,
+                               size_t controls, const DiagonalGate &phase);
+
+  /*
+   * Classical reversible gates on a dense state, applied as data movement.
+   */
+  template <typename T>
+  static void cnot(BasicDenseState<T> &state, size_t control, size_t target);
+
+  template <typename T>
+  static void toffoli(BasicDenseState<T> &state, size_t control_a,
+                      size_t control_b, size_t target);
+
+  template <typename T>
+  static void swap(BasicDenseState<T> &state, size_t a, size_t b);
+
   static std::unique_ptr<Qubit> hadamard(const Qubit &qubit);
 
   static std::unique_ptr<ComplexVectMatrix> r_k(const int k,
                                                 bool inverse = false);
+
+  static std::unique_ptr<DiagonalGate> r_k_diagonal(const int k,
+                                                    bool inverse = false);
 };
 
 #endif // !GATE_ENGINE_H
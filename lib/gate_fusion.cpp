@@ -0,0 +1,145 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "gate_fusion.h"
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace.h"
+#include "unitary_gate.h"
+#include <algorithm>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+size_t FusionStats::bytes_saved(const size_t num_qubits,
+                                const size_t part_bytes) const {
+  const size_t sweep_bytes = 2 * 2 * part_bytes * (size_t(1) << num_qubits);
+  return (gates_in - gates_out) * sweep_bytes;
+}
+
+GateFusion::GateFusion(const size_t max_qubits) : max_qubits_(max_qubits) {
+  if (max_qubits == 0) {
+    throw std::invalid_argument("Fused gates need at least one qubit");
+  }
+}
+
+/*
+ * @return `gate` over `qubits`, a superset of its own qubits in any order,
+ * acting as the identity on the added ones, as `UnitaryGate::expand`.
+ */
+std::vector<std::complex<double>> expand(const DenseGate &gate,
+                                         const std::vector<size_t> &qubits) {
+  std::vector<size_t> positions;
+  size_t own_bits = 0;
+  for (auto q : gate.qubits) {
+    const auto it = std::find(qubits.begin(), qubits.end(), q);
+    positions.push_back(static_cast<size_t>(it - qubits.begin()));
+    own_bits |= size_t(1) << positions.back();
+  }
+  const auto local = [&positions](const size_t index) {
+    size_t l = 0;
+    for (size_t q = 0; q < positions.size(); q++) {
+      l |= ((index >> positions[q]) & 1) << q;
+    }
+    return l;
+  };
+
+  const auto own_dim = size_t(1) << gate.qubits.size();
+  const auto dim = size_t(1) << qubits.size();
+  std::vector<std::complex<double>> m(dim * dim);
+  for (size_t r = 0; r < dim; r++) {
+    for (size_t c = 0; c < dim; c++) {
+      if ((r & ~own_bits) == (c & ~own_bits)) {
+        m[r * dim + c] = gate.elements[local(r) * own_dim + local(c)];
+      }
+    }
+  }
+  return m;
+}
+
+std::vector<DenseGate> GateFusion::fuse(const std::vector<DenseGate> &gates) {
+  std::vector<DenseGate> fused;
+  std::optional<DenseGate> current;
+  for (const auto &gate : gates) {
+    if (!current.has_value()) {
+      current.emplace(gate);
+      continue;
+    }
+
+    auto qubits = current->qubits;
+    bool shares_qubit = false;
+    for (auto q : gate.qubits) {
+      if (std::find(qubits.begin(), qubits.end(), q) == qubits.end()) {
+        qubits.push_back(q);
+      } else {
+        shares_qubit = true;
+      }
+    }
+    if (!shares_qubit || qubits.size() > max_qubits_) {
+      fused.push_back(std::move(*current));
+      current.emplace(gate);
+      continue;
+    }
+
+    // `gate` comes after `current`, so it multiplies from the left.
+    const auto left = expand(gate, qubits);
+    const auto right = expand(*current, qubits);
+    const auto dim = size_t(1) << qubits.size();
+    std::vector<std::complex<double>> product(dim * dim);
+    for (size_t r = 0; r < dim; r++) {
+      for (size_t k = 0; k < dim; k++) {
+        const auto l = left[r * dim + k];
+        for (size_t c = 0; c < dim; c++) {
+          product[r * dim + c] += l * right[k * dim + c];
+        }
+      }
+    }
+    current.emplace(DenseGate{std::move(qubits), std::move(product)});
+  }
+  if (current.has_value()) {
+    fused.push_back(std::move(*current));
+  }
+
+  stats_.gates_in = gates.size();
+  stats_.gates_out = fused.size();
+  return fused;
+}
+
+std::vector<UnitaryGate>
+GateFusion::fuse(const std::vector<UnitaryGate> &gates) {
+  std::vector<DenseGate> dense;
+  dense.reserve(gates.size());
+  for (const auto &gate : gates) {
+    const auto &m = gate.matrix();
+    DenseGate d{gate.qubits(), {}};
+    d.elements.reserve(m.row_size() * m.column_size());
+    for (size_t r = 0; r < m.row_size(); r++) {
+      for (size_t c = 0; c < m.column_size(); c++) {
+        d.elements.emplace_back(m.get(r, c));
+      }
+    }
+    dense.push_back(std::move(d));
+  }
+
+  std::vector<UnitaryGate> fused;
+  for (const auto &gate : fuse(dense)) {
+    const auto dim = size_t(1) << gate.qubits.size();
+    const ComplexVector m(gate.elements.begin(), gate.elements.end());
+    fused.emplace_back(ComplexVectMatrix(m, dim, dim), gate.qubits);
+  }
+  return fused;
+}
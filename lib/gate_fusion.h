@@ -0,0 +1,85 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GATE_FUSION_H
+#define GATE_FUSION_H
+
+#include "unitary_gate.h"
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+/*
+ * Counters of a fusion pass, for tuning `max_qubits`.
+ */
+struct FusionStats {
+  size_t gates_in = 0;
+  size_t gates_out = 0;
+
+  /*
+   * @return the memory traffic avoided on a dense state of `num_qubits`
+   * qubits, whose real and imaginary parts take `part_bytes` bytes each,
+   * counting a read and a write of every amplitude per removed sweep.
+   */
+  [[nodiscard]] size_t bytes_saved(size_t num_qubits,
+                                   size_t part_bytes) const;
+};
+
+/*
+ * A dense gate over `qubits`, as in `UnitaryGate`, with its 2^k x 2^k
+ * `elements` row-major in double precision, so that the products of a fusion
+ * are not rounded to `__complex_precision`.
+ */
+struct DenseGate {
+  std::vector<size_t> qubits;
+  std::vector<std::complex<double>> elements;
+};
+
+/*
+ * This class merges runs of adjacent gates into dense k-qubit gates, with k at
+ * most `max_qubits`, so that each run is applied in a single pass over the
+ * state instead of one pass per gate. A run only grows by a gate sharing a
+ * qubit with it: gates on disjoint qubits stay apart, as their product would
+ * be a wider dense gate, with more arithmetic per amplitude, for no data
+ * reused between them. Gates wider than `max_qubits` are kept as they are.
+ */
+class GateFusion final {
+public:
+  explicit GateFusion(size_t max_qubits = 4);
+
+  /*
+   * Fuses `gates`, multiplying them in double precision.
+   */
+  [[nodiscard]] std::vector<DenseGate>
+  fuse(const std::vector<DenseGate> &gates);
+
+  /*
+   * Fuses `gates` as `DenseGate`s, and rounds the products back.
+   */
+  [[nodiscard]] std::vector<UnitaryGate>
+  fuse(const std::vector<UnitaryGate> &gates);
+
+  /*
+   * @return the statistics of the last `fuse`.
+   */
+  [[nodiscard]] const FusionStats &stats() const { return stats_; }
+
+  [[nodiscard]] size_t max_qubits() const { return max_qubits_; }
+
+private:
+  size_t max_qubits_;
+  FusionStats stats_;
+};
+
+#endif // !GATE_FUSION_H
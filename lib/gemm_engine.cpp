@@ -0,0 +1,659 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "gemm_engine.h"
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace.h"
+#include "parallel.h"
+#include "scratch_arena.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+#ifndef __APPLE__
+#include "simd_backend.h"
+#include <immintrin.h>
+#endif
+
+constexpr size_t gemm_rows = GemmEngine::micro_rows;
+constexpr size_t gemm_columns = GemmEngine::micro_columns;
+constexpr size_t gemv_vectors = GemmEngine::micro_vectors;
+
+// Below this many rows times columns, a GEMV runs on the calling thread.
+constexpr size_t gemv_parallel_min_elements = size_t(1) << 14;
+
+/*
+ * The planes of a packed panel: the real parts, the imaginary parts and, for
+ * `GemmMethod::ThreeM` only, their sums.
+ *
+ * A left-hand panel holds `gemm_rows` rows, column after column, and a
+ * right-hand one `gemm_columns` columns, row after row, so that the
+ * micro-kernel reads both sequentially. Rows and columns past the edges of
+ * the operands are packed as zeros.
+ */
+struct GemmPanel {
+  __complex_precision *real;
+  __complex_precision *imag;
+  __complex_precision *sum;
+
+  [[nodiscard]] GemmPanel offset(const size_t elements) const {
+    return {real + elements, imag + elements,
+            sum == nullptr ? nullptr : sum + elements};
+  }
+};
+
+/*
+ * @return a panel of `count` elements per plane from the calling thread's
+ * `ScratchArena`.
+ */
+GemmPanel gemm_allocate(const size_t count, const GemmMethod method) {
+  auto &arena = ScratchArena::local();
+  auto *real = arena.allocate(count);
+  auto *imag = arena.allocate(count);
+  auto *sum = method == GemmMethod::ThreeM ? arena.allocate(count) : nullptr;
+  return {real, imag, sum};
+}
+
+/*
+ * Packs rows [first, first + rows) of `left`, over the slice of columns
+ * [depth_first, depth_first + depth), into panels of `gemm_rows` rows.
+ */
+void gemm_pack_left(const ComplexVectMatrix &left, const size_t first,
+                    const size_t rows, const size_t depth_first,
+                    const size_t depth, const GemmPanel &packed) {
+  const auto panels = (rows + gemm_rows - 1) / gemm_rows;
+  for (size_t p = 0; p < panels; p++) {
+    for (size_t l = 0; l < gemm_rows; l++) {
+      const auto m = p * gemm_rows + l;
+      const auto row = (first + std::min(m, rows - 1)) * left.stride();
+      const auto *real = left.real_data() + row + depth_first;
+      const auto *imag = left.imag_data() + row + depth_first;
+      for (size_t k = 0; k < depth; k++) {
+        const auto o = (p * depth + k) * gemm_rows + l;
+        packed.real[o] = m < rows ? real[k] : 0;
+        packed.imag[o] = m < rows ? imag[k] : 0;
+        if (packed.sum != nullptr) {
+          packed.sum[o] = packed.real[o] + packed.imag[o];
+        }
+      }
+    }
+  }
+}
+
+/*
+ * Packs the strips [first_strip, last_strip) of `gemm_columns` columns from
+ * column `column_first` of `right`, over the slice of rows
+ * [depth_first, depth_first + depth).
+ */
+void gemm_pack_right(const ComplexVectMatrix &right, const size_t column_first,
+                     const size_t first_strip, const size_t last_strip,
+                     const size_t depth_first, const size_t depth,
+                     const GemmPanel &packed) {
+  const auto columns = right.column_size();
+  for (size_t s = first_strip; s < last_strip; s++) {
+    for (size_t k = 0; k < depth; k++) {
+      const auto row = (depth_first + k) * right.stride();
+      for (size_t l = 0; l < gemm_columns; l++) {
+        const auto n = column_first + s * gemm_columns + l;
+        const auto o = (s * depth + k) * gemm_columns + l;
+        packed.real[o] = n < columns ? right.real_data()[row + n] : 0;
+        packed.imag[o] = n < columns ? right.imag_data()[row + n] : 0;
+        if (packed.sum != nullptr) {
+          packed.sum[o] = packed.real[o] + packed.imag[o];
+        }
+      }
+    }
+  }
+}
+
+/*
+ * A micro-kernel: the `gemm_rows` x `gemm_columns` block of the result at
+ * `c_real`/`c_imag`, with rows `c_stride` apart, is incremented by the
+ * product of a left-hand and a right-hand panel over `depth` terms.
+ */
+using GemmKernel = void (*)(size_t depth, const GemmPanel &a,
+                            const GemmPanel &b, __complex_precision *c_real,
+                            __complex_precision *c_imag, size_t c_stride);
+
+void gemm_micro_scalar(const size_t depth, const GemmPanel &a,
+                       const GemmPanel &b, __complex_precision *c_real,
+                       __complex_precision *c_imag, const size_t c_stride) {
+  std::array<__complex_precision, gemm_rows * gemm_columns> acc_real{};
+  std::array<__complex_precision, gemm_rows * gemm_columns> acc_imag{};
+  for (size_t k = 0; k < depth; k++) {
+    const auto *b_real = b.real + k * gemm_columns;
+    const auto *b_imag = b.imag + k * gemm_columns;
+    for (size_t r = 0; r < gemm_rows; r++) {
+      const auto a_real = a.real[k * gemm_rows + r];
+      const auto a_imag = a.imag[k * gemm_rows + r];
+      for (size_t l = 0; l < gemm_columns; l++) {
+        const auto i = r * gemm_columns + l;
+        acc_real[i] += a_real * b_real[l] - a_imag * b_imag[l];
+        acc_imag[i] += a_real * b_imag[l] + a_imag * b_real[l];
+      }
+    }
+  }
+  for (size_t r = 0; r < gemm_rows; r++) {
+    for (size_t l = 0; l < gemm_columns; l++) {
+      c_real[r * c_stride + l] += acc_real[r * gemm_columns + l];
+      c_imag[r * c_stride + l] += acc_imag[r * gemm_columns + l];
+    }
+  }
+}
+
+/*
+ * `gemm_micro_scalar` with three real products per complex one.
+ */
+void gemm_micro_3m_scalar(const size_t depth, const GemmPanel &a,
+                          const GemmPanel &b, __complex_precision *c_real,
+                          __complex_precision *c_imag, const size_t c_stride) {
+  std::array<__complex_precision, gemm_rows * gemm_columns> real_real{};
+  std::array<__complex_precision, gemm_rows * gemm_columns> imag_imag{};
+  std::array<__complex_precision, gemm_rows * gemm_columns> sum_sum{};
+  for (size_t k = 0; k < depth; k++) {
+    const auto *b_real = b.real + k * gemm_columns;
+    const auto *b_imag = b.imag + k * gemm_columns;
+    const auto *b_sum = b.sum + k * gemm_columns;
+    for (size_t r = 0; r < gemm_rows; r++) {
+      const auto a_real = a.real[k * gemm_rows + r];
+      const auto a_imag = a.imag[k * gemm_rows + r];
+      const auto a_sum = a.sum[k * gemm_rows + r];
+      for (size_t l = 0; l < gemm_columns; l++) {
+        real_real[r * gemm_columns + l] += a_real * b_real[l];
+        imag_imag[r * gemm_columns + l] += a_imag * b_imag[l];
+        sum_sum[r * gemm_columns + l] += a_sum * b_sum[l];
+      }
+    }
+  }
+  for (size_t r = 0; r < gemm_rows; r++) {
+    for (size_t l = 0; l < gemm_columns; l++) {
+      const auto i = r * gemm_columns + l;
+      c_real[r * c_stride + l] += real_real[i] - imag_imag[i];
+      c_imag[r * c_stride + l] += sum_sum[i] - real_real[i] - imag_imag[i];
+    }
+  }
+}
+
+/*
+ * A GEMV micro-kernel: the products of a row of `length` elements, a
+ * multiple of `gemm_columns`, by `gemv_vectors` vectors with rows `v_stride`
+ * elements apart, into `products`.
+ */
+using GemvKernel = void (*)(const __complex_precision *row_real,
+                            const __complex_precision *row_imag,
+                            size_t length, const __complex_precision *v_real,
+                            const __complex_precision *v_imag,
+                            size_t v_stride, Complex *products);
+
+void gemv_micro_scalar(const __complex_precision *row_real,
+                       const __complex_precision *row_imag,
+                       const size_t length,
+                       const __complex_precision *v_real,
+                       const __complex_precision *v_imag,
+                       const size_t v_stride, Complex *products) {
+  std::array<__complex_precision, gemv_vectors> acc_real{};
+  std::array<__complex_precision, gemv_vectors> acc_imag{};
+  for (size_t j = 0; j < length; j++) {
+    for (size_t r = 0; r < gemv_vectors; r++) {
+      const auto x_real = v_real[r * v_stride + j];
+      const auto x_imag = v_imag[r * v_stride + j];
+      acc_real[r] += row_real[j] * x_real - row_imag[j] * x_imag;
+      acc_imag[r] += row_real[j] * x_imag + row_imag[j] * x_real;
+    }
+  }
+  for (size_t r = 0; r < gemv_vectors; r++) {
+    products[r] = Complex(acc_real[r], acc_imag[r]);
+  }
+}
+
+/*
+ * A GEMV micro-kernel for a single vector: the product of a row of `length`
+ * elements, a multiple of `gemm_columns`, by the vector at `v_real`/`v_imag`.
+ */
+using GemvSingleKernel = Complex (*)(const __complex_precision *row_real,
+                                     const __complex_precision *row_imag,
+                                     size_t length,
+                                     const __complex_precision *v_real,
+                                     const __complex_precision *v_imag);
+
+Complex gemv_single_scalar(const __complex_precision *row_real,
+                           const __complex_precision *row_imag,
+                           const size_t length,
+                           const __complex_precision *v_real,
+                           const __complex_precision *v_imag) {
+  __complex_precision acc_real = 0;
+  __complex_precision acc_imag = 0;
+  for (size_t j = 0; j < length; j++) {
+    acc_real += row_real[j] * v_real[j] - row_imag[j] * v_imag[j];
+    acc_imag += row_real[j] * v_imag[j] + row_imag[j] * v_real[j];
+  }
+  return Complex(acc_real, acc_imag);
+}
+
+#ifndef __APPLE__
+// The micro-kernels below are compiled for AVX2 and FMA, whatever the flags of
+// the library, and only run when the CPU supports them (see `simd::isa`).
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), \
+                             apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+// The AVX2 micro-kernels keep each accumulator in a named register, as
+// arrays of them are spilled to the stack on every term.
+static_assert(gemm_rows == 4 && gemm_columns == 8);
+
+/*
+ * One term of a row of `gemm_micro_avx`: the broadcast element of the
+ * left-hand panel at `a_real`/`a_imag` times a register of the right-hand
+ * one.
+ */
+inline void gemm_term_avx(const __complex_precision *a_real,
+                          const __complex_precision *a_imag,
+                          const __m256 b_real, const __m256 b_imag,
+                          __m256 &acc_real, __m256 &acc_imag) {
+  const __m256 x_real = _mm256_broadcast_ss(a_real);
+  const __m256 x_imag = _mm256_broadcast_ss(a_imag);
+  acc_real = _mm256_fmadd_ps(x_real, b_real, acc_real);
+  acc_real = _mm256_fnmadd_ps(x_imag, b_imag, acc_real);
+  acc_imag = _mm256_fmadd_ps(x_real, b_imag, acc_imag);
+  acc_imag = _mm256_fmadd_ps(x_imag, b_real, acc_imag);
+}
+
+/*
+ * Adds the accumulators of a row to the result at `c_real`/`c_imag`.
+ */
+inline void gemm_store_avx(__complex_precision *c_real,
+                           __complex_precision *c_imag, const __m256 acc_real,
+                           const __m256 acc_imag) {
+  _mm256_store_ps(c_real, _mm256_add_ps(_mm256_load_ps(c_real), acc_real));
+  _mm256_store_ps(c_imag, _mm256_add_ps(_mm256_load_ps(c_imag), acc_imag));
+}
+
+/*
+ * `gemm_micro_scalar` with a register of each of the real and imaginary
+ * parts of every row of the block, 8 accumulators in all.
+ */
+void gemm_micro_avx(const size_t depth, const GemmPanel &a, const GemmPanel &b,
+                    __complex_precision *c_real, __complex_precision *c_imag,
+                    const size_t c_stride) {
+  __m256 real0 = _mm256_setzero_ps(), imag0 = _mm256_setzero_ps();
+  __m256 real1 = _mm256_setzero_ps(), imag1 = _mm256_setzero_ps();
+  __m256 real2 = _mm256_setzero_ps(), imag2 = _mm256_setzero_ps();
+  __m256 real3 = _mm256_setzero_ps(), imag3 = _mm256_setzero_ps();
+  for (size_t k = 0; k < depth; k++) {
+    const __m256 b_real = _mm256_load_ps(b.real + k * gemm_columns);
+    const __m256 b_imag = _mm256_load_ps(b.imag + k * gemm_columns);
+    const auto *a_real = a.real + k * gemm_rows;
+    const auto *a_imag = a.imag + k * gemm_rows;
+    gemm_term_avx(a_real, a_imag, b_real, b_imag, real0, imag0);
+    gemm_term_avx(a_real + 1, a_imag + 1, b_real, b_imag, real1, imag1);
+    gemm_term_avx(a_real + 2, a_imag + 2, b_real, b_imag, real2, imag2);
+    gemm_term_avx(a_real + 3, a_imag + 3, b_real, b_imag, real3, imag3);
+  }
+  gemm_store_avx(c_real, c_imag, real0, imag0);
+  gemm_store_avx(c_real + c_stride, c_imag + c_stride, real1, imag1);
+  gemm_store_avx(c_real + 2 * c_stride, c_imag + 2 * c_stride, real2, imag2);
+  gemm_store_avx(c_real + 3 * c_stride, c_imag + 3 * c_stride, real3, imag3);
+}
+
+/*
+ * One term of a row of `gemm_micro_3m_avx`, into the accumulators of its
+ * three real products.
+ */
+inline void gemm_term_3m_avx(const GemmPanel &a, const size_t o,
+                             const __m256 b_real, const __m256 b_imag,
+                             const __m256 b_sum, __m256 &real_real,
+                             __m256 &imag_imag, __m256 &sum_sum) {
+  real_real =
+      _mm256_fmadd_ps(_mm256_broadcast_ss(a.real + o), b_real, real_real);
+  imag_imag =
+      _mm256_fmadd_ps(_mm256_broadcast_ss(a.imag + o), b_imag, imag_imag);
+  sum_sum = _mm256_fmadd_ps(_mm256_broadcast_ss(a.sum + o), b_sum, sum_sum);
+}
+
+/*
+ * Adds the three real products of a row to the result at `c_real`/`c_imag`.
+ */
+inline void gemm_store_3m_avx(__complex_precision *c_real,
+                              __complex_precision *c_imag,
+                              const __m256 real_real, const __m256 imag_imag,
+                              const __m256 sum_sum) {
+  gemm_store_avx(
+      c_real, c_imag, _mm256_sub_ps(real_real, imag_imag),
+      _mm256_sub_ps(sum_sum, _mm256_add_ps(real_real, imag_imag)));
+}
+
+/*
+ * `gemm_micro_3m_scalar` with a register of each of the three real products
+ * of every row of the block, 12 accumulators in all.
+ */
+void gemm_micro_3m_avx(const size_t depth, const GemmPanel &a,
+                       const GemmPanel &b, __complex_precision *c_real,
+                       __complex_precision *c_imag, const size_t c_stride) {
+  __m256 rr0 = _mm256_setzero_ps(), ii0 = _mm256_setzero_ps(),
+         ss0 = _mm256_setzero_ps();
+  __m256 rr1 = _mm256_setzero_ps(), ii1 = _mm256_setzero_ps(),
+         ss1 = _mm256_setzero_ps();
+  __m256 rr2 = _mm256_setzero_ps(), ii2 = _mm256_setzero_ps(),
+         ss2 = _mm256_setzero_ps();
+  __m256 rr3 = _mm256_setzero_ps(), ii3 = _mm256_setzero_ps(),
+         ss3 = _mm256_setzero_ps();
+  for (size_t k = 0; k < depth; k++) {
+    const __m256 b_real = _mm256_load_ps(b.real + k * gemm_columns);
+    const __m256 b_imag = _mm256_load_ps(b.imag + k * gemm_columns);
+    const __m256 b_sum = _mm256_load_ps(b.sum + k * gemm_columns);
+    const auto o = k * gemm_rows;
+    gemm_term_3m_avx(a, o, b_real, b_imag, b_sum, rr0, ii0, ss0);
+    gemm_term_3m_avx(a, o + 1, b_real, b_imag, b_sum, rr1, ii1, ss1);
+    gemm_term_3m_avx(a, o + 2, b_real, b_imag, b_sum, rr2, ii2, ss2);
+    gemm_term_3m_avx(a, o + 3, b_real, b_imag, b_sum, rr3, ii3, ss3);
+  }
+  gemm_store_3m_avx(c_real, c_imag, rr0, ii0, ss0);
+  gemm_store_3m_avx(c_real + c_stride, c_imag + c_stride, rr1, ii1, ss1);
+  gemm_store_3m_avx(c_real + 2 * c_stride, c_imag + 2 * c_stride, rr2, ii2,
+                    ss2);
+  gemm_store_3m_avx(c_real + 3 * c_stride, c_imag + 3 * c_stride, rr3, ii3,
+                    ss3);
+}
+
+/*
+ * One register of a row of `gemv_micro_avx` times the vector at
+ * `v_real`/`v_imag`.
+ */
+inline void gemv_term_avx(const __m256 m_real, const __m256 m_imag,
+                          const __complex_precision *v_real,
+                          const __complex_precision *v_imag, __m256 &acc_real,
+                          __m256 &acc_imag) {
+  const __m256 x_real = _mm256_load_ps(v_real);
+  const __m256 x_imag = _mm256_load_ps(v_imag);
+  acc_real = _mm256_fmadd_ps(m_real, x_real, acc_real);
+  acc_real = _mm256_fnmadd_ps(m_imag, x_imag, acc_real);
+  acc_imag = _mm256_fmadd_ps(m_real, x_imag, acc_imag);
+  acc_imag = _mm256_fmadd_ps(m_imag, x_real, acc_imag);
+}
+
+/*
+ * @return the sum of the lanes of `v`.
+ */
+inline __complex_precision gemv_sum_avx(const __m256 v) {
+  __m128 x =
+      _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+  x = _mm_add_ss(x, _mm_movehdup_ps(x));
+  return _mm_cvtss_f32(x);
+}
+
+/*
+ * `gemv_micro_scalar` with a register of each of the real and imaginary
+ * parts of every product, 8 accumulators in all, summed across lanes at the
+ * end. Each register of the row is loaded once for the four vectors.
+ */
+void gemv_micro_avx(const __complex_precision *row_real,
+                    const __complex_precision *row_imag, const size_t length,
+                    const __complex_precision *v_real,
+                    const __complex_precision *v_imag, const size_t v_stride,
+                    Complex *products) {
+  static_assert(gemv_vectors == 4);
+  __m256 real0 = _mm256_setzero_ps(), imag0 = _mm256_setzero_ps();
+  __m256 real1 = _mm256_setzero_ps(), imag1 = _mm256_setzero_ps();
+  __m256 real2 = _mm256_setzero_ps(), imag2 = _mm256_setzero_ps();
+  __m256 real3 = _mm256_setzero_ps(), imag3 = _mm256_setzero_ps();
+  for (size_t j = 0; j < length; j += gemm_columns) {
+    const __m256 m_real = _mm256_load_ps(row_real + j);
+    const __m256 m_imag = _mm256_load_ps(row_imag + j);
+    gemv_term_avx(m_real, m_imag, v_real + j, v_imag + j, real0, imag0);
+    gemv_term_avx(m_real, m_imag, v_real + v_stride + j,
+                  v_imag + v_stride + j, real1, imag1);
+    gemv_term_avx(m_real, m_imag, v_real + 2 * v_stride + j,
+                  v_imag + 2 * v_stride + j, real2, imag2);
+    gemv_term_avx(m_real, m_imag, v_real + 3 * v_stride + j,
+                  v_imag + 3 * v_stride + j, real3, imag3);
+  }
+  products[0] = Complex(gemv_sum_avx(real0), gemv_sum_avx(imag0));
+  products[1] = Complex(gemv_sum_avx(real1), gemv_sum_avx(imag1));
+  products[2] = Complex(gemv_sum_avx(real2), gemv_sum_avx(imag2));
+  products[3] = Complex(gemv_sum_avx(real3), gemv_sum_avx(imag3));
+}
+
+/*
+ * `gemv_single_scalar` with two pairs of accumulators, taking the registers
+ * of the row in turn, so that each FMA does not wait on the one before.
+ */
+Complex gemv_single_avx(const __complex_precision *row_real,
+                        const __complex_precision *row_imag,
+                        const size_t length, const __complex_precision *v_real,
+                        const __complex_precision *v_imag) {
+  __m256 real0 = _mm256_setzero_ps(), imag0 = _mm256_setzero_ps();
+  __m256 real1 = _mm256_setzero_ps(), imag1 = _mm256_setzero_ps();
+  size_t j = 0;
+  for (; j + 2 * gemm_columns <= length; j += 2 * gemm_columns) {
+    gemv_term_avx(_mm256_load_ps(row_real + j), _mm256_load_ps(row_imag + j),
+                  v_real + j, v_imag + j, real0, imag0);
+    gemv_term_avx(_mm256_load_ps(row_real + j + gemm_columns),
+                  _mm256_load_ps(row_imag + j + gemm_columns),
+                  v_real + j + gemm_columns, v_imag + j + gemm_columns, real1,
+                  imag1);
+  }
+  if (j < length) {
+    gemv_term_avx(_mm256_load_ps(row_real + j), _mm256_load_ps(row_imag + j),
+                  v_real + j, v_imag + j, real0, imag0);
+  }
+  return Complex(gemv_sum_avx(_mm256_add_ps(real0, real1)),
+                 gemv_sum_avx(_mm256_add_ps(imag0, imag1)));
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+#endif
+
+GemmKernel gemm_kernel(const GemmMethod method) {
+  const auto three_m = method == GemmMethod::ThreeM;
+#ifndef __APPLE__
+  if (simd::isa() >= Isa::Avx2) {
+    return three_m ? gemm_micro_3m_avx : gemm_micro_avx;
+  }
+#endif
+  return three_m ? gemm_micro_3m_scalar : gemm_micro_scalar;
+}
+
+GemvKernel gemv_kernel() {
+#ifndef __APPLE__
+  if (simd::isa() >= Isa::Avx2) {
+    return gemv_micro_avx;
+  }
+#endif
+  return gemv_micro_scalar;
+}
+
+GemvSingleKernel gemv_single_kernel() {
+#ifndef __APPLE__
+  if (simd::isa() >= Isa::Avx2) {
+    return gemv_single_avx;
+  }
+#endif
+  return gemv_single_scalar;
+}
+
+/*
+ * Multiplies the packed block of `rows` rows from row `first` by the packed
+ * strips [first_strip, last_strip) from column `column_first`, into
+ * `result`. Each strip stays in L1 while it meets every panel of the block.
+ * The blocks of the result that cross its edges go through a buffer, so
+ * that its padding is left untouched.
+ */
+void gemm_macro(const GemmKernel kernel, const size_t depth,
+                const GemmPanel &a, const size_t first, const size_t rows,
+                const GemmPanel &b, const size_t column_first,
+                const size_t first_strip, const size_t last_strip,
+                ComplexVectMatrix &result) {
+  const auto stride = result.stride();
+  const auto columns = result.column_size();
+  for (size_t s = first_strip; s < last_strip; s++) {
+    const auto strip = b.offset(s * depth * gemm_columns);
+    const auto n = column_first + s * gemm_columns;
+    const auto strip_columns = std::min(gemm_columns, columns - n);
+    for (size_t p = 0; p * gemm_rows < rows; p++) {
+      const auto panel = a.offset(p * depth * gemm_rows);
+      const auto m = first + p * gemm_rows;
+      const auto panel_rows = std::min(gemm_rows, rows - p * gemm_rows);
+      auto *c_real = result.real_data() + m * stride + n;
+      auto *c_imag = result.imag_data() + m * stride + n;
+      if (panel_rows == gemm_rows && strip_columns == gemm_columns) {
+        kernel(depth, panel, strip, c_real, c_imag, stride);
+        continue;
+      }
+      alignas(64) std::array<__complex_precision, gemm_rows * gemm_columns>
+          edge_real{};
+      alignas(64) std::array<__complex_precision, gemm_rows * gemm_columns>
+          edge_imag{};
+      kernel(depth, panel, strip, edge_real.data(), edge_imag.data(),
+             gemm_columns);
+      for (size_t r = 0; r < panel_rows; r++) {
+        for (size_t l = 0; l < strip_columns; l++) {
+          c_real[r * stride + l] += edge_real[r * gemm_columns + l];
+          c_imag[r * stride + l] += edge_imag[r * gemm_columns + l];
+        }
+      }
+    }
+  }
+}
+
+std::unique_ptr<ComplexVectMatrix>
+GemmEngine::multiply(const ComplexVectMatrix &left,
+                     const ComplexVectMatrix &right, const GemmMethod method) {
+  if (left.column_size() != right.row_size()) {
+    throw std::invalid_argument("Matrix sizes do not match");
+  }
+  const auto rows = left.row_size();
+  const auto columns = right.column_size();
+  const auto depth = left.column_size();
+  auto result = std::make_unique<ComplexVectMatrix>(rows, columns);
+  if (rows == 0 || columns == 0 || depth == 0) {
+    return result;
+  }
+
+  const auto kernel = gemm_kernel(method);
+  const auto num_threads = ThreadPool::instance().num_workers() + 1;
+  const auto row_blocks = (rows + block_rows - 1) / block_rows;
+
+  ScratchArena::Scope scope;
+  const auto panel_columns = std::min(block_columns, columns);
+  const auto b = gemm_allocate(
+      (panel_columns + micro_columns - 1) / micro_columns * micro_columns *
+          std::min(block_depth, depth),
+      method);
+
+  for (size_t n = 0; n < columns; n += block_columns) {
+    const auto strips =
+        (std::min(block_columns, columns - n) + micro_columns - 1) /
+        micro_columns;
+
+    // With fewer row blocks than threads, the strips are split into groups
+    // as well, each task packing its block of rows again.
+    const auto groups = std::min(
+        strips, std::max<size_t>(1, (num_threads + row_blocks - 1) /
+                                        row_blocks));
+    const auto group_strips = (strips + groups - 1) / groups;
+    const auto tiles = row_blocks * ((strips + group_strips - 1) /
+                                     group_strips);
+
+    for (size_t k = 0; k < depth; k += block_depth) {
+      const auto slice = std::min(block_depth, depth - k);
+      parallel_for(strips, [&](size_t start, size_t end) {
+        gemm_pack_right(right, n, start, end, k, slice, b);
+      });
+
+      parallel_for(tiles, [&](size_t start, size_t end) {
+        ScratchArena::Scope task_scope;
+        const auto a = gemm_allocate(block_rows * slice, method);
+        const auto tiles_per_block = tiles / row_blocks;
+        size_t packed_block = row_blocks;
+        for (size_t t = start; t < end; t++) {
+          const auto block = t / tiles_per_block;
+          const auto first = block * block_rows;
+          const auto block_height = std::min(block_rows, rows - first);
+          if (block != packed_block) {
+            gemm_pack_left(left, first, block_height, k, slice, a);
+            packed_block = block;
+          }
+          const auto first_strip = (t % tiles_per_block) * group_strips;
+          const auto last_strip = std::min(strips, first_strip + group_strips);
+          gemm_macro(kernel, slice, a, first, block_height, b, n, first_strip,
+                     last_strip, *result);
+        }
+      });
+    }
+  }
+  return result;
+}
+
+std::unique_ptr<ComplexVectMatrix>
+GemmEngine::multiply_vectors(const ComplexVectMatrix &mat,
+                             const ComplexVectMatrix &vects) {
+  if (mat.column_size() != vects.column_size()) {
+    throw std::invalid_argument("Matrix and vector sizes do not match");
+  }
+  const auto rows = mat.row_size();
+  const auto count = vects.row_size();
+  auto result = std::make_unique<ComplexVectMatrix>(count, rows);
+  if (rows == 0 || count == 0) {
+    return result;
+  }
+
+  const auto kernel = gemv_kernel();
+  const auto single = gemv_single_kernel();
+  // Both have as many columns, hence the same padded rows.
+  const auto length = mat.stride();
+  const auto store = [&result](const size_t r, const size_t m,
+                               const Complex &c) {
+    result->real_data()[r * result->stride() + m] = c.real();
+    result->imag_data()[r * result->stride() + m] = c.imag();
+  };
+  parallel_for(
+      rows,
+      [&](size_t start, size_t end) {
+        std::array<Complex, micro_vectors> products;
+        for (size_t m = start; m < end; m++) {
+          const auto *row_real = mat.real_data() + m * length;
+          const auto *row_imag = mat.imag_data() + m * length;
+          size_t r = 0;
+          for (; r + micro_vectors <= count; r += micro_vectors) {
+            kernel(row_real, row_imag, length, vects.real_data() + r * length,
+                   vects.imag_data() + r * length, length, products.data());
+            for (size_t v = 0; v < micro_vectors; v++) {
+              store(r + v, m, products[v]);
+            }
+          }
+          for (; r < count; r++) {
+            store(r, m,
+                  single(row_real, row_imag, length,
+                         vects.real_data() + r * length,
+                         vects.imag_data() + r * length));
+          }
+        }
+      },
+      std::max<size_t>(1, gemv_parallel_min_elements / length));
+  return result;
+}
@@ -0,0 +1,90 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef GEMM_ENGINE_H
+#define GEMM_ENGINE_H
+
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace.h"
+#include <cstddef>
+#include <memory>
+
+/*
+ * How `GemmEngine` forms the complex products. `Standard` takes four real
+ * multiplications per complex one. `ThreeM` takes three, as
+ * (a + bi)(c + di) = (ac - bd) + i((a + b)(c + d) - ac - bd), trading a
+ * quarter of the arithmetic for a larger rounding error in the imaginary
+ * parts, which are then the difference of larger terms.
+ */
+enum class GemmMethod { Standard, ThreeM };
+
+class GemmEngine {
+public:
+  GemmEngine() = delete;
+
+  // Rows and columns of the block of the result kept in registers by the
+  // micro-kernel; a column strip is one AVX2 register of floats.
+  static constexpr size_t micro_rows = 4;
+  static constexpr size_t micro_columns = 8;
+
+  // Products are accumulated over slices of `block_depth` terms, so that a
+  // strip of the right-hand panel stays in L1 across a whole block of rows.
+  static constexpr size_t block_depth = 256;
+
+  // Rows of the left-hand block packed by each task, so that it stays in L2.
+  static constexpr size_t block_rows = 64;
+
+  // Columns of the right-hand panel packed at once, so that it stays in L3.
+  static constexpr size_t block_columns = 1024;
+
+  // Vectors taken together by the GEMV micro-kernel, so that each register
+  // of a row of the matrix is loaded once for all of them.
+  static constexpr size_t micro_vectors = 4;
+
+  /*
+   * @return the product `left` * `right`.
+   *
+   * Both operands are packed, slice by slice, into panels laid out in the
+   * order the micro-kernel reads them: the right-hand one once per slice,
+   * shared by all the threads, and the left-hand one block by block by each
+   * task. Tasks are tiles of the result, a block of rows by a range of
+   * column strips, on the `ThreadPool`. Without AVX2, the micro-kernel is
+   * portable C++.
+   * @throws std::invalid_argument if the columns of `left` are not as many as
+   * the rows of `right`.
+   */
+  [[nodiscard]] static std::unique_ptr<ComplexVectMatrix>
+  multiply(const ComplexVectMatrix &left, const ComplexVectMatrix &right,
+           GemmMethod method = GemmMethod::Standard);
+
+  /*
+   * @return the products of `mat` by each row of `vects`, as the rows of the
+   * result: a GEMV on `vects.row_size()` right-hand sides, each a 1xN vector
+   * as elsewhere in the library.
+   *
+   * The vectors are read in place, split and padded, and stay in cache while
+   * the rows of `mat` are streamed once, split among the threads of the
+   * `ThreadPool`. Vectors are taken `micro_vectors` at a time by an AVX2/FMA
+   * micro-kernel, and the others, such as the single vector of a
+   * matrix-vector product, one at a time by a micro-kernel of their own.
+   * @throws std::invalid_argument if `mat` and `vects` do not have as many
+   * columns.
+   */
+  [[nodiscard]] static std::unique_ptr<ComplexVectMatrix>
+  multiply_vectors(const ComplexVectMatrix &mat,
+                   const ComplexVectMatrix &vects);
+};
+
+#endif // !GEMM_ENGINE_H
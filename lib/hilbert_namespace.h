@@ -31,4 +31,9 @@ inline bool approx_equal(const Complex &a, const Complex &b) {
   return std::abs(a - b) < tol;
 }
 
+inline bool approx_equal(const std::complex<double> &a,
+                         const std::complex<double> &b) {
+  return std::abs(a - b) < 1e-5;
+}
+
 #endif // !HILBERT_NAMESPACE_H
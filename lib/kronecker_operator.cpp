@@ -0,0 +1,374 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "kronecker_operator.h"
+#include "aligned_allocator.h"
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace.h"
+#include "parallel.h"
+#include "scratch_arena.h"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Below this many elements, a pass over the modes runs on the calling thread.
+constexpr size_t kronecker_parallel_min_elements = size_t(1) << 14;
+
+// Longest run of a mode updated at once, so that it stays in the L1 cache.
+constexpr size_t kronecker_run = 512;
+
+// Largest factor the last ones are merged into, so that no mode is applied
+// in runs shorter than a few SIMD registers.
+constexpr size_t kronecker_merge = 16;
+
+// Largest block of a vector, in elements, over which the last modes are all
+// applied while it stays in the L2 cache.
+constexpr size_t kronecker_block = size_t(1) << 14;
+
+/*
+ * The real and imaginary planes of a tensor, or of part of it.
+ */
+struct KroneckerPlanes {
+  __complex_precision *real;
+  __complex_precision *imag;
+
+  [[nodiscard]] KroneckerPlanes offset(const size_t elements) const {
+    return {real + elements, imag + elements};
+  }
+};
+
+/*
+ * A factor with its elements split into planes, column after column, so
+ * that a column can be added to a run of the result with unit strides.
+ */
+struct KroneckerFactor {
+  size_t rows;
+  size_t columns;
+  std::vector<__complex_precision> real;
+  std::vector<__complex_precision> imag;
+
+  explicit KroneckerFactor(const ComplexVectMatrix &factor)
+      : rows(factor.row_size()), columns(factor.column_size()),
+        real(rows * columns), imag(rows * columns) {
+    for (size_t a = 0; a < rows; a++) {
+      for (size_t b = 0; b < columns; b++) {
+        const auto c = factor.get(a, b);
+        real[b * rows + a] = c.real();
+        imag[b * rows + a] = c.imag();
+      }
+    }
+  }
+};
+
+/*
+ * @return the most elements a tensor of `size` elements grows to while
+ * `factors` are applied to it, from the last to the first as in `apply`.
+ */
+size_t kronecker_max_size(const std::vector<KroneckerFactor> &factors,
+                          size_t size) {
+  auto max_size = size;
+  for (auto factor = factors.rbegin(); factor != factors.rend(); factor++) {
+    size = size / factor->columns * factor->rows;
+    max_size = std::max(max_size, size);
+  }
+  return max_size;
+}
+
+/*
+ * Applies `factor` to the middle mode of `in`, seen as an outer x columns x
+ * inner tensor, writing the outer x rows x inner tensor `out`, for the
+ * positions [start, end) of the outer x inner ones.
+ */
+void kronecker_mode(const KroneckerFactor &factor, const KroneckerPlanes in,
+                    const KroneckerPlanes out, const size_t inner,
+                    const size_t start, const size_t end) {
+  const auto rows = factor.rows;
+  const auto columns = factor.columns;
+  if (inner == 1) {
+    // The mode is contiguous: each position is a small matrix-vector product
+    // of its own, summed column by column.
+    for (size_t o = start; o < end; o++) {
+      auto *dst_real = out.real + o * rows;
+      auto *dst_imag = out.imag + o * rows;
+      std::fill_n(dst_real, rows, __complex_precision(0));
+      std::fill_n(dst_imag, rows, __complex_precision(0));
+      for (size_t b = 0; b < columns; b++) {
+        const auto x_real = in.real[o * columns + b];
+        const auto x_imag = in.imag[o * columns + b];
+        const auto *c_real = factor.real.data() + b * rows;
+        const auto *c_imag = factor.imag.data() + b * rows;
+        for (size_t a = 0; a < rows; a++) {
+          dst_real[a] += c_real[a] * x_real - c_imag[a] * x_imag;
+          dst_imag[a] += c_real[a] * x_imag + c_imag[a] * x_real;
+        }
+      }
+    }
+    return;
+  }
+
+  // Otherwise, runs along the inner index are updated one element of the
+  // factor at a time, with unit strides.
+  for (size_t p = start; p < end;) {
+    const auto o = p / inner;
+    const auto i = p % inner;
+    const auto length = std::min({inner - i, end - p, kronecker_run});
+    const auto src = in.offset(o * columns * inner + i);
+    for (size_t a = 0; a < rows; a++) {
+      const auto dst = out.offset((o * rows + a) * inner + i);
+      std::fill_n(dst.real, length, __complex_precision(0));
+      std::fill_n(dst.imag, length, __complex_precision(0));
+      for (size_t b = 0; b < columns; b++) {
+        const auto c_real = factor.real[b * rows + a];
+        const auto c_imag = factor.imag[b * rows + a];
+        const auto *src_real = src.real + b * inner;
+        const auto *src_imag = src.imag + b * inner;
+        for (size_t t = 0; t < length; t++) {
+          dst.real[t] += c_real * src_real[t] - c_imag * src_imag[t];
+          dst.imag[t] += c_real * src_imag[t] + c_imag * src_real[t];
+        }
+      }
+    }
+    p += length;
+  }
+}
+
+/*
+ * Applies `factors`, the last ones of the operator, to each block of
+ * `blocks` in `in`, so that a block stays in cache across all of them. A
+ * block holds the product of their columns in `in`, and of their rows in
+ * `out`.
+ */
+void kronecker_blocks(const std::vector<KroneckerFactor> &factors,
+                      const KroneckerPlanes in, const KroneckerPlanes out,
+                      const size_t blocks) {
+  size_t block_in = 1;
+  size_t block_out = 1;
+  for (const auto &factor : factors) {
+    block_in *= factor.columns;
+    block_out *= factor.rows;
+  }
+  const auto span = kronecker_max_size(factors, block_in);
+  parallel_for(
+      blocks,
+      [&](size_t start, size_t end) {
+        ScratchArena::Scope scope;
+        auto &arena = ScratchArena::local();
+        const std::array<KroneckerPlanes, 2> scratch = {
+            KroneckerPlanes{arena.allocate(span), arena.allocate(span)},
+            KroneckerPlanes{arena.allocate(span), arena.allocate(span)}};
+        for (size_t k = start; k < end; k++) {
+          auto src = in.offset(k * block_in);
+          auto size = block_in;
+          size_t inner = 1;
+          for (size_t f = factors.size(); f-- > 0;) {
+            const auto &factor = factors[f];
+            const auto dst =
+                f == 0 ? out.offset(k * block_out) : scratch[f % 2];
+            const auto positions = size / factor.columns;
+            kronecker_mode(factor, src, dst, inner, 0, positions);
+            src = dst;
+            size = positions * factor.rows;
+            inner *= factor.rows;
+          }
+        }
+      },
+      std::max<size_t>(1, kronecker_parallel_min_elements / span));
+}
+
+KroneckerOperator::KroneckerOperator(std::vector<ComplexVectMatrix> factors)
+    : factors_(std::move(factors)) {
+  if (factors_.empty()) {
+    throw std::invalid_argument("Kronecker operator needs factors");
+  }
+  for (const auto &factor : factors_) {
+    if (factor.row_size() == 0 || factor.column_size() == 0) {
+      throw std::invalid_argument("Kronecker factors must not be empty");
+    }
+    row_size_ *= factor.row_size();
+    column_size_ *= factor.column_size();
+  }
+}
+
+Complex KroneckerOperator::get(size_t m, size_t n) const {
+  if (m >= row_size_ || n >= column_size_) {
+    throw std::out_of_range("Element is out of range");
+  }
+  Complex result = 1;
+  for (auto factor = factors_.rbegin(); factor != factors_.rend(); factor++) {
+    result *= factor->get(m % factor->row_size(), n % factor->column_size());
+    m /= factor->row_size();
+    n /= factor->column_size();
+  }
+  return result;
+}
+
+std::unique_ptr<ComplexVectMatrix>
+KroneckerOperator::apply(const ComplexVectMatrix &vects) const {
+  if (vects.column_size() != column_size_) {
+    throw std::invalid_argument("Operator and vector sizes do not match");
+  }
+  const auto count = vects.row_size();
+  auto result = std::make_unique<ComplexVectMatrix>(count, row_size_);
+  if (count == 0) {
+    return result;
+  }
+
+  // The last factors, as long as they are small, are merged into one.
+  auto merged = factors_.size();
+  size_t merged_span = 1;
+  while (merged > 0) {
+    const auto &factor = factors_[merged - 1];
+    const auto span = std::max(factor.row_size(), factor.column_size());
+    if (merged_span * span > kronecker_merge) {
+      break;
+    }
+    merged_span *= span;
+    merged--;
+  }
+  merged = std::min(merged, factors_.size() - 1);
+  std::vector<KroneckerFactor> factors(factors_.begin(),
+                                       factors_.begin() + merged);
+  if (merged + 1 == factors_.size()) {
+    factors.emplace_back(factors_.back());
+  } else {
+    const KroneckerOperator last(std::vector<ComplexVectMatrix>(
+        factors_.begin() + merged, factors_.end()));
+    factors.emplace_back(*last.to_matrix());
+  }
+
+  // Every mode changes the size of a vector from columns to rows of its
+  // factor, so the buffers hold the largest of the intermediate tensors.
+  const auto max_size = kronecker_max_size(factors, column_size_);
+  FirstTouchVector<__complex_precision> planes(4 * count * max_size);
+  KroneckerPlanes in = {planes.data(), planes.data() + count * max_size};
+  KroneckerPlanes out = in.offset(2 * count * max_size);
+
+  const auto grain = kronecker_parallel_min_elements;
+  for (size_t r = 0; r < count; r++) {
+    parallel_for(
+        column_size_,
+        [&](size_t start, size_t end) {
+          const auto offset = r * vects.stride();
+          std::copy(vects.real_data() + offset + start,
+                    vects.real_data() + offset + end,
+                    in.real + r * column_size_ + start);
+          std::copy(vects.imag_data() + offset + start,
+                    vects.imag_data() + offset + end,
+                    in.imag + r * column_size_ + start);
+        },
+        grain);
+  }
+
+  // The vectors, one after the other, are a tensor of modes count, then
+  // the factors' columns. Each factor in turn, from the last, replaces its
+  // columns with its rows. The last ones, as long as they fit in a block,
+  // are applied together.
+  auto first = factors.size();
+  size_t span = 1;
+  while (first > 0) {
+    const auto &factor = factors[first - 1];
+    if (span * std::max(factor.rows, factor.columns) > kronecker_block) {
+      break;
+    }
+    span *= std::max(factor.rows, factor.columns);
+    first--;
+  }
+  auto size = column_size_;
+  size_t inner = 1;
+  if (factors.size() - first > 1) {
+    const std::vector<KroneckerFactor> last(factors.begin() + first,
+                                            factors.end());
+    size_t block_in = 1;
+    for (const auto &factor : last) {
+      block_in *= factor.columns;
+      inner *= factor.rows;
+    }
+    kronecker_blocks(last, in, out, count * (size / block_in));
+    std::swap(in, out);
+    size = size / block_in * inner;
+  } else {
+    first = factors.size();
+  }
+  for (auto f = first; f-- > 0;) {
+    const auto &factor = factors[f];
+    const auto positions = count * (size / factor.columns);
+    parallel_for(
+        positions,
+        [&](size_t start, size_t end) {
+          kronecker_mode(factor, in, out, inner, start, end);
+        },
+        std::max<size_t>(1, grain / std::max(factor.rows, factor.columns)));
+    std::swap(in, out);
+    size = size / factor.columns * factor.rows;
+    inner *= factor.rows;
+  }
+
+  for (size_t r = 0; r < count; r++) {
+    parallel_for(
+        row_size_,
+        [&](size_t start, size_t end) {
+          const auto offset = r * result->stride();
+          std::copy(in.real + r * row_size_ + start,
+                    in.real + r * row_size_ + end,
+                    result->real_data() + offset + start);
+          std::copy(in.imag + r * row_size_ + start,
+                    in.imag + r * row_size_ + end,
+                    result->imag_data() + offset + start);
+        },
+        grain);
+  }
+  return result;
+}
+
+std::unique_ptr<ComplexVectMatrix> KroneckerOperator::to_matrix() const {
+  auto result = std::make_unique<ComplexVectMatrix>(row_size_, column_size_);
+  parallel_for(
+      row_size_,
+      [&](size_t start, size_t end) {
+        std::vector<size_t> digits(factors_.size());
+        for (size_t m = start; m < end; m++) {
+          auto rest = m;
+          for (size_t f = factors_.size(); f-- > 0;) {
+            digits[f] = rest % factors_[f].row_size();
+            rest /= factors_[f].row_size();
+          }
+          auto *real = result->real_data() + m * result->stride();
+          auto *imag = result->imag_data() + m * result->stride();
+          real[0] = 1;
+          imag[0] = 0;
+          // The row grows in place, each element being replaced by its
+          // products with the row of the next factor, backwards so that no
+          // element is overwritten before it is read.
+          size_t length = 1;
+          for (size_t f = 0; f < factors_.size(); f++) {
+            const auto columns = factors_[f].column_size();
+            for (size_t x = length; x-- > 0;) {
+              const Complex c(real[x], imag[x]);
+              for (size_t b = columns; b-- > 0;) {
+                const auto e = c * factors_[f].get(digits[f], b);
+                real[x * columns + b] = e.real();
+                imag[x * columns + b] = e.imag();
+              }
+            }
+            length *= columns;
+          }
+        }
+      },
+      std::max<size_t>(1, kronecker_parallel_min_elements / column_size_));
+  return result;
+}
@@ -0,0 +1,80 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef KRONECKER_OPERATOR_H
+#define KRONECKER_OPERATOR_H
+
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*
+ * This class represents the tensor product A_1 ⊗ A_2 ⊗ ... ⊗ A_k by its
+ * factors, without ever building it. As in `AlgebraEngine::tensor_product`,
+ * the first factor is the most significant: element (m, n) is the product of
+ * the A_i(m_i, n_i), where m_i and n_i are the digits of m and n in the mixed
+ * radix of the factors' row and column sizes.
+ *
+ * Vectors are multiplied with the vec-trick: the vector is seen as a tensor
+ * with one mode per factor, and each factor is applied to its own mode in
+ * turn. This takes O(N * sum(dim_i)) operations and two buffers of N
+ * elements, rather than the O(N^2) of the materialised operator.
+ */
+class KroneckerOperator final {
+public:
+  /*
+   * @throws std::invalid_argument if there are no factors, or one of them is
+   * empty.
+   */
+  explicit KroneckerOperator(std::vector<ComplexVectMatrix> factors);
+
+  [[nodiscard]] const std::vector<ComplexVectMatrix> &factors() const {
+    return factors_;
+  }
+
+  [[nodiscard]] size_t row_size() const { return row_size_; }
+
+  [[nodiscard]] size_t column_size() const { return column_size_; }
+
+  /*
+   * @return the element (m, n), as a product of one element per factor.
+   * @throws std::out_of_range if (m, n) is outside the operator.
+   */
+  [[nodiscard]] Complex get(size_t m, size_t n) const;
+
+  /*
+   * The product of the operator by each row of `vects`, a 1xN vector or
+   * several of them, as the rows of the result, like
+   * `GemmEngine::multiply_vectors`.
+   * @throws std::invalid_argument if the vectors do not have as many
+   * elements as the operator has columns.
+   */
+  [[nodiscard]] std::unique_ptr<ComplexVectMatrix>
+  apply(const ComplexVectMatrix &vects) const;
+
+  /*
+   * @return the operator as a whole matrix, each row as the tensor product of
+   * one row per factor. Only meant for small operators.
+   */
+  [[nodiscard]] std::unique_ptr<ComplexVectMatrix> to_matrix() const;
+
+private:
+  std::vector<ComplexVectMatrix> factors_;
+  size_t row_size_ = 1;
+  size_t column_size_ = 1;
+};
+
+#endif // !KRONECKER_OPERATOR_H
@@ -14,14 +14,27 @@
 
 #include "lazy_operation.h"
 #include "complex_vectorised_matrix.h"
+#include "parallel.h"
+#include "thread_pool.h"
 
+#include <algorithm>
 #include <memory>
-#include <thread>
+#include <utility>
+
+// Below this many elements, a matrix is materialised on the calling thread.
+constexpr size_t parallel_min_elements = size_t(1) << 12;
+
+// Operands larger than this stay lazy rather than being evaluated as a task.
+constexpr size_t max_task_elements = size_t(1) << 22;
+
+// Narrowest column tile a row is split into.
+constexpr size_t min_tile_columns = size_t(1) << 10;
 
 void LazyOperation::append(
     const LazyOperation &lazy_op, op_op op, op_op_row op_row,
     std::function<size_t(size_t, size_t, size_t, size_t)> row_size,
-    std::function<size_t(size_t, size_t, size_t, size_t)> column_size) {
+    std::function<size_t(size_t, size_t, size_t, size_t)> column_size,
+    mat_mat_matrix op_matrix, op_op_range op_range) {
 
   // Add all elements of lazy_op and operations
   auto sub_op_start_index = op_vect_.size();
@@ -36,7 +49,10 @@ void LazyOperation::append(
       op_vect_.emplace_back(op_next - 1, mat_next, mat_vect_, op_vect_,
                             std::get<op_mat>(operation.op_functor()),
                             std::get<op_mat_row>(operation.op_row_functor()),
-                            operation.row_size(), operation.column_size());
+                            operation.row_size(), operation.column_size(),
+                            operation.op_matrix_functor(),
+                            std::get<op_mat_range>(
+                                operation.op_range_functor()));
       break;
     }
     case MatrixMatrix: {
@@ -45,7 +61,10 @@ void LazyOperation::append(
       op_vect_.emplace_back(mat_next, mat_next + 1, mat_vect_, op_vect_,
                             std::get<mat_mat>(operation.op_functor()),
                             std::get<mat_mat_row>(operation.op_row_functor()),
-                            operation.row_size(), operation.column_size());
+                            operation.row_size(), operation.column_size(),
+                            operation.op_matrix_functor(),
+                            std::get<mat_mat_range>(
+                                operation.op_range_functor()));
       break;
     }
     case OperationOperation: {
@@ -54,7 +73,10 @@ void LazyOperation::append(
       op_vect_.emplace_back(left_index, right_index, mat_vect_, op_vect_,
                             std::get<op_op>(operation.op_functor()),
                             std::get<op_op_row>(operation.op_row_functor()),
-                            operation.row_size(), operation.column_size());
+                            operation.row_size(), operation.column_size(),
+                            operation.op_matrix_functor(),
+                            std::get<op_op_range>(
+                                operation.op_range_functor()));
     }
     case MatrixOperation:
       // Unused
@@ -62,10 +84,11 @@ void LazyOperation::append(
     }
   }
 
-  // Now, the last op represents the input lazy operation.
+  // Now, the last op represents the input lazy operation, while the left
+  // operand is the tree as it was before.
   auto sub_op_end_index = sub_op_start_index + lazy_op_operations.size() - 1;
-  auto op_row_size = op_vect_.back().row_size();
-  auto op_column_size = op_vect_.back().column_size();
+  auto op_row_size = op_vect_[sub_op_start_index - 1].row_size();
+  auto op_column_size = op_vect_[sub_op_start_index - 1].column_size();
   auto lazy_row_size = lazy_op.row_size();
   auto lazy_column_size = lazy_op.column_size();
   auto final_row_size =
@@ -74,32 +97,161 @@ void LazyOperation::append(
       column_size(op_row_size, op_column_size, lazy_row_size, lazy_column_size);
   op_vect_.emplace_back(sub_op_start_index - 1, sub_op_end_index, mat_vect_,
                         op_vect_, op, op_row, final_row_size,
-                        final_column_size);
+                        final_column_size, std::move(op_matrix),
+                        std::move(op_range));
 }
 
 std::unique_ptr<ComplexVectMatrix> LazyOperation::to_matrix() const {
-  const auto num_threads = std::thread::hardware_concurrency();
-  const auto rows_per_thread =
-      static_cast<int>(std::ceil(static_cast<float>(row_size()) / num_threads));
-  auto threads = std::vector<std::thread>(num_threads);
-
-  auto result = ComplexVector(row_size() * column_size());
-  auto total_rows = row_size();
-  for (size_t t = 0; t < num_threads; t++) {
-    size_t start_row = t * rows_per_thread;
-    size_t end_row = std::min(start_row + rows_per_thread, total_rows);
-
-    threads[t] = std::thread([&result, start_row, end_row, total_rows, this] {
-      for (size_t n = start_row; n < end_row; n++) {
-        auto res = get(n)->get();
-        std::copy(res->begin(), res->end(), result.begin() + (n * total_rows));
+  return evaluate(op_vect_.size() - 1);
+}
+
+/*
+ * A leaf over `mat_vect[index]`, standing for an evaluated operand.
+ */
+Operation evaluated_operand(const std::vector<ComplexVectMatrix> &mat_vect,
+                            const size_t index,
+                            const std::vector<Operation> &op_vect) {
+  return Operation(
+      index, index, mat_vect, op_vect,
+      Operation::mat_mat([](const ComplexVectMatrix &left,
+                            const ComplexVectMatrix &, const size_t m,
+                            const size_t n) { return left.get(m, n); }),
+      Operation::mat_mat_row(
+          [](const ComplexVectMatrix &left, const ComplexVectMatrix &,
+             const size_t row) { return left.get_row(row); }),
+      mat_vect[index].row_size(), mat_vect[index].column_size(), nullptr,
+      Operation::mat_mat_range(
+          [](const ComplexVectMatrix &left, const ComplexVectMatrix &,
+             const size_t row, const size_t col_begin, const size_t col_end) {
+            return left.get_row(row, col_begin, col_end);
+          }));
+}
+
+std::unique_ptr<ComplexVectMatrix>
+LazyOperation::evaluate(const size_t index) const {
+  auto op = op_vect_[index];
+  auto &pool = ThreadPool::instance();
+  switch (op.op_type()) {
+  case OperationOperation: {
+    const auto &left = op_vect_[op.left_index()];
+    const auto &right = op_vect_[op.right_index()];
+    if (left.row_size() * left.column_size() > max_task_elements ||
+        right.row_size() * right.column_size() > max_task_elements) {
+      break;
+    }
+    const auto left_index = op.left_index();
+    auto left_future =
+        pool.submit([this, left_index] { return evaluate(left_index); });
+    std::unique_ptr<ComplexVectMatrix> right_matrix;
+    try {
+      right_matrix = evaluate(op.right_index());
+    } catch (...) {
+      // The left task may still read this tree, so it has to finish first.
+      try {
+        (void)pool.wait(left_future);
+      } catch (...) {
       }
-    });
+      throw;
+    }
+    auto left_matrix = pool.wait(left_future);
+    if (op.has_matrix_functor()) {
+      return op.get(*left_matrix, *right_matrix);
+    }
+
+    // The evaluated subtrees are moved in, an initializer list would copy them.
+    std::vector<ComplexVectMatrix> operands;
+    operands.reserve(2);
+    operands.emplace_back(std::move(*left_matrix));
+    operands.emplace_back(std::move(*right_matrix));
+    std::vector<Operation> leaves;
+    leaves.reserve(2);
+    leaves.push_back(evaluated_operand(operands, 0, leaves));
+    leaves.push_back(evaluated_operand(operands, 1, leaves));
+    return materialise(Operation(
+        0, 1, operands, leaves, std::get<op_op>(op.op_functor()),
+        std::get<op_op_row>(op.op_row_functor()), op.row_size(),
+        op.column_size(), nullptr,
+        std::get<op_op_range>(op.op_range_functor())));
   }
-  for (auto &t : threads) {
-    if (t.joinable())
-      t.join();
+  case OperationMatrix: {
+    const auto &left = op_vect_[op.left_index()];
+    if ((!op.has_matrix_functor() && !has_branches(op.left_index())) ||
+        left.row_size() * left.column_size() > max_task_elements) {
+      break;
+    }
+    auto left_matrix = evaluate(op.left_index());
+    if (op.has_matrix_functor()) {
+      return op.get(*left_matrix, mat_vect_[op.right_index()]);
+    }
+    std::vector<ComplexVectMatrix> operands;
+    operands.reserve(2);
+    operands.emplace_back(std::move(*left_matrix));
+    operands.emplace_back(mat_vect_[op.right_index()]);
+    std::vector<Operation> leaves;
+    leaves.push_back(evaluated_operand(operands, 0, leaves));
+    return materialise(Operation(
+        0, 1, operands, leaves, std::get<op_mat>(op.op_functor()),
+        std::get<op_mat_row>(op.op_row_functor()), op.row_size(),
+        op.column_size(), nullptr,
+        std::get<op_mat_range>(op.op_range_functor())));
   }
+  case MatrixMatrix:
+    if (op.has_matrix_functor()) {
+      return op.get(mat_vect_[op.left_index()], mat_vect_[op.right_index()]);
+    }
+    break;
+  case MatrixOperation:
+    break;
+  }
+  return materialise(op);
+}
+
+bool LazyOperation::has_branches(const size_t index) const {
+  const auto &op = op_vect_[index];
+  switch (op.op_type()) {
+  case OperationOperation:
+    return true;
+  case OperationMatrix:
+    return has_branches(op.left_index());
+  case MatrixOperation:
+    return has_branches(op.right_index());
+  case MatrixMatrix:
+    return false;
+  }
+  return false;
+}
+
+std::unique_ptr<ComplexVectMatrix>
+LazyOperation::materialise(const Operation &op) {
+  const auto rows = op.row_size();
+  const auto columns = op.column_size();
+  auto result = std::make_unique<ComplexVectMatrix>(rows, columns);
+
+  // Whole rows go through the SIMD row path; rows are only tiled when there
+  // are too few of them to keep every thread busy.
+  const auto num_threads = ThreadPool::instance().num_workers() + 1;
+  const auto tiles_per_row =
+      rows >= num_threads ? 1 : std::max<size_t>(1, columns / min_tile_columns);
+  const auto tile_columns = (columns + tiles_per_row - 1) / tiles_per_row;
+  const auto min_tiles =
+      std::max<size_t>(1, parallel_min_elements / tile_columns);
+  parallel_for(
+      rows * tiles_per_row,
+      [&](size_t start_tile, size_t end_tile) {
+        for (size_t t = start_tile; t < end_tile; t++) {
+          const auto m = t / tiles_per_row;
+          const auto col_begin = (t % tiles_per_row) * tile_columns;
+          const auto col_end = std::min(col_begin + tile_columns, columns);
+          auto res = tiles_per_row == 1 ? op.get(m)
+                                        : op.get(m, col_begin, col_end);
+          const auto row = result->row(m);
+          std::ranges::copy(res->real_span(),
+                            row.real().begin() + col_begin);
+          std::ranges::copy(res->imag_span(),
+                            row.imag().begin() + col_begin);
+        }
+      },
+      min_tiles);
 
-  return std::make_unique<ComplexVectMatrix>(result, row_size(), column_size());
+  return result;
 }
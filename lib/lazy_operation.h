@@ -59,47 +59,67 @@ public:
       const ComplexVectMatrix &left, const ComplexVectMatrix &right,
       const size_t row)>;
 
+  using op_op_range = Operation::op_op_range;
+  using op_mat_range = Operation::op_mat_range;
+  using mat_op_range = Operation::mat_op_range;
+  using mat_mat_range = Operation::mat_mat_range;
+
+  using mat_mat_matrix = Operation::mat_mat_matrix;
+
   // A `LazyOperation` can be moved but not copied.
   LazyOperation(LazyOperation &&) = default;
   LazyOperation &operator=(LazyOperation &&) = default;
   LazyOperation(const LazyOperation &) = delete;
   LazyOperation &operator=(const LazyOperation &) = delete;
 
+  /*
+   * An operation between matrices. When given, `op_matrix` computes the
+   * whole result at once from the evaluated operands, and `to_matrix` uses it
+   * in place of the rows, while `op_range` computes a column range of a row,
+   * for the rows `to_matrix` splits into tiles. The same holds for the
+   * operations appended below.
+   */
   LazyOperation(const ComplexVectMatrix &left, const ComplexVectMatrix &right,
                 mat_mat op, mat_mat_row op_row, const size_t final_row_size,
-                const size_t final_column_size) {
+                const size_t final_column_size,
+                mat_mat_matrix op_matrix = nullptr,
+                mat_mat_range op_range = nullptr) {
     mat_vect_.push_back(left);
     mat_vect_.push_back(right);
     op_vect_.emplace_back(0, 1, mat_vect_, op_vect_, std::move(op),
-                          std::move(op_row), final_row_size, final_column_size);
+                          std::move(op_row), final_row_size, final_column_size,
+                          std::move(op_matrix), std::move(op_range));
   }
 
   explicit LazyOperation(const ComplexVectMatrix &mat) {
     mat_vect_.push_back(mat);
     op_vect_.emplace_back(
         0, 0, mat_vect_, op_vect_,
-        [this](const ComplexVectMatrix &left, const ComplexVectMatrix &,
-               const size_t m,
-               const size_t n) { return mat_vect_[0].get(m, n); },
-        [this](const ComplexVectMatrix &left, const ComplexVectMatrix &right,
-               const size_t row) { return mat_vect_[0].get_row(row); },
-        mat.row_size(), mat.column_size());
+        [](const ComplexVectMatrix &left, const ComplexVectMatrix &,
+           const size_t m, const size_t n) { return left.get(m, n); },
+        [](const ComplexVectMatrix &left, const ComplexVectMatrix &,
+           const size_t row) { return left.get_row(row); },
+        mat.row_size(), mat.column_size(), nullptr,
+        [](const ComplexVectMatrix &left, const ComplexVectMatrix &,
+           const size_t row, const size_t col_begin, const size_t col_end) {
+          return left.get_row(row, col_begin, col_end);
+        });
   }
 
   LazyOperation(const ComplexVectMatrix &mat, mat_mat_row op_row) {
     mat_vect_.push_back(mat);
     op_vect_.emplace_back(
         0, 0, mat_vect_, op_vect_,
-        [this](const ComplexVectMatrix &left, const ComplexVectMatrix &,
-               const size_t m,
-               const size_t n) { return mat_vect_[0].get(m, n); },
+        [](const ComplexVectMatrix &left, const ComplexVectMatrix &,
+           const size_t m, const size_t n) { return left.get(m, n); },
         op_row, mat.row_size(), mat.column_size());
   }
 
   void
   append(const ComplexVectMatrix &mat, op_mat op, op_mat_row op_row,
          std::function<size_t(size_t, size_t, size_t, size_t)> row_size,
-         std::function<size_t(size_t, size_t, size_t, size_t)> column_size) {
+         std::function<size_t(size_t, size_t, size_t, size_t)> column_size,
+         mat_mat_matrix op_matrix = nullptr, op_mat_range op_range = nullptr) {
     mat_vect_.push_back(mat);
     auto op_index = op_vect_.size() - 1;
     auto mat_index = mat_vect_.size() - 1;
@@ -111,13 +131,15 @@ public:
                                          mat.row_size(), mat.column_size());
     op_vect_.emplace_back(op_index, mat_index, mat_vect_, op_vect_,
                           std::move(op), std::move(op_row), final_row_size,
-                          final_column_size);
+                          final_column_size, std::move(op_matrix),
+                          std::move(op_range));
   }
 
   void
   append(const LazyOperation &lazy_op, op_op op, op_op_row op_row,
          std::function<size_t(size_t, size_t, size_t, size_t)> row_size,
-         std::function<size_t(size_t, size_t, size_t, size_t)> column_size);
+         std::function<size_t(size_t, size_t, size_t, size_t)> column_size,
+         mat_mat_matrix op_matrix = nullptr, op_op_range op_range = nullptr);
 
   [[nodiscard]] Complex get(const size_t m, const size_t n) const {
     return op_vect_.back().get(m, n);
@@ -127,12 +149,26 @@ public:
     return op_vect_.back().get(row);
   }
 
+  [[nodiscard]] std::unique_ptr<ComplexVectSplit>
+  get(const size_t row, const size_t col_begin, const size_t col_end) const {
+    return op_vect_.back().get(row, col_begin, col_end);
+  }
+
   [[nodiscard]] size_t row_size() const { return op_vect_.back().row_size(); }
 
   [[nodiscard]] size_t column_size() const {
     return op_vect_.back().column_size();
   }
 
+  /*
+   * Evaluates the whole tree into a matrix, in parallel. The two operands of
+   * an operation between lazy operations are independent, so they are
+   * evaluated as separate tasks on the `ThreadPool`, and the operation is then
+   * applied to their results. Rows are split into column tiles when there are
+   * fewer rows than threads, as for a 1xN state. An operation computing its
+   * whole matrix at once gets its operands evaluated first, unless they are
+   * too large to be held, in which case it goes row by row as well.
+   */
   [[nodiscard]] std::unique_ptr<ComplexVectMatrix> to_matrix() const;
 
   [[nodiscard]] std::vector<ComplexVectMatrix> mat_vect() { return mat_vect_; }
@@ -140,6 +176,24 @@ public:
   [[nodiscard]] std::vector<Operation> op_vect() const { return op_vect_; }
 
 private:
+  /*
+   * Evaluates the subtree rooted at `op_vect_[index]`.
+   */
+  [[nodiscard]] std::unique_ptr<ComplexVectMatrix>
+  evaluate(size_t index) const;
+
+  /*
+   * Whether the subtree rooted at `op_vect_[index]` has an operation between
+   * lazy operations, i.e. independent branches.
+   */
+  [[nodiscard]] bool has_branches(size_t index) const;
+
+  /*
+   * Materialises `op` row by row, or tile by tile, in parallel.
+   */
+  [[nodiscard]] static std::unique_ptr<ComplexVectMatrix>
+  materialise(const Operation &op);
+
   std::vector<ComplexVectMatrix> mat_vect_;
   std::vector<Operation> op_vect_;
 };
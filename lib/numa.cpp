@@ -0,0 +1,182 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "numa.h"
+#include "parallel.h"
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Passes over the buffer when measuring bandwidth.
+constexpr size_t bandwidth_passes = 4;
+
+/*
+ * @return the CPUs the calling thread may run on.
+ */
+std::vector<size_t> allowed_cpus() {
+  std::vector<size_t> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (size_t cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    const auto num_cpus = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t cpu = 0; cpu < num_cpus; cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+/*
+ * Parses a kernel CPU list, such as "0-3,8-11".
+ */
+std::vector<size_t> parse_cpu_list(const std::string &list) {
+  std::vector<size_t> cpus;
+  std::stringstream stream(list);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    const auto dash = range.find('-');
+    const size_t first = std::stoul(range.substr(0, dash));
+    const size_t last =
+        dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+    for (size_t cpu = first; cpu <= last; cpu++) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+std::vector<std::vector<size_t>> Numa::nodes() {
+  const auto allowed = allowed_cpus();
+  std::vector<std::vector<size_t>> nodes;
+#ifdef __linux__
+  const std::filesystem::path root("/sys/devices/system/node");
+  std::vector<size_t> node_ids;
+  std::error_code error;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(root, error)) {
+    const auto name = entry.path().filename().string();
+    if (name.starts_with("node") && name.size() > 4 &&
+        std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+      node_ids.push_back(std::stoul(name.substr(4)));
+    }
+  }
+  std::sort(node_ids.begin(), node_ids.end());
+  for (const auto id : node_ids) {
+    std::ifstream file(root / ("node" + std::to_string(id)) / "cpulist");
+    std::string list;
+    std::getline(file, list);
+    std::vector<size_t> cpus;
+    for (const auto cpu : parse_cpu_list(list)) {
+      if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+        cpus.push_back(cpu);
+      }
+    }
+    if (!cpus.empty()) {
+      nodes.push_back(cpus);
+    }
+  }
+#endif
+  if (nodes.empty()) {
+    nodes.push_back(allowed);
+  }
+  return nodes;
+}
+
+bool Numa::pin_thread(const std::vector<size_t> &cpus) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (const auto cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+/*
+ * Zeroes `count` elements with the static schedule of `Numa::first_touch`.
+ */
+template <typename T> void first_touch_zero(T *data, const size_t count) {
+  parallel_for_static(count, [data](size_t start, size_t end) {
+    std::fill(data + start, data + end, T(0));
+  });
+}
+
+void Numa::first_touch(__complex_precision *data, const size_t count) {
+  first_touch_zero(data, count);
+}
+
+void Numa::first_touch(double *data, const size_t count) {
+  first_touch_zero(data, count);
+}
+
+std::vector<double> Numa::node_bandwidth(const size_t bytes) {
+  std::vector<double> bandwidth;
+  for (const auto &cpus : nodes()) {
+    const auto count = std::max<size_t>(1, bytes / sizeof(float) / cpus.size());
+    std::vector<double> seconds(cpus.size());
+    std::barrier start(static_cast<std::ptrdiff_t>(cpus.size()));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < cpus.size(); t++) {
+      threads.emplace_back([&, t] {
+        pin_thread({cpus[t]});
+        std::vector<float> buffer(count, 1.0f);
+        start.arrive_and_wait();
+        const auto begin = std::chrono::steady_clock::now();
+        for (size_t pass = 0; pass < bandwidth_passes; pass++) {
+          for (auto &x : buffer) {
+            x = x * 0.5f + 1.0f;
+          }
+        }
+        const auto end = std::chrono::steady_clock::now();
+        seconds[t] = std::chrono::duration<double>(end - begin).count();
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    // Every pass reads and writes the whole buffer of every thread.
+    const auto moved = 2.0 * bandwidth_passes * count * sizeof(float) *
+                       static_cast<double>(cpus.size());
+    const auto slowest = *std::max_element(seconds.begin(), seconds.end());
+    bandwidth.push_back(slowest > 0 ? moved / slowest / 1e9 : 0);
+  }
+  return bandwidth;
+}
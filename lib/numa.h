@@ -0,0 +1,63 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#include "hilbert_namespace.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * This class places large buffers and threads on the NUMA nodes of the
+ * machine. Pages are placed on the node of the thread that first writes them,
+ * so buffers are first touched by `parallel_for_static`, and the loops
+ * sweeping them later with the same chunks find their chunk local.
+ */
+class Numa {
+public:
+  Numa() = delete;
+
+  /*
+   * @return the CPUs the process may run on, grouped by NUMA node. When the
+   * topology cannot be read, all the CPUs are reported as a single node.
+   */
+  static std::vector<std::vector<size_t>> nodes();
+
+  /*
+   * Restricts the calling thread to `cpus`.
+   * @return whether the thread could be pinned.
+   */
+  static bool pin_thread(const std::vector<size_t> &cpus);
+
+  /*
+   * Zeroes `count` amplitudes with `parallel_for_static`, so that each page
+   * lands on the node of the thread that will own it. Chunk 0 goes to the
+   * calling thread, which the pool does not pin, so its pages follow that
+   * thread wherever it runs.
+   */
+  static void first_touch(__complex_precision *data, size_t count);
+
+  static void first_touch(double *data, size_t count);
+
+  /*
+   * Streams a buffer of `bytes` per node, first touched and then read and
+   * written by one thread per CPU of that node.
+   * @return the bandwidth of each node, in GB/s, in the order of `nodes()`.
+   */
+  static std::vector<double> node_bandwidth(size_t bytes);
+};
+
+#endif // !NUMA_H
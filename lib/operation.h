@@ -19,7 +19,10 @@
 #include "complex_vectorised_matrix.h"
 #include <cstddef>
 #include <functional>
+#include <memory>
+#include <stdexcept>
 #include <variant>
+#include <vector>
 
 /*
  * This enum defines all the supported operations:
@@ -43,10 +46,17 @@ enum OperationType {
  * Then the `OperationType` enum is used to know which kind of operation is
  * being performed.
  *
- * `Operation` offers two ways for retrieving the elements of the resulting
+ * `Operation` offers these ways for retrieving the elements of the resulting
  * matrix:
  * 1. An element-specific get, via the `get(size_t row, size_t column)` method.
  * 2. A SIMD accelerated get of a row, via the `get(size_t row)` method.
+ * 3. A get of a column range of a row, via the
+ *    `get(size_t row, size_t col_begin, size_t col_end)` method. It goes
+ *    through the SIMD accelerated range functor when the operation has one,
+ *    and element by element otherwise.
+ * 4. A get of the whole matrix from its evaluated operands, via the
+ *    `get(left, right)` method, for the operations that have a dedicated
+ *    algorithm for it, such as a GEMM for matrix multiplication.
  *
  * Here, a visualisation of a `Operation` node:
  *
@@ -84,6 +94,22 @@ public:
       const ComplexVectMatrix &left, const ComplexVectMatrix &right,
       const size_t row)>;
 
+  using op_op_range = std::function<std::unique_ptr<ComplexVectSplit>(
+      const Operation &left, const Operation &right, const size_t row,
+      const size_t col_begin, const size_t col_end)>;
+  using op_mat_range = std::function<std::unique_ptr<ComplexVectSplit>(
+      const Operation &left, const ComplexVectMatrix &right, const size_t row,
+      const size_t col_begin, const size_t col_end)>;
+  using mat_op_range = std::function<std::unique_ptr<ComplexVectSplit>(
+      const ComplexVectMatrix &left, const Operation &right, const size_t row,
+      const size_t col_begin, const size_t col_end)>;
+  using mat_mat_range = std::function<std::unique_ptr<ComplexVectSplit>(
+      const ComplexVectMatrix &left, const ComplexVectMatrix &right,
+      const size_t row, const size_t col_begin, const size_t col_end)>;
+
+  using mat_mat_matrix = std::function<std::unique_ptr<ComplexVectMatrix>(
+      const ComplexVectMatrix &left, const ComplexVectMatrix &right)>;
+
   // An `Operation` can be moved but not copied.
   Operation(Operation &&) = default;
   Operation &operator=(Operation &&) = delete;
@@ -93,39 +119,51 @@ public:
   Operation(size_t left_index, size_t right_index,
             const std::vector<ComplexVectMatrix> &mat_vect,
             const std::vector<Operation> &op_vect, op_op op, op_op_row op_row,
-            const size_t final_row_size, const size_t final_column_size)
+            const size_t final_row_size, const size_t final_column_size,
+            mat_mat_matrix op_matrix = nullptr, op_op_range op_range = nullptr)
       : left_index_(left_index), right_index_(right_index),
         op_type_(OperationOperation), mat_vect_(mat_vect), op_vect_(op_vect),
         op_functor_(std::move(op)), op_row_functor_(std::move(op_row)),
-        row_size_(final_row_size), column_size_(final_column_size) {}
+        op_matrix_functor_(std::move(op_matrix)),
+        op_range_functor_(std::move(op_range)), row_size_(final_row_size),
+        column_size_(final_column_size) {}
 
   Operation(size_t left_index, size_t right_index,
             const std::vector<ComplexVectMatrix> &mat_vect,
             const std::vector<Operation> &op_vect, op_mat op, op_mat_row op_row,
-            const size_t final_row_size, const size_t final_column_size)
+            const size_t final_row_size, const size_t final_column_size,
+            mat_mat_matrix op_matrix = nullptr, op_mat_range op_range = nullptr)
       : left_index_(left_index), right_index_(right_index),
         op_type_(OperationMatrix), mat_vect_(mat_vect), op_vect_(op_vect),
         op_functor_(std::move(op)), op_row_functor_(std::move(op_row)),
-        row_size_(final_row_size), column_size_(final_column_size) {}
+        op_matrix_functor_(std::move(op_matrix)),
+        op_range_functor_(std::move(op_range)), row_size_(final_row_size),
+        column_size_(final_column_size) {}
 
   Operation(size_t left_index, size_t right_index,
             const std::vector<ComplexVectMatrix> &mat_vect,
             const std::vector<Operation> &op_vect, mat_op op, mat_op_row op_row,
-            const size_t final_row_size, const size_t final_column_size)
+            const size_t final_row_size, const size_t final_column_size,
+            mat_mat_matrix op_matrix = nullptr, mat_op_range op_range = nullptr)
       : left_index_(left_index), right_index_(right_index),
         op_type_(MatrixOperation), mat_vect_(mat_vect), op_vect_(op_vect),
         op_functor_(std::move(op)), op_row_functor_(std::move(op_row)),
-        row_size_(final_row_size), column_size_(final_column_size) {}
+        op_matrix_functor_(std::move(op_matrix)),
+        op_range_functor_(std::move(op_range)), row_size_(final_row_size),
+        column_size_(final_column_size) {}
 
   Operation(size_t left_index, size_t right_index,
             const std::vector<ComplexVectMatrix> &mat_vect,
             const std::vector<Operation> &op_vect, mat_mat op,
             mat_mat_row op_row, const size_t final_row_size,
-            const size_t final_column_size)
+            const size_t final_column_size, mat_mat_matrix op_matrix = nullptr,
+            mat_mat_range op_range = nullptr)
       : left_index_(left_index), right_index_(right_index),
         op_type_(MatrixMatrix), mat_vect_(mat_vect), op_vect_(op_vect),
         op_functor_(std::move(op)), op_row_functor_(std::move(op_row)),
-        row_size_(final_row_size), column_size_(final_column_size) {}
+        op_matrix_functor_(std::move(op_matrix)),
+        op_range_functor_(std::move(op_range)), row_size_(final_row_size),
+        column_size_(final_column_size) {}
 
   /*
    * Element-specific get.
@@ -182,6 +220,78 @@ public:
     throw std::logic_error("Unexpected OperationType");
   }
 
+  /*
+   * Retrieves the columns [col_begin, col_end) of the requested row, so that a
+   * long row can be split among threads.
+   * @param row The row where the elements lie.
+   * @param col_begin The first column to be retrieved.
+   * @param col_end The column past the last one to be retrieved.
+   * @return the requested elements, as a pointer to a `ComplexVectSplit`
+   * @throws std::out_of_range if the columns are not in the row.
+   */
+  [[nodiscard]] std::unique_ptr<ComplexVectSplit>
+  get(const size_t row, const size_t col_begin, const size_t col_end) const {
+    if (col_begin > col_end || col_end > column_size_) {
+      throw std::out_of_range("Invalid column range");
+    }
+    if (col_begin == 0 && col_end == column_size_) {
+      return get(row);
+    }
+    if (has_range_functor()) {
+      switch (op_type_) {
+      case OperationOperation: {
+        auto op = std::get<op_op_range>(op_range_functor_);
+        return op(op_vect_[left_index_], op_vect_[right_index_], row,
+                  col_begin, col_end);
+      }
+      case OperationMatrix: {
+        auto op = std::get<op_mat_range>(op_range_functor_);
+        return op(op_vect_[left_index_], mat_vect_[right_index_], row,
+                  col_begin, col_end);
+      }
+      case MatrixOperation: {
+        auto op = std::get<mat_op_range>(op_range_functor_);
+        return op(mat_vect_[left_index_], op_vect_[right_index_], row,
+                  col_begin, col_end);
+      }
+      case MatrixMatrix: {
+        auto op = std::get<mat_mat_range>(op_range_functor_);
+        return op(mat_vect_[left_index_], mat_vect_[right_index_], row,
+                  col_begin, col_end);
+      }
+      }
+    }
+    auto result = std::make_unique<ComplexVectSplit>(col_end - col_begin);
+    for (size_t n = col_begin; n < col_end; n++) {
+      result->set(n - col_begin, get(row, n));
+    }
+    return result;
+  }
+
+  /*
+   * Computes the whole matrix at once.
+   * @param left The left operand, evaluated.
+   * @param right The right operand, evaluated.
+   * @return the resulting matrix.
+   * @throws std::logic_error if the operation has no whole-matrix functor.
+   */
+  [[nodiscard]] std::unique_ptr<ComplexVectMatrix>
+  get(const ComplexVectMatrix &left, const ComplexVectMatrix &right) const {
+    if (!has_matrix_functor()) {
+      throw std::logic_error("No whole-matrix functor");
+    }
+    return op_matrix_functor_(left, right);
+  }
+
+  [[nodiscard]] bool has_matrix_functor() const {
+    return static_cast<bool>(op_matrix_functor_);
+  }
+
+  [[nodiscard]] bool has_range_functor() const {
+    return std::visit([](const auto &op) { return static_cast<bool>(op); },
+                      op_range_functor_);
+  }
+
   [[nodiscard]] size_t row_size() const { return row_size_; }
 
   [[nodiscard]] size_t column_size() const { return column_size_; }
@@ -225,6 +335,16 @@ public:
     return op_row_functor_;
   }
 
+  [[nodiscard]] mat_mat_matrix op_matrix_functor() const {
+    return op_matrix_functor_;
+  }
+
+  [[nodiscard]] std::variant<op_op_range, op_mat_range, mat_op_range,
+                             mat_mat_range>
+  op_range_functor() {
+    return op_range_functor_;
+  }
+
 private:
   const size_t left_index_;
   const size_t right_index_;
@@ -235,6 +355,9 @@ private:
 
   std::variant<op_op, op_mat, mat_op, mat_mat> op_functor_;
   std::variant<op_op_row, op_mat_row, mat_op_row, mat_mat_row> op_row_functor_;
+  mat_mat_matrix op_matrix_functor_;
+  std::variant<op_op_range, op_mat_range, mat_op_range, mat_mat_range>
+      op_range_functor_;
 
   size_t row_size_;
   size_t column_size_;
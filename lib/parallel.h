@@ -0,0 +1,87 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "simd.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+
+// Static chunks are cut at multiples of this many elements.
+constexpr size_t static_chunk_align = size_t(1) << 16;
+
+/*
+ * Calls `f(start, end)` on chunks covering [0, blocks) on the process-wide
+ * `ThreadPool`, returning once all are done. Loops of at most `min_grain`
+ * blocks run on the calling thread.
+ */
+inline void parallel_for(const size_t blocks,
+                         const std::function<void(size_t, size_t)> &f,
+                         const size_t min_grain = 1,
+                         const Schedule schedule = Schedule::Dynamic) {
+  ThreadPool::instance().parallel_for(blocks, f, min_grain, schedule);
+}
+
+/*
+ * Calls `f(start, end)` on the static chunks of [0, count), chunk `t` on thread
+ * `t` of the `ThreadPool`. Chunks only depend on `count` and the number of
+ * threads, and are cut at multiples of `static_chunk_align` elements, or of
+ * `align` when larger, so that every loop over the same buffer, with blocks
+ * of up to `static_chunk_align` elements, hands each thread the same elements.
+ * Loops of a single chunk run on the calling thread.
+ */
+inline void parallel_for_static(const size_t count,
+                                const std::function<void(size_t, size_t)> &f,
+                                const size_t align = 1) {
+  const auto unit = std::max(align, static_chunk_align);
+  const auto num_threads = ThreadPool::instance().num_workers() + 1;
+  const auto per_thread = (count + num_threads - 1) / num_threads;
+  const auto grain = (per_thread + unit - 1) / unit * unit;
+  parallel_for(count, f, grain, Schedule::Static);
+}
+
+/*
+ * Calls `f(offset, length, controls)` on slices of a state of `size`
+ * amplitudes, so that a gate kernel applied to each slice with `controls`
+ * applies a gate on the qubits in the `targets` mask, where all the qubits in
+ * the `controls` mask are set, to the whole state. Slices hold
+ * `static_chunk_align` amplitudes: the qubits of the gate beyond a slice
+ * select the slices that hold the amplitudes with its targets clear and its
+ * controls set, and those are split over the static chunks, in order, so that
+ * each thread mostly sweeps the amplitudes it first touched.
+ */
+inline void
+parallel_for_slices(const size_t size, const size_t targets,
+                    const size_t controls,
+                    const std::function<void(size_t, size_t, size_t)> &f) {
+  const auto length = std::min(size, static_chunk_align);
+  const auto above = (targets | controls) & ~(length - 1);
+  const auto high_controls = controls & above;
+  const auto low_controls = controls & (length - 1);
+  parallel_for_static(
+      size >> std::popcount(above),
+      [&](size_t start, size_t end) {
+        for (size_t s = start; s < end; s += length) {
+          f(simd::insert_zero_bits(s, above) | high_controls, length,
+            low_controls);
+        }
+      },
+      length);
+}
+
+#endif // !PARALLEL_H
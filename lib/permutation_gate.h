@@ -0,0 +1,131 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef PERMUTATION_GATE_H
+#define PERMUTATION_GATE_H
+
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * This class represents a classical reversible gate over k qubits, i.e. a
+ * permutation of the 2^k basis states: |j> is sent to |permutation[j]>. Bit `q`
+ * of a local basis index stands for the q-th qubit the gate is applied to.
+ * Permutations are applied as pure data movement, with no arithmetic.
+ *
+ * Controlled variants (CNOT, Toffoli, Fredkin) are obtained by applying
+ * `pauli_x` or `swap` with controls.
+ */
+class PermutationGate final {
+public:
+  explicit PermutationGate(std::vector<size_t> permutation)
+      : permutation_(std::move(permutation)) {
+    const auto size = permutation_.size();
+    auto sorted = permutation_;
+    std::sort(sorted.begin(), sorted.end());
+    if (size < 2 || !std::has_single_bit(size) ||
+        std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end() ||
+        sorted.back() != size - 1) {
+      throw std::invalid_argument("Not a permutation of 2^k basis states");
+    }
+  }
+
+  explicit PermutationGate(const ComplexVectMatrix &gate) {
+    if (!is_permutation(gate)) {
+      throw std::invalid_argument("Gate must be a permutation matrix");
+    }
+    permutation_.resize(gate.column_size());
+    for (size_t m = 0; m < gate.row_size(); m++) {
+      for (size_t n = 0; n < gate.column_size(); n++) {
+        if (gate.get(m, n) == Complex(1)) {
+          permutation_[n] = m;
+        }
+      }
+    }
+  }
+
+  /*
+   * Whether `gate` is a square 2^k matrix with exactly one 1 in every row and
+   * column, and zeros elsewhere.
+   */
+  static bool is_permutation(const ComplexVectMatrix &gate) {
+    const auto size = gate.row_size();
+    if (size < 2 || size != gate.column_size() || !std::has_single_bit(size)) {
+      return false;
+    }
+    std::vector<size_t> column_ones(size, 0);
+    for (size_t m = 0; m < size; m++) {
+      size_t row_ones = 0;
+      for (size_t n = 0; n < size; n++) {
+        const auto c = gate.get(m, n);
+        if (c == Complex(1)) {
+          row_ones++;
+          column_ones[n]++;
+        } else if (c != Complex(0)) {
+          return false;
+        }
+      }
+      if (row_ones != 1) {
+        return false;
+      }
+    }
+    return std::all_of(column_ones.begin(), column_ones.end(),
+                       [](size_t ones) { return ones == 1; });
+  }
+
+  [[nodiscard]] size_t num_qubits() const {
+    return static_cast<size_t>(std::countr_zero(permutation_.size()));
+  }
+
+  [[nodiscard]] const std::vector<size_t> &permutation() const {
+    return permutation_;
+  }
+
+  [[nodiscard]] bool is_pauli_x() const {
+    return permutation_ == std::vector<size_t>({1, 0});
+  }
+
+  [[nodiscard]] bool is_swap() const {
+    return permutation_ == std::vector<size_t>({0, 2, 1, 3});
+  }
+
+  [[nodiscard]] std::unique_ptr<ComplexVectMatrix> to_matrix() const {
+    const auto size = permutation_.size();
+    ComplexVector m(size * size);
+    for (size_t n = 0; n < size; n++) {
+      m[permutation_[n] * size + n] = 1;
+    }
+    return std::make_unique<ComplexVectMatrix>(m, size, size);
+  }
+
+  static std::unique_ptr<PermutationGate> pauli_x() {
+    return std::make_unique<PermutationGate>(std::vector<size_t>({1, 0}));
+  }
+
+  static std::unique_ptr<PermutationGate> swap() {
+    return std::make_unique<PermutationGate>(
+        std::vector<size_t>({0, 2, 1, 3}));
+  }
+
+private:
+  std::vector<size_t> permutation_;
+};
+
+#endif // !PERMUTATION_GATE_H
@@ -0,0 +1,128 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "reduction.h"
+#include "parallel.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+/*
+ * Adds the `count` values pairwise, in place: a fixed tree of rounds, each
+ * adding neighbours and carrying an odd last value over to the next round.
+ */
+template <typename R> R pairwise_sum(R *values, size_t count) {
+  if (count == 0) {
+    return R(0);
+  }
+  while (count > 1) {
+    const auto half = count / 2;
+    for (size_t i = 0; i < half; i++) {
+      values[i] = values[2 * i] + values[2 * i + 1];
+    }
+    if (count % 2 == 1) {
+      values[half] = values[count - 1];
+    }
+    count = half + count % 2;
+  }
+  return values[0];
+}
+
+/*
+ * Sums [0, length) leaf by leaf in parallel, `leaf(first, length)` summing the
+ * leaf starting at `first`, then adds the leaves pairwise. Leaves are split
+ * with the static chunks the amplitudes were first touched with, so that each
+ * thread reads memory of its own NUMA node.
+ */
+template <typename R, typename F>
+R tree_sum(const size_t length, const F &leaf) {
+  const auto leaf_size = Reduction::leaf_size;
+  const auto leaves = (length + leaf_size - 1) / leaf_size;
+  std::vector<R> partial(leaves);
+  parallel_for_static(
+      length,
+      [&](size_t start, size_t end) {
+        const auto last = (end + leaf_size - 1) / leaf_size;
+        for (size_t b = start / leaf_size; b < last; b++) {
+          const auto first = b * leaf_size;
+          partial[b] = leaf(first, std::min(leaf_size, length - first));
+        }
+      },
+      leaf_size);
+  return pairwise_sum(partial.data(), leaves);
+}
+
+template <typename T>
+double Reduction::sum(const T *data, const size_t length) {
+  return tree_sum<double>(
+      length, [data](const size_t first, const size_t count) {
+        return simd::leaf_sum(data + first, count);
+      });
+}
+
+template <typename T>
+std::complex<double> Reduction::sum(const T *real, const T *imag,
+                                    const size_t length) {
+  return tree_sum<std::complex<double>>(
+      length, [real, imag](const size_t first, const size_t count) {
+        return simd::leaf_csum(real + first, imag + first, count);
+      });
+}
+
+template <typename T>
+double Reduction::norm(const T *real, const T *imag, const size_t length) {
+  return std::sqrt(mass(real, imag, length, 0, 0));
+}
+
+template <typename T>
+std::complex<double>
+Reduction::inner_product(const T *x_real, const T *x_imag, const T *y_real,
+                         const T *y_imag, const size_t length) {
+  return tree_sum<std::complex<double>>(
+      length, [&](const size_t first, const size_t count) {
+        return simd::leaf_cdotc(x_real + first, x_imag + first,
+                                y_real + first, y_imag + first, count);
+      });
+}
+
+template <typename T>
+double Reduction::mass(const T *real, const T *imag, const size_t length,
+                       const size_t mask, const size_t value) {
+  return tree_sum<double>(length, [&](const size_t first, const size_t count) {
+    return simd::leaf_mass(real + first, imag + first, count, first, mask,
+                           value);
+  });
+}
+
+template double Reduction::sum(const float *, size_t);
+template double Reduction::sum(const double *, size_t);
+template std::complex<double> Reduction::sum(const float *, const float *,
+                                             size_t);
+template std::complex<double> Reduction::sum(const double *, const double *,
+                                             size_t);
+template double Reduction::norm(const float *, const float *, size_t);
+template double Reduction::norm(const double *, const double *, size_t);
+template std::complex<double>
+Reduction::inner_product(const float *, const float *, const float *,
+                         const float *, size_t);
+template std::complex<double>
+Reduction::inner_product(const double *, const double *, const double *,
+                         const double *, size_t);
+template double Reduction::mass(const float *, const float *, size_t, size_t,
+                                size_t);
+template double Reduction::mass(const double *, const double *, size_t,
+                                size_t, size_t);
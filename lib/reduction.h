@@ -0,0 +1,72 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef REDUCTION_H
+#define REDUCTION_H
+
+#include <complex>
+#include <cstddef>
+
+/*
+ * This class sums over large split vectors, such as the amplitudes of a dense
+ * state, in double precision and so that the result does not depend on how
+ * the work is split between threads.
+ *
+ * The vector is cut into leaves of `leaf_size` elements. Element `i` of a leaf
+ * is accumulated into lane `i % lanes`, the lanes are added pairwise, and so
+ * are the leaf sums, in a tree whose shape only depends on the length. The
+ * lanes of a leaf are double registers of the selected instruction set (see
+ * `simd::leaf_sum`), which only set how many lanes an instruction adds.
+ * Threads only choose which leaves they sum, so the result is the same, to
+ * the bit, for any number of threads. The products of single-precision
+ * inputs are exact in double, so that only the additions round.
+ */
+class Reduction {
+public:
+  Reduction() = delete;
+
+  static constexpr size_t leaf_size = size_t(1) << 12;
+
+  static constexpr size_t lanes = 8;
+
+  template <typename T> static double sum(const T *data, size_t length);
+
+  template <typename T>
+  static std::complex<double> sum(const T *real, const T *imag, size_t length);
+
+  /*
+   * @return the Euclidean norm, sqrt(sum |x_i|^2).
+   */
+  template <typename T>
+  static double norm(const T *real, const T *imag, size_t length);
+
+  /*
+   * @return sum conj(x_i) y_i.
+   */
+  template <typename T>
+  static std::complex<double> inner_product(const T *x_real, const T *x_imag,
+                                            const T *y_real, const T *y_imag,
+                                            size_t length);
+
+  /*
+   * @return the mass sum |x_i|^2 over the indices `i` where the bits in
+   * `mask` equal those of `value`.
+   */
+  template <typename T>
+  static double mass(const T *real, const T *imag, size_t length, size_t mask,
+                     size_t value);
+};
+
+#endif // !REDUCTION_H
@@ -0,0 +1,67 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "scratch_arena.h"
+#include <algorithm>
+
+ScratchArena &ScratchArena::local() {
+  thread_local ScratchArena arena;
+  return arena;
+}
+
+__complex_precision *ScratchArena::allocate(const size_t count) {
+  const auto size = rounded(count);
+  if (blocks_.empty() || offset_ + size > blocks_[block_].size()) {
+    next_block(size);
+  }
+  auto *buffer = blocks_[block_].data() + offset_;
+  offset_ += size;
+  std::fill(buffer + count, buffer + size, 0);
+  return buffer;
+}
+
+void ScratchArena::rewind(const Mark mark) {
+  block_ = mark.block;
+  offset_ = mark.offset;
+  if (block_ == 0 && offset_ == 0 && blocks_.size() > 1) {
+    const auto total = capacity();
+    blocks_.clear();
+    blocks_.emplace_back(total);
+  }
+}
+
+size_t ScratchArena::capacity() const {
+  size_t total = 0;
+  for (const auto &block : blocks_) {
+    total += block.size();
+  }
+  return total;
+}
+
+void ScratchArena::next_block(const size_t size) {
+  // The blocks after the current one hold no live buffer, so they are reused
+  // when large enough, or else replaced by a larger one.
+  const auto next = blocks_.empty() ? 0 : block_ + 1;
+  if (next < blocks_.size() && blocks_[next].size() >= size) {
+    block_ = next;
+    offset_ = 0;
+    return;
+  }
+  const auto last = blocks_.empty() ? 0 : blocks_[block_].size();
+  blocks_.resize(next);
+  blocks_.emplace_back(std::max({size, min_block_elements, 2 * last}));
+  block_ = next;
+  offset_ = 0;
+}
@@ -0,0 +1,128 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SCRATCH_ARENA_H
+#define SCRATCH_ARENA_H
+
+#include "aligned_allocator.h"
+#include "hilbert_namespace.h"
+#include <cstddef>
+#include <vector>
+
+/*
+ * This class is a bump allocator for the temporary buffers of the SIMD
+ * kernels, one per thread, so that evaluating a row does not go through
+ * malloc and free for every element.
+ *
+ * Buffers are carved out of large aligned blocks and are only given back all
+ * together, by rewinding the arena to an earlier `mark()`. A `Scope` does so
+ * when it goes out of scope, so nested scopes behave like a stack. The blocks
+ * are kept across rewinds, so that once warmed up the arena allocates nothing.
+ */
+class ScratchArena final {
+public:
+  // Buffers are rounded up to whole cache lines, so that each is 64-byte
+  // aligned and padded like a `ComplexVectSplit`.
+  static constexpr size_t line_elements = 64 / sizeof(__complex_precision);
+
+  // Smallest block requested from the system.
+  static constexpr size_t min_block_elements = size_t(1) << 14;
+
+  /*
+   * A position in the arena, as returned by `mark()`.
+   */
+  struct Mark {
+    size_t block;
+    size_t offset;
+  };
+
+  /*
+   * Rewinds the arena to where it was at construction when destroyed, giving
+   * back every buffer allocated meanwhile.
+   */
+  class Scope final {
+  public:
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    explicit Scope(ScratchArena &arena = ScratchArena::local())
+        : arena_(arena), mark_(arena.mark()) {}
+
+    ~Scope() { arena_.rewind(mark_); }
+
+  private:
+    ScratchArena &arena_;
+    const Mark mark_;
+  };
+
+  ScratchArena() = default;
+  ScratchArena(const ScratchArena &) = delete;
+  ScratchArena &operator=(const ScratchArena &) = delete;
+
+  /*
+   * @return the arena of the calling thread.
+   */
+  static ScratchArena &local();
+
+  /*
+   * @return a buffer of `count` elements, 64-byte aligned. The elements past
+   * `count`, up to the next cache line, are zeroed, while the first `count`
+   * are left for the caller to write.
+   */
+  [[nodiscard]] __complex_precision *allocate(size_t count);
+
+  /*
+   * `allocate` for `count` elements of another arithmetic type, such as the
+   * double amplitudes of a double-precision state.
+   */
+  template <typename T> [[nodiscard]] T *allocate_as(const size_t count) {
+    static_assert(sizeof(T) % sizeof(__complex_precision) == 0);
+    constexpr auto ratio = sizeof(T) / sizeof(__complex_precision);
+    return reinterpret_cast<T *>(allocate(count * ratio));
+  }
+
+  [[nodiscard]] Mark mark() const { return {block_, offset_}; }
+
+  /*
+   * Gives back every buffer allocated after `mark`. Rewinding to an empty
+   * arena merges its blocks into one, so that the next round fits in it.
+   */
+  void rewind(Mark mark);
+
+  void reset() { rewind({0, 0}); }
+
+  /*
+   * @return the elements held from the system, used or not.
+   */
+  [[nodiscard]] size_t capacity() const;
+
+  [[nodiscard]] size_t num_blocks() const { return blocks_.size(); }
+
+  /*
+   * @return `count` rounded up to whole cache lines.
+   */
+  static size_t rounded(const size_t count) {
+    return (count + line_elements - 1) / line_elements * line_elements;
+  }
+
+private:
+  void next_block(size_t size);
+
+  std::vector<AlignedVector<__complex_precision>> blocks_;
+  size_t block_ = 0;
+  size_t offset_ = 0;
+};
+
+#endif // !SCRATCH_ARENA_H
@@ -0,0 +1,239 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "simd.h"
+#include "hilbert_namespace.h"
+#include "split_span.h"
+#include <cmath>
+#include <cstddef>
+
+#ifdef __APPLE__
+#include <Accelerate/Accelerate.h>
+#else
+#include "simd_backend.h"
+#include "system_info.h"
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#endif
+
+#ifdef __APPLE__
+/*
+ * Views `x` as a vDSP split complex vector. vDSP takes non-const pointers
+ * even for its inputs.
+ */
+DSPSplitComplex dsp_split(const ConstSplitSpan x) {
+  return {const_cast<__complex_precision *>(x.padded_real().data()),
+          const_cast<__complex_precision *>(x.padded_imag().data())};
+}
+#else
+// The instruction sets with their names, from the narrowest to the widest.
+constexpr std::array<std::pair<Isa, std::string_view>, 4> isa_names = {{
+    {Isa::Scalar, "scalar"},
+    {Isa::Sse, "sse"},
+    {Isa::Avx2, "avx2"},
+    {Isa::Avx512, "avx512"},
+}};
+
+/*
+ * Whether the kernels for `isa` are part of this build.
+ */
+constexpr bool is_built([[maybe_unused]] const Isa isa) {
+#ifdef HILBERT_AVX512
+  return true;
+#else
+  return isa != Isa::Avx512;
+#endif
+}
+
+/*
+ * Whether the CPU can run the kernels built for `isa`.
+ */
+bool cpu_supports(const Isa isa) {
+  static const auto features = SystemInfo::cpu_features();
+  switch (isa) {
+  case Isa::Scalar:
+    return true;
+  case Isa::Sse:
+    return features.sse41;
+  case Isa::Avx2:
+    return features.avx2 && features.fma;
+  case Isa::Avx512:
+    return features.avx512f && features.avx512dq;
+  }
+  return false;
+}
+
+/*
+ * @return the kernels built for `isa` on `T` amplitudes. `isa` must be
+ * supported.
+ */
+template <typename T> const SimdBackend<T> &backend_of(const Isa isa) {
+  switch (isa) {
+  case Isa::Sse:
+    return sse_backend<T>();
+  case Isa::Avx2:
+    return avx2_backend<T>();
+  case Isa::Avx512:
+#ifdef HILBERT_AVX512
+    return avx512_backend<T>();
+#else
+    break;
+#endif
+  case Isa::Scalar:
+    break;
+  }
+  return scalar_backend<T>();
+}
+
+/*
+ * The instruction set named by HILBERT_ISA, or else the widest supported.
+ */
+Isa startup_isa() {
+  if (const char *name = std::getenv("HILBERT_ISA")) {
+    const auto isa = simd::parse_isa(name);
+    if (!simd::is_supported(isa)) {
+      throw std::invalid_argument(
+          "HILBERT_ISA=" + std::string(name) +
+          " is not built or not supported by the CPU");
+    }
+    return isa;
+  }
+  for (auto it = isa_names.rbegin(); it != isa_names.rend(); it++) {
+    if (simd::is_supported(it->first)) {
+      return it->first;
+    }
+  }
+  return Isa::Scalar;
+}
+
+/*
+ * The selected instruction set, shared by both precisions.
+ */
+std::atomic<Isa> &active_isa() {
+  static std::atomic<Isa> active = startup_isa();
+  return active;
+}
+
+bool simd::is_supported(const Isa isa) {
+  return is_built(isa) && cpu_supports(isa);
+}
+
+Isa simd::parse_isa(const std::string_view name) {
+  for (const auto &[isa, isa_name] : isa_names) {
+    if (name == isa_name) {
+      return isa;
+    }
+  }
+  throw std::invalid_argument("Unknown instruction set: " + std::string(name));
+}
+
+std::string_view simd::isa_name(const Isa isa) {
+  for (const auto &[named, name] : isa_names) {
+    if (named == isa) {
+      return name;
+    }
+  }
+  return {};
+}
+
+Isa simd::isa() { return active_isa().load(std::memory_order_relaxed); }
+
+void simd::set_isa(const Isa isa) {
+  if (!is_supported(isa)) {
+    throw std::invalid_argument(
+        "Instruction set not built or not supported by the CPU");
+  }
+  active_isa().store(isa);
+}
+
+template <typename T> const SimdBackend<T> &simd::backend() {
+  return backend_of<T>(isa());
+}
+
+template const SimdBackend<float> &simd::backend();
+template const SimdBackend<double> &simd::backend();
+#endif
+
+Complex simd::cdotu(const ConstSplitSpan x, const ConstSplitSpan y) {
+#ifdef __APPLE__
+  const auto dsp_x = dsp_split(x);
+  const auto dsp_y = dsp_split(y);
+  __complex_precision re = 0, im = 0;
+  DSPSplitComplex result = {&re, &im};
+  vDSP_zdotpr(&dsp_x, 1, &dsp_y, 1, &result, x.padded_size());
+  return Complex(re, im);
+#else
+  return backend().cdotu(x.padded_real().data(), x.padded_imag().data(),
+                         y.padded_real().data(), y.padded_imag().data(),
+                         x.padded_size());
+#endif
+}
+
+Complex simd::cdotc(const ConstSplitSpan x, const ConstSplitSpan y) {
+#ifdef __APPLE__
+  const auto dsp_x = dsp_split(x);
+  const auto dsp_y = dsp_split(y);
+  __complex_precision re = 0, im = 0;
+  DSPSplitComplex result = {&re, &im};
+  vDSP_zidotpr(&dsp_x, 1, &dsp_y, 1, &result, x.padded_size());
+  return Complex(re, im);
+#else
+  return backend().cdotc(x.padded_real().data(), x.padded_imag().data(),
+                         y.padded_real().data(), y.padded_imag().data(),
+                         x.padded_size());
+#endif
+}
+
+void simd::caxpy(const Complex a, const ConstSplitSpan x, const SplitSpan y) {
+#ifdef __APPLE__
+  const auto dsp_x = dsp_split(x);
+  const auto dsp_y = dsp_split(y);
+  __complex_precision re = a.real(), im = a.imag();
+  DSPSplitComplex scalar = {&re, &im};
+  vDSP_zvsma(&dsp_x, 1, &scalar, &dsp_y, 1, &dsp_y, 1, x.padded_size());
+#else
+  backend().caxpy(a, x.padded_real().data(), x.padded_imag().data(),
+                  y.padded_real().data(), y.padded_imag().data(),
+                  x.padded_size());
+#endif
+}
+
+void simd::cscal(const Complex a, const SplitSpan x) {
+#ifdef __APPLE__
+  const auto dsp_x = dsp_split(x);
+  __complex_precision re = a.real(), im = a.imag();
+  DSPSplitComplex scalar = {&re, &im};
+  vDSP_zvzsml(&dsp_x, 1, &scalar, &dsp_x, 1, x.padded_size());
+#else
+  backend().cscal(a, x.padded_real().data(), x.padded_imag().data(),
+                  x.padded_size());
+#endif
+}
+
+__complex_precision simd::cnrm2(const ConstSplitSpan x) {
+#ifdef __APPLE__
+  __complex_precision re = 0, im = 0;
+  vDSP_svesq(x.padded_real().data(), 1, &re, x.padded_size());
+  vDSP_svesq(x.padded_imag().data(), 1, &im, x.padded_size());
+  return std::sqrt(re + im);
+#else
+  return backend().cnrm2(x.padded_real().data(), x.padded_imag().data(),
+                         x.padded_size());
+#endif
+}
@@ -15,83 +15,127 @@
 #ifndef SIMD_H
 #define SIMD_H
 
+#include "aligned_allocator.h"
 #include "complex_vector_split.h"
+#include "reduction.h"
+#include "scratch_arena.h"
+#include "split_span.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <complex>
 #include <memory.h>
+#include <utility>
+#include <vector>
 
 #ifdef __APPLE__
 #include <Accelerate/Accelerate.h>
 #else
+#include "simd_backend.h"
 #include <cstddef>
-#include <immintrin.h>
+#include <string_view>
 #endif
 
+/*
+ * The SIMD kernels of the library. On Apple they go through Accelerate, on
+ * x86 through the `SimdBackend` of the selected instruction set. The vector
+ * kernels work on `__complex_precision` amplitudes, the gate kernels on float
+ * or double ones, so that a state can be simulated in either precision.
+ */
 class simd {
 public:
+  // Outputs of at least this many elements are written with streaming stores,
+  // as they would only evict the inputs from the cache.
+  static constexpr size_t streaming_min_elements = size_t(1) << 18;
+
   /*
    * SIMD element-wise complex vector multiplication
    */
-  static std::unique_ptr<ComplexVectSplit>
-  cvmul(const ComplexVectSplit &left, const ComplexVectSplit &right) {
-
-    // Considering the formula (a + bi)(c + di) = (ac - bd) + i(ad + bc):
-    std::vector<__complex_precision> ac_vect(left.size()), bd_vect(left.size()),
-        ad_vect(left.size()), bc_vect(left.size());
-
-    std::vector<__complex_precision> result_real(left.size());
-    std::vector<__complex_precision> result_imag(left.size());
+  static std::unique_ptr<ComplexVectSplit> cvmul(const ConstSplitSpan left,
+                                                 const ConstSplitSpan right) {
+    auto result = std::make_unique<ComplexVectSplit>(left.size());
+    const auto length = result->padded_size();
+#ifndef __APPLE__
+    if (length >= streaming_min_elements) {
+      backend().cvmul(left.padded_real().data(), left.padded_imag().data(),
+                      right.padded_real().data(), right.padded_imag().data(),
+                      result->real_data(), result->imag_data(), length, true);
+      return result;
+    }
+#endif
+    cvmul(left, right, result->span());
+    return result;
+  }
 
-    auto left_real = *left.real();
-    auto left_imag = *left.imag();
-    auto right_real = *right.real();
-    auto right_imag = *right.imag();
+  /*
+   * SIMD element-wise complex vector multiplication into `result`, over its
+   * padded elements. As the caller reads `result` back soon, it is never
+   * streamed.
+   */
+  static void cvmul(const ConstSplitSpan left, const ConstSplitSpan right,
+                    const SplitSpan result) {
+    cvmul(left.padded_real().data(), left.padded_imag().data(),
+          right.padded_real().data(), right.padded_imag().data(),
+          result.padded_real().data(), result.padded_imag().data(),
+          result.padded_size());
+  }
 
+  /*
+   * SIMD element-wise complex vector multiplication into the caller's
+   * buffers. The pointers must be 64-byte aligned, as for a `ComplexVectSplit`
+   * or a `ScratchArena` buffer. As such buffers are read back soon, they are
+   * never streamed.
+   */
+  static void cvmul(const __complex_precision *left_real,
+                    const __complex_precision *left_imag,
+                    const __complex_precision *right_real,
+                    const __complex_precision *right_imag,
+                    __complex_precision *result_real,
+                    __complex_precision *result_imag, const size_t length) {
+    // Considering the formula (a + bi)(c + di) = (ac - bd) + i(ad + bc):
 #ifdef __APPLE__
-    vDSP_vmul(left_real.data(), 1, right_real.data(), 1, ac_vect.data(), 1,
-              ac_vect.size());
-    vDSP_vmul(left_imag.data(), 1, right_imag.data(), 1, bd_vect.data(), 1,
-              bd_vect.size());
-    vDSP_vmul(left_real.data(), 1, right_imag.data(), 1, ad_vect.data(), 1,
-              ad_vect.size());
-    vDSP_vmul(left_imag.data(), 1, right_real.data(), 1, bc_vect.data(), 1,
-              bc_vect.size());
-
-    vDSP_vsub(bd_vect.data(), 1, ac_vect.data(), 1, result_real.data(), 1,
-              result_real.size());
-    vDSP_vadd(ad_vect.data(), 1, bc_vect.data(), 1, result_imag.data(), 1,
-              result_imag.size());
+    ScratchArena::Scope scope;
+    auto &arena = ScratchArena::local();
+    auto *ac = arena.allocate(length);
+    auto *bd = arena.allocate(length);
+    auto *ad = arena.allocate(length);
+    auto *bc = arena.allocate(length);
+    vDSP_vmul(left_real, 1, right_real, 1, ac, 1, length);
+    vDSP_vmul(left_imag, 1, right_imag, 1, bd, 1, length);
+    vDSP_vmul(left_real, 1, right_imag, 1, ad, 1, length);
+    vDSP_vmul(left_imag, 1, right_real, 1, bc, 1, length);
+
+    vDSP_vsub(bd, 1, ac, 1, result_real, 1, length);
+    vDSP_vadd(ad, 1, bc, 1, result_imag, 1, length);
 #else
-    vmul_avx(left_real.data(), right_real.data(), ac_vect.data(),
-             ac_vect.size());
-    vmul_avx(left_imag.data(), right_imag.data(), bd_vect.data(),
-             bd_vect.size());
-    vmul_avx(left_real.data(), right_imag.data(), ad_vect.data(),
-             ad_vect.size());
-    vmul_avx(left_imag.data(), right_real.data(), bc_vect.data(),
-             bc_vect.size());
-
-    vsub_avx(ac_vect.data(), bd_vect.data(), result_real.data(),
-             result_real.size());
-    vadd_avx(ad_vect.data(), bc_vect.data(), result_imag.data(),
-             result_imag.size());
+    backend().cvmul(left_real, left_imag, right_real, right_imag, result_real,
+                    result_imag, length, false);
 #endif
-
-    return std::make_unique<ComplexVectSplit>(result_real, result_imag);
   }
 
   /*
    * SIMD sum over each element of the vector.
    */
-  static Complex cvsve(const ComplexVectSplit &vect) {
+  static Complex cvsve(const ConstSplitSpan vect) {
+    return cvsve(vect.padded_real().data(), vect.padded_imag().data(),
+                 vect.padded_size());
+  }
+
+  /*
+   * SIMD sum over `length` elements of the caller's buffers. The pointers
+   * must be 64-byte aligned.
+   */
+  static Complex cvsve(const __complex_precision *real,
+                       const __complex_precision *imag, const size_t length) {
     __complex_precision result_real = 0;
     __complex_precision result_imag = 0;
-    auto vect_size = vect.size();
 
 #ifdef __APPLE__
-    vDSP_sve(vect.real()->data(), 1, &result_real, vect_size);
-    vDSP_sve(vect.imag()->data(), 1, &result_imag, vect_size);
+    vDSP_sve(real, 1, &result_real, length);
+    vDSP_sve(imag, 1, &result_imag, length);
 #else
-    result_real = hsum_avx(vect.real()->data(), vect_size);
-    result_imag = hsum_avx(vect.imag()->data(), vect_size);
+    result_real = backend().vsum(real, length);
+    result_imag = backend().vsum(imag, length);
 #endif
 
     return Complex(result_real, result_imag);
@@ -100,204 +144,555 @@ public:
   /*
    * SIMD element-wise sum of two vectors.
    */
-  static std::unique_ptr<ComplexVectSplit>
-  cvadd(const ComplexVectSplit &left, const ComplexVectSplit &right) {
-    std::vector<__complex_precision> result_real(left.size()),
-        result_imag(left.size());
-
-#ifdef __APPLE__
-    vDSP_vadd(left.real()->data(), 1, right.real()->data(), 1,
-              result_real.data(), 1, result_real.size());
-    vDSP_vadd(left.imag()->data(), 1, right.imag()->data(), 1,
-              result_imag.data(), 1, result_imag.size());
-#else
-    vadd_avx(left.real()->data(), right.real()->data(), result_real.data(),
-             result_real.size());
-    vadd_avx(left.imag()->data(), right.imag()->data(), result_imag.data(),
-             result_imag.size());
-#endif
+  static std::unique_ptr<ComplexVectSplit> cvadd(const ConstSplitSpan left,
+                                                 const ConstSplitSpan right) {
+    auto result = std::make_unique<ComplexVectSplit>(left.size());
+    add_or_sub<false>(left, right, result->span(),
+                      result->padded_size() >= streaming_min_elements);
+    return result;
+  }
 
-    return std::make_unique<ComplexVectSplit>(result_real, result_imag);
+  /*
+   * SIMD element-wise sum of two vectors into `result`, over its padded
+   * elements.
+   */
+  static void cvadd(const ConstSplitSpan left, const ConstSplitSpan right,
+                    const SplitSpan result) {
+    add_or_sub<false>(left, right, result, false);
   }
 
   /*
    * SIMD element-wise subtraction of two vectors.
    */
-  static std::unique_ptr<ComplexVectSplit>
-  cvsub(const ComplexVectSplit &left, const ComplexVectSplit &right) {
-    std::vector<__complex_precision> result_real(left.size()),
-        result_imag(right.size());
-
-#ifdef __APPLE__
-    vDSP_vsub(right.real()->data(), 1, left.real()->data(), 1,
-              result_real.data(), 1, result_real.size());
-    vDSP_vsub(right.imag()->data(), 1, left.imag()->data(), 1,
-              result_imag.data(), 1, result_imag.size());
-#else
-    vsub_avx(left.real()->data(), right.real()->data(), result_real.data(),
-             result_real.size());
-    vsub_avx(left.imag()->data(), right.imag()->data(), result_imag.data(),
-             result_imag.size());
-#endif
+  static std::unique_ptr<ComplexVectSplit> cvsub(const ConstSplitSpan left,
+                                                 const ConstSplitSpan right) {
+    auto result = std::make_unique<ComplexVectSplit>(left.size());
+    add_or_sub<true>(left, right, result->span(),
+                     result->padded_size() >= streaming_min_elements);
+    return result;
+  }
 
-    return std::make_unique<ComplexVectSplit>(result_real, result_imag);
+  /*
+   * SIMD element-wise subtraction of two vectors into `result`, over its
+   * padded elements.
+   */
+  static void cvsub(const ConstSplitSpan left, const ConstSplitSpan right,
+                    const SplitSpan result) {
+    add_or_sub<true>(left, right, result, false);
   }
 
   /*
    * SIMD scalar product.
    */
-  static std::unique_ptr<ComplexVectSplit> cvsmul(const ComplexVectSplit &vect,
+  static std::unique_ptr<ComplexVectSplit> cvsmul(const ConstSplitSpan vect,
                                                   const Complex &k) {
-    auto vect_real = *vect.real();
-    auto vect_imag = *vect.imag();
+    auto result = std::make_unique<ComplexVectSplit>(vect.size());
+    const auto length = result->padded_size();
+#ifndef __APPLE__
+    if (length >= streaming_min_elements) {
+      backend().cvsmul(vect.padded_real().data(), vect.padded_imag().data(),
+                       k, result->real_data(), result->imag_data(), length,
+                       true);
+      return result;
+    }
+#endif
+    cvsmul(vect, k, result->span());
+    return result;
+  }
+
+  /*
+   * SIMD scalar product into `result`, over its padded elements. It is never
+   * streamed.
+   */
+  static void cvsmul(const ConstSplitSpan vect, const Complex &k,
+                     const SplitSpan result) {
+    cvsmul(vect.padded_real().data(), vect.padded_imag().data(), k,
+           result.padded_real().data(), result.padded_imag().data(),
+           result.padded_size());
+  }
+
+  /*
+   * SIMD scalar product into the caller's buffers. The pointers must be
+   * 64-byte aligned. The buffers are never streamed.
+   */
+  static void cvsmul(const __complex_precision *real,
+                     const __complex_precision *imag, const Complex &k,
+                     __complex_precision *result_real,
+                     __complex_precision *result_imag, const size_t length) {
+#ifdef __APPLE__
     auto k_real = static_cast<__complex_precision>(k.real());
     auto k_imag = static_cast<__complex_precision>(k.imag());
 
     // Considering the formula (a + bi)(c + di) = (ac - bd) + i(ad + bc):
-    std::vector<__complex_precision> vect_ac(vect.size()), vect_bd(vect.size()),
-        vect_ad(vect.size()), vect_bc(vect.size());
+    ScratchArena::Scope scope;
+    auto &arena = ScratchArena::local();
+    auto *ac = arena.allocate(length);
+    auto *bd = arena.allocate(length);
+    auto *ad = arena.allocate(length);
+    auto *bc = arena.allocate(length);
+    vDSP_vsmul(real, 1, &k_real, ac, 1, length);
+    vDSP_vsmul(imag, 1, &k_imag, bd, 1, length);
+    vDSP_vsmul(real, 1, &k_imag, ad, 1, length);
+    vDSP_vsmul(imag, 1, &k_real, bc, 1, length);
+
+    vDSP_vsub(bd, 1, ac, 1, result_real, 1, length);
+    vDSP_vadd(ad, 1, bc, 1, result_imag, 1, length);
+#else
+    backend().cvsmul(real, imag, k, result_real, result_imag, length, false);
+#endif
+  }
+
+  /*
+   * Fused complex BLAS-1 kernels, each a single pass over the padded
+   * elements of `x` with FMA and several independent accumulators. `y` must
+   * be at least as long as `x`.
+   */
+
+  /*
+   * @return the unconjugated dot product, sum(x_i * y_i).
+   */
+  static Complex cdotu(ConstSplitSpan x, ConstSplitSpan y);
 
-    std::vector<__complex_precision> result_real(vect.size()),
-        result_imag(vect.size());
+  /*
+   * @return the conjugated dot product, sum(conj(x_i) * y_i).
+   */
+  static Complex cdotc(ConstSplitSpan x, ConstSplitSpan y);
+
+  /*
+   * y <- a * x + y
+   */
+  static void caxpy(Complex a, ConstSplitSpan x, SplitSpan y);
+
+  /*
+   * x <- a * x
+   */
+  static void cscal(Complex a, SplitSpan x);
+
+  /*
+   * @return the Euclidean norm, sqrt(sum(|x_i|^2)).
+   */
+  static __complex_precision cnrm2(ConstSplitSpan x);
 
+  /*
+   * In-place application of the 2x2 matrix `u` (row-major) to qubit `target`
+   * of a split state vector of `length` amplitudes, i.e. to every amplitude
+   * pair (i, i | 1 << target). Only the pairs whose bits in the `controls`
+   * mask are all set are touched, the others are skipped altogether.
+   * `real` and `imag` must be 64-byte aligned.
+   *
+   * This and the other gate kernels below also apply to a slice of a larger
+   * state, of a power-of-two `length`: a target at or beyond `length` stands
+   * for a bit clear on the whole slice, whose partners lie 2^target further
+   * on. Controls must lie within the slice.
+   */
+  template <typename T>
+  static void gate_1q(T *real, T *imag, const size_t length,
+                      const size_t target, const size_t controls,
+                      const std::array<std::complex<T>, 4> &u) {
 #ifdef __APPLE__
-    vDSP_vsmul(vect_real.data(), 1, &k_real, vect_ac.data(), 1, vect_ac.size());
-    vDSP_vsmul(vect_imag.data(), 1, &k_imag, vect_bd.data(), 1, vect_bd.size());
-    vDSP_vsmul(vect_real.data(), 1, &k_imag, vect_ad.data(), 1, vect_ad.size());
-    vDSP_vsmul(vect_imag.data(), 1, &k_real, vect_bc.data(), 1, vect_bc.size());
-
-    vDSP_vsub(vect_bd.data(), 1, vect_ac.data(), 1, result_real.data(), 1,
-              result_real.size());
-    vDSP_vadd(vect_ad.data(), 1, vect_bc.data(), 1, result_imag.data(), 1,
-              result_imag.size());
+    gate_1q_scalar(real, imag, length, target, controls, u);
 #else
-    vsmul_avx(vect_real.data(), k_real, vect_ac.data(), vect_ac.size());
-    vsmul_avx(vect_imag.data(), k_imag, vect_bd.data(), vect_bd.size());
-    vsmul_avx(vect_real.data(), k_imag, vect_ad.data(), vect_ad.size());
-    vsmul_avx(vect_imag.data(), k_real, vect_bc.data(), vect_bc.size());
-
-    vsub_avx(vect_ac.data(), vect_bd.data(), result_real.data(),
-             result_real.size());
-    vadd_avx(vect_ad.data(), vect_bc.data(), result_imag.data(),
-             result_imag.size());
+    backend<T>().gate_1q(real, imag, length, target, controls, u);
 #endif
+  }
 
-    return std::make_unique<ComplexVectSplit>(result_real, result_imag);
+  /*
+   * In-place application of the diagonal gate diag(d0, d1) to qubit `target`
+   * of a split state vector of `length` amplitudes, touching only the
+   * amplitudes whose bits in the `controls` mask are all set. When `d0` is 1,
+   * the amplitudes with the target bit clear are skipped as well, so that a
+   * controlled phase is a single masked sweep.
+   * `real` and `imag` must be 64-byte aligned.
+   */
+  template <typename T>
+  static void gate_diagonal(T *real, T *imag, const size_t length,
+                            const size_t target, const size_t controls,
+                            const std::complex<T> &d0,
+                            const std::complex<T> &d1) {
+#ifdef __APPLE__
+    gate_diagonal_scalar(real, imag, length, target, controls, d0, d1);
+#else
+    backend<T>().gate_diagonal(real, imag, length, target, controls, d0, d1);
+#endif
   }
-#ifndef __APPLE__
-private:
+
   /*
-   * SIMD AVX vector multiplication.
-   */
-  static void vmul_avx(const __complex_precision *left,
-                       const __complex_precision *right,
-                       __complex_precision *result, size_t length) {
-    size_t i = 0;
-    size_t element_size = sizeof(__complex_precision) * 8;
-    size_t elements_per_block = 256 / element_size;
-    for (; i + elements_per_block <= length; i += elements_per_block) {
-      __m256 vec_left = _mm256_loadu_ps(left + i);
-      __m256 vec_right = _mm256_loadu_ps(right + i);
-      __m256 vec_res = _mm256_mul_ps(vec_left, vec_right);
-      _mm256_storeu_ps(result + i, vec_res);
-    }
-    for (; i < length; i++) {
-      result[i] = left[i] * right[i];
+   * In-place Pauli-X on qubit `target` of a split state vector of `length`
+   * amplitudes, as pure data movement: every pair (i, i | 1 << target) whose
+   * bits in the `controls` mask are all set is swapped. With controls this is
+   * CNOT, Toffoli and their multi-controlled variants.
+   * `real` and `imag` must be 64-byte aligned.
+   */
+  template <typename T>
+  static void permute_flip(T *real, T *imag, const size_t length,
+                           const size_t target, const size_t controls) {
+#ifdef __APPLE__
+    permute_flip_scalar(real, imag, length, target, controls);
+#else
+    backend<T>().permute_flip(real, imag, length, target, controls);
+#endif
+  }
+
+  /*
+   * In-place SWAP of qubits `a` and `b` of a split state vector of `length`
+   * amplitudes, as pure data movement, where all the bits in the `controls`
+   * mask are set (Fredkin and its variants, when controlled).
+   * `real` and `imag` must be 64-byte aligned.
+   */
+  template <typename T>
+  static void permute_swap(T *real, T *imag, const size_t length, size_t a,
+                           size_t b, const size_t controls) {
+    if (a > b) {
+      std::swap(a, b);
     }
+#ifdef __APPLE__
+    permute_swap_scalar(real, imag, length, a, b, controls);
+#else
+    backend<T>().permute_swap(real, imag, length, a, b, controls);
+#endif
   }
 
   /*
-   * SIMD AVX scalar-vector multiplication.
+   * In-place application of a k-qubit `gate` to the qubits in `qubits` of a
+   * split state vector of `length` amplitudes, where all the bits in the
+   * `controls` mask are set, in a single pass over the state. The gate is
+   * 2^k x 2^k, row-major and split in `gate_real`/`gate_imag`, with rows
+   * `gate_stride` elements apart, so that the padded rows of a
+   * `ComplexVectMatrix` can be passed as they are; bit `q` of a local basis
+   * index stands for qubit `qubits[q]`.
+   * `real` and `imag` must be 64-byte aligned.
    */
-  static void vsmul_avx(const __complex_precision *vect,
-                        const __complex_precision &scalar,
-                        __complex_precision *result, size_t length) {
-    __m256 scalar_vec = _mm256_set1_ps(scalar);
+  template <typename T>
+  static void gate_kq(T *real, T *imag, const size_t length,
+                      const std::vector<size_t> &qubits, const size_t controls,
+                      const T *gate_real, const T *gate_imag,
+                      const size_t gate_stride) {
+#ifdef __APPLE__
+    gate_kq_scalar(real, imag, length, qubits, controls, gate_real, gate_imag,
+                   gate_stride);
+#else
+    backend<T>().gate_kq(real, imag, length, qubits, controls, gate_real,
+                         gate_imag, gate_stride);
+#endif
+  }
 
-    size_t i = 0;
-    size_t element_size = sizeof(__complex_precision) * 8;
-    size_t elements_per_block = 256 / element_size;
-    for (; i + elements_per_block <= length; i += elements_per_block) {
-      __m256 vec = _mm256_loadu_ps(vect + i);
-      __m256 res = _mm256_mul_ps(vec, scalar_vec);
-      _mm256_storeu_ps(result + i, res);
-    }
-    for (; i < length; i++) {
-      result[i] = vect[i] * scalar;
-    }
+  /*
+   * @return the sum of the `length` elements of a leaf of a `Reduction`, in
+   * double precision: element `i` is accumulated into lane
+   * `i % Reduction::lanes`, and the lanes are added pairwise, so that the
+   * result only depends on the elements. The terms of this and the other leaf
+   * sums below are computed without FMA, so that every instruction set rounds
+   * them alike. The pointers need not be aligned.
+   */
+  template <typename T>
+  static double leaf_sum(const T *data, const size_t length) {
+#ifdef __APPLE__
+    return leaf_scalar<double>(length, [data](const size_t i) {
+      return static_cast<double>(data[i]);
+    });
+#else
+    return backend<T>().leaf_sum(data, length);
+#endif
+  }
+
+  template <typename T>
+  static std::complex<double> leaf_csum(const T *real, const T *imag,
+                                        const size_t length) {
+#ifdef __APPLE__
+    return leaf_scalar<std::complex<double>>(length, [=](const size_t i) {
+      return std::complex<double>(real[i], imag[i]);
+    });
+#else
+    return backend<T>().leaf_csum(real, imag, length);
+#endif
   }
 
   /*
-   * SIMD AVX vector subtraction, performed left - right.
+   * @return the leaf sum of conj(x_i) y_i.
    */
-  static void vsub_avx(const __complex_precision *left,
-                       const __complex_precision *right,
-                       __complex_precision *result, size_t length) {
-    size_t i = 0;
-    size_t element_size = sizeof(__complex_precision) * 8;
-    size_t elements_per_block = 256 / element_size;
-    for (; i + elements_per_block <= length; i += elements_per_block) {
-      __m256 vec_left = _mm256_loadu_ps(left + i);
-      __m256 vec_right = _mm256_loadu_ps(right + i);
-      __m256 vec_res = _mm256_sub_ps(vec_left, vec_right);
-      _mm256_storeu_ps(result + i, vec_res);
-    }
-    for (; i < length; i++) {
-      result[i] = left[i] - right[i];
+  template <typename T>
+  static std::complex<double> leaf_cdotc(const T *x_real, const T *x_imag,
+                                         const T *y_real, const T *y_imag,
+                                         const size_t length) {
+#ifdef __APPLE__
+    // (a - bi)(c + di) = (ac + bd) + i(ad - bc)
+    return leaf_scalar<std::complex<double>>(length, [=](const size_t i) {
+      const double a = x_real[i], b = x_imag[i];
+      const double c = y_real[i], d = y_imag[i];
+      return std::complex<double>(a * c + b * d, a * d - b * c);
+    });
+#else
+    return backend<T>().leaf_cdotc(x_real, x_imag, y_real, y_imag, length);
+#endif
+  }
+
+  /*
+   * @return the leaf sum of |x_i|^2 over the `i` where the bits in `mask` of
+   * `first + i` equal those of `value`. `first` must be a multiple of
+   * `Reduction::lanes`.
+   */
+  template <typename T>
+  static double leaf_mass(const T *real, const T *imag, const size_t length,
+                          const size_t first, const size_t mask,
+                          const size_t value) {
+#ifdef __APPLE__
+    const auto selected = value & mask;
+    return leaf_scalar<double>(length, [=](const size_t i) {
+      const double r = real[i], m = imag[i];
+      return ((first + i) & mask) == selected ? r * r + m * m : 0.0;
+    });
+#else
+    return backend<T>().leaf_mass(real, imag, length, first, mask, value);
+#endif
+  }
+
+  /*
+   * Adds the `Reduction::lanes` lane sums of a leaf pairwise, neighbours
+   * first.
+   */
+  template <typename R>
+  static R pairwise_lanes(const R (&lanes)[Reduction::lanes]) {
+    static_assert(std::has_single_bit(Reduction::lanes));
+    R sums[Reduction::lanes];
+    std::copy(lanes, lanes + Reduction::lanes, sums);
+    for (size_t count = Reduction::lanes; count > 1; count /= 2) {
+      for (size_t l = 0; l < count / 2; l++) {
+        sums[l] = sums[2 * l] + sums[2 * l + 1];
+      }
     }
+    return sums[0];
   }
 
   /*
-   * SIMD AVX vector addition.
+   * Spreads the bits of `i` over the positions not set in `fixed`, leaving
+   * zeros at the fixed positions. Iterating `i` over [0, length >> |fixed|)
+   * enumerates exactly the indices with all the `fixed` bits clear.
    */
-  static void vadd_avx(const __complex_precision *left,
-                       const __complex_precision *right,
-                       __complex_precision *result, size_t length) {
-    size_t i = 0;
-    size_t element_size = sizeof(__complex_precision) * 8;
-    size_t elements_per_block = 256 / element_size;
-    for (; i + elements_per_block <= length; i += elements_per_block) {
-      __m256 vec_left = _mm256_loadu_ps(left + i);
-      __m256 vec_right = _mm256_loadu_ps(right + i);
-      __m256 vec_res = _mm256_add_ps(vec_left, vec_right);
-      _mm256_storeu_ps(result + i, vec_res);
+  static inline size_t insert_zero_bits(size_t i, size_t fixed) {
+    while (fixed != 0) {
+      const size_t low_mask = (fixed & (~fixed + 1)) - 1;
+      i = ((i & ~low_mask) << 1) | (i & low_mask);
+      fixed &= fixed - 1;
     }
-    for (; i < length; i++) {
-      result[i] = left[i] + right[i];
+    return i;
+  }
+
+  /*
+   * Index offsets of the 2^k amplitudes of a group, relative to the group's
+   * base index. The last offset has every target bit set.
+   */
+  static std::vector<size_t> local_offsets(const std::vector<size_t> &qubits) {
+    std::vector<size_t> offsets(size_t(1) << qubits.size(), 0);
+    for (size_t l = 0; l < offsets.size(); l++) {
+      for (size_t q = 0; q < qubits.size(); q++) {
+        if ((l >> q) & 1) {
+          offsets[l] |= size_t(1) << qubits[q];
+        }
+      }
     }
+    return offsets;
   }
 
+#ifndef __APPLE__
+  /*
+   * @return the instruction set the kernels run on. It is chosen on first
+   * use: the one named by the HILBERT_ISA environment variable if set (see
+   * `parse_isa`), else the widest one that is both built (see the
+   * HILBERT_AVX512 option) and supported by the CPU.
+   * @throws std::invalid_argument if HILBERT_ISA names an unknown instruction
+   * set, or one that is not built or not supported by the CPU.
+   */
+  [[nodiscard]] static Isa isa();
+
   /*
-   * SIMD AVX horizontal sum.
+   * Runs the kernels on `isa` from now on, in every thread.
+   * @throws std::invalid_argument if `isa` is not built or not supported by
+   * the CPU.
    */
-  static __complex_precision hsum_avx(const __complex_precision *vect,
-                                      size_t length) {
-    size_t i = 0;
-    size_t element_size = sizeof(__complex_precision) * 8;
-    size_t elements_per_block = 256 / element_size;
-    __m256 vsum = _mm256_setzero_ps();
+  static void set_isa(Isa isa);
 
-    for (; i + elements_per_block <= length; i += elements_per_block) {
-      __m256 v = _mm256_loadu_ps(vect + i);
-      vsum = _mm256_add_ps(vsum, v);
+  /*
+   * @return whether `isa` is both built and supported by the CPU.
+   */
+  [[nodiscard]] static bool is_supported(Isa isa);
+
+  /*
+   * @return the instruction set named `name`: "scalar", "sse", "avx2" or
+   * "avx512".
+   * @throws std::invalid_argument if `name` is none of them.
+   */
+  [[nodiscard]] static Isa parse_isa(std::string_view name);
+
+  /*
+   * @return the name of `isa`, as accepted by `parse_isa`.
+   */
+  [[nodiscard]] static std::string_view isa_name(Isa isa);
+
+  /*
+   * @return the kernels of the selected instruction set, on `T` amplitudes.
+   */
+  template <typename T = __complex_precision>
+  [[nodiscard]] static const SimdBackend<T> &backend();
+#endif
+
+  // The portable kernels are public, so that the tests build and check them
+  // on every platform, not only where no vectorised kernel is available.
+
+  /*
+   * Portable single-qubit gate, used where no vectorised kernel is available.
+   */
+  template <typename T>
+  static void gate_1q_scalar(T *real, T *imag, const size_t length,
+                             const size_t target, const size_t controls,
+                             const std::array<std::complex<T>, 4> &u) {
+    const size_t stride = size_t(1) << target;
+    const size_t fixed = (stride | controls) & (length - 1);
+    const size_t count = length >> std::popcount(fixed);
+    for (size_t j = 0; j < count; j++) {
+      const size_t i = insert_zero_bits(j, fixed) | controls;
+      const std::complex<T> a(real[i], imag[i]);
+      const std::complex<T> b(real[i + stride], imag[i + stride]);
+      const auto na = u[0] * a + u[1] * b;
+      const auto nb = u[2] * a + u[3] * b;
+      real[i] = na.real();
+      imag[i] = na.imag();
+      real[i + stride] = nb.real();
+      imag[i + stride] = nb.imag();
     }
+  }
 
-    __m128 vlow = _mm256_castps256_ps128(vsum);
-    __m128 vhigh = _mm256_extractf128_ps(vsum, 1);
-    __m128 vsum128 = _mm_add_ps(vlow, vhigh);
+  /*
+   * Portable leaf sum of `term(i)`, used where no vectorised kernel is
+   * available.
+   */
+  template <typename R, typename F>
+  static R leaf_scalar(const size_t length, const F &term) {
+    R lanes[Reduction::lanes] = {};
+    for (size_t i = 0; i < length; i++) {
+      lanes[i % Reduction::lanes] += term(i);
+    }
+    return pairwise_lanes(lanes);
+  }
 
-    vsum128 = _mm_hadd_ps(vsum128, vsum128);
-    vsum128 = _mm_hadd_ps(vsum128, vsum128);
+  /*
+   * Portable k-qubit gate, used where no vectorised kernel is available.
+   */
+  template <typename T>
+  static void gate_kq_scalar(T *real, T *imag, const size_t length,
+                             const std::vector<size_t> &qubits,
+                             const size_t controls, const T *gate_real,
+                             const T *gate_imag, const size_t gate_stride) {
+    const auto offsets = local_offsets(qubits);
+    const size_t dim = offsets.size();
+    const size_t fixed = (offsets.back() | controls) & (length - 1);
+    const size_t count = length >> std::popcount(fixed);
+    std::vector<std::complex<T>> in(dim);
+    for (size_t j = 0; j < count; j++) {
+      const size_t base = insert_zero_bits(j, fixed) | controls;
+      for (size_t c = 0; c < dim; c++) {
+        in[c] = {real[base | offsets[c]], imag[base | offsets[c]]};
+      }
+      for (size_t r = 0; r < dim; r++) {
+        std::complex<T> out(0);
+        for (size_t c = 0; c < dim; c++) {
+          const auto k = r * gate_stride + c;
+          out += std::complex<T>(gate_real[k], gate_imag[k]) * in[c];
+        }
+        real[base | offsets[r]] = out.real();
+        imag[base | offsets[r]] = out.imag();
+      }
+    }
+  }
 
-    float sum = _mm_cvtss_f32(vsum128);
+  /*
+   * Portable Pauli-X, used where no vectorised kernel is available.
+   */
+  template <typename T>
+  static void permute_flip_scalar(T *real, T *imag, const size_t length,
+                                  const size_t target, const size_t controls) {
+    const size_t stride = size_t(1) << target;
+    const size_t fixed = (stride | controls) & (length - 1);
+    const size_t count = length >> std::popcount(fixed);
+    for (size_t j = 0; j < count; j++) {
+      const size_t i = insert_zero_bits(j, fixed) | controls;
+      std::swap(real[i], real[i + stride]);
+      std::swap(imag[i], imag[i + stride]);
+    }
+  }
 
-    for (; i < length; ++i) {
-      sum += vect[i];
+  /*
+   * Portable SWAP, used where no vectorised kernel is available.
+   */
+  template <typename T>
+  static void permute_swap_scalar(T *real, T *imag, const size_t length,
+                                  const size_t a, const size_t b,
+                                  const size_t controls) {
+    const size_t bit_a = size_t(1) << a;
+    const size_t bit_b = size_t(1) << b;
+    const size_t fixed = (bit_a | bit_b | controls) & (length - 1);
+    const size_t count = length >> std::popcount(fixed);
+    for (size_t j = 0; j < count; j++) {
+      const size_t i = insert_zero_bits(j, fixed) | controls;
+      std::swap(real[i | bit_a], real[i | bit_b]);
+      std::swap(imag[i | bit_a], imag[i | bit_b]);
     }
+  }
 
-    return sum;
+  /*
+   * Portable diagonal gate, used where no vectorised kernel is available.
+   */
+  template <typename T>
+  static void gate_diagonal_scalar(T *real, T *imag, const size_t length,
+                                   const size_t target, const size_t controls,
+                                   const std::complex<T> &d0,
+                                   const std::complex<T> &d1) {
+    const size_t stride = size_t(1) << target;
+    const size_t fixed = (stride | controls) & (length - 1);
+    const size_t count = length >> std::popcount(fixed);
+    const bool touch_clear = d0 != std::complex<T>(1);
+    for (size_t j = 0; j < count; j++) {
+      const size_t i = insert_zero_bits(j, fixed) | controls;
+      if (touch_clear) {
+        const auto a = d0 * std::complex<T>(real[i], imag[i]);
+        real[i] = a.real();
+        imag[i] = a.imag();
+      }
+      const auto b = d1 * std::complex<T>(real[i + stride], imag[i + stride]);
+      real[i + stride] = b.real();
+      imag[i + stride] = b.imag();
+    }
   }
+
+private:
+  /*
+   * Element-wise `left + right`, or `left - right` when `Sub` is set, into
+   * `result`, over its padded elements.
+   */
+  template <bool Sub>
+  static void add_or_sub(const ConstSplitSpan left, const ConstSplitSpan right,
+                         const SplitSpan result, const bool stream) {
+    const auto length = result.padded_size();
+    const auto *left_real = left.padded_real().data();
+    const auto *left_imag = left.padded_imag().data();
+    const auto *right_real = right.padded_real().data();
+    const auto *right_imag = right.padded_imag().data();
+    auto *result_real = result.padded_real().data();
+    auto *result_imag = result.padded_imag().data();
+
+#ifdef __APPLE__
+    if constexpr (Sub) {
+      vDSP_vsub(right_real, 1, left_real, 1, result_real, 1, length);
+      vDSP_vsub(right_imag, 1, left_imag, 1, result_imag, 1, length);
+    } else {
+      vDSP_vadd(left_real, 1, right_real, 1, result_real, 1, length);
+      vDSP_vadd(left_imag, 1, right_imag, 1, result_imag, 1, length);
+    }
+#else
+    const auto kernel = Sub ? backend().vsub : backend().vadd;
+    kernel(left_real, right_real, result_real, length, stream);
+    kernel(left_imag, right_imag, result_imag, length, stream);
 #endif
+  }
 };
 
 #endif // !SIMD_H
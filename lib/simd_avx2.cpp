@@ -0,0 +1,256 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "hilbert_namespace.h"
+#include "scratch_arena.h"
+#include "simd.h"
+#include "simd_backend.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <immintrin.h>
+#include <vector>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), \
+                             apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "simd_kernels.h"
+
+/*
+ * The AVX2 policies of `SimdKernels`, with FMA. A lane mask is an integer
+ * register with every bit of the selected lanes set.
+ */
+template <typename T> struct Avx2;
+
+template <> struct Avx2<double>;
+
+// 8 floats per register.
+template <> struct Avx2<float> {
+  using value = float;
+  using reg = __m256;
+  using mask = __m256i;
+  using index = __m256i;
+
+  static constexpr Isa isa = Isa::Avx2;
+  static constexpr size_t width = 8;
+
+  static reg load(const value *p) { return _mm256_load_ps(p); }
+
+  static reg load(const value *p, const mask lanes) {
+    return _mm256_maskload_ps(p, lanes);
+  }
+
+  static void store(value *p, const reg v) { _mm256_store_ps(p, v); }
+
+  static void store(value *p, const reg v, const mask lanes) {
+    _mm256_maskstore_ps(p, lanes, v);
+  }
+
+  static void stream(value *p, const reg v) { _mm256_stream_ps(p, v); }
+
+  static void fence() { _mm_sfence(); }
+
+  // The first `n` lanes.
+  static mask tail(const size_t n) {
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)),
+                              _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  }
+
+  static mask lanes(const std::array<bool, width> &selected) {
+    alignas(32) int bits[width];
+    for (size_t l = 0; l < width; l++) {
+      bits[l] = selected[l] ? -1 : 0;
+    }
+    return _mm256_load_si256(reinterpret_cast<const __m256i *>(bits));
+  }
+
+  static index permutation(const std::array<int, width> &idx) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(idx.data()));
+  }
+
+  static reg zero() { return _mm256_setzero_ps(); }
+
+  static reg set1(const value x) { return _mm256_set1_ps(x); }
+
+  static reg add(const reg a, const reg b) { return _mm256_add_ps(a, b); }
+
+  static reg sub(const reg a, const reg b) { return _mm256_sub_ps(a, b); }
+
+  static reg mul(const reg a, const reg b) { return _mm256_mul_ps(a, b); }
+
+  // a * b + c
+  static reg fmadd(const reg a, const reg b, const reg c) {
+    return _mm256_fmadd_ps(a, b, c);
+  }
+
+  // c - a * b
+  static reg fnmadd(const reg a, const reg b, const reg c) {
+    return _mm256_fnmadd_ps(a, b, c);
+  }
+
+  // a * b - c
+  static reg fmsub(const reg a, const reg b, const reg c) {
+    return _mm256_fmsub_ps(a, b, c);
+  }
+
+  static reg neg(const reg v) {
+    return _mm256_xor_ps(v, _mm256_set1_ps(-0.0f));
+  }
+
+  // `b` on the selected lanes, `a` on the others.
+  static reg blend(const mask lanes, const reg a, const reg b) {
+    return _mm256_blendv_ps(a, b, _mm256_castsi256_ps(lanes));
+  }
+
+  static reg permute(const reg v, const index idx) {
+    return _mm256_permutevar8x32_ps(v, idx);
+  }
+
+  static value reduce(const reg v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v),
+                            _mm256_extractf128_ps(v, 1));
+    sum = _mm_hadd_ps(sum, sum);
+    sum = _mm_hadd_ps(sum, sum);
+    return _mm_cvtss_f32(sum);
+  }
+
+  // The double precision policy, for the reductions, and `wide::width` floats
+  // from `p`, which need not be aligned, converted to doubles.
+  using wide = Avx2<double>;
+
+  static __m256d widen(const value *p) {
+    return _mm256_cvtps_pd(_mm_loadu_ps(p));
+  }
+};
+
+// 4 doubles per register. Lanes are permuted as pairs of 32-bit halves.
+template <> struct Avx2<double> {
+  using value = double;
+  using reg = __m256d;
+  using mask = __m256i;
+  using index = __m256i;
+
+  static constexpr Isa isa = Isa::Avx2;
+  static constexpr size_t width = 4;
+
+  static reg load(const value *p) { return _mm256_load_pd(p); }
+
+  static reg load(const value *p, const mask lanes) {
+    return _mm256_maskload_pd(p, lanes);
+  }
+
+  static void store(value *p, const reg v) { _mm256_store_pd(p, v); }
+
+  static void store(value *p, const reg v, const mask lanes) {
+    _mm256_maskstore_pd(p, lanes, v);
+  }
+
+  static void stream(value *p, const reg v) { _mm256_stream_pd(p, v); }
+
+  static void fence() { _mm_sfence(); }
+
+  // The first `n` lanes.
+  static mask tail(const size_t n) {
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(n)),
+                              _mm256_setr_epi64x(0, 1, 2, 3));
+  }
+
+  static mask lanes(const std::array<bool, width> &selected) {
+    alignas(32) long long bits[width];
+    for (size_t l = 0; l < width; l++) {
+      bits[l] = selected[l] ? -1 : 0;
+    }
+    return _mm256_load_si256(reinterpret_cast<const __m256i *>(bits));
+  }
+
+  static index permutation(const std::array<int, width> &idx) {
+    alignas(32) int halves[2 * width];
+    for (size_t l = 0; l < width; l++) {
+      halves[2 * l] = 2 * idx[l];
+      halves[2 * l + 1] = 2 * idx[l] + 1;
+    }
+    return _mm256_load_si256(reinterpret_cast<const __m256i *>(halves));
+  }
+
+  static reg zero() { return _mm256_setzero_pd(); }
+
+  static reg set1(const value x) { return _mm256_set1_pd(x); }
+
+  static reg add(const reg a, const reg b) { return _mm256_add_pd(a, b); }
+
+  static reg sub(const reg a, const reg b) { return _mm256_sub_pd(a, b); }
+
+  static reg mul(const reg a, const reg b) { return _mm256_mul_pd(a, b); }
+
+  // a * b + c
+  static reg fmadd(const reg a, const reg b, const reg c) {
+    return _mm256_fmadd_pd(a, b, c);
+  }
+
+  // c - a * b
+  static reg fnmadd(const reg a, const reg b, const reg c) {
+    return _mm256_fnmadd_pd(a, b, c);
+  }
+
+  // a * b - c
+  static reg fmsub(const reg a, const reg b, const reg c) {
+    return _mm256_fmsub_pd(a, b, c);
+  }
+
+  static reg neg(const reg v) { return _mm256_xor_pd(v, _mm256_set1_pd(-0.0)); }
+
+  // `b` on the selected lanes, `a` on the others.
+  static reg blend(const mask lanes, const reg a, const reg b) {
+    return _mm256_blendv_pd(a, b, _mm256_castsi256_pd(lanes));
+  }
+
+  static reg permute(const reg v, const index idx) {
+    return _mm256_castps_pd(
+        _mm256_permutevar8x32_ps(_mm256_castpd_ps(v), idx));
+  }
+
+  static value reduce(const reg v) {
+    const __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v),
+                                   _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+  }
+
+  // The double precision policy, for the reductions, and `width` doubles from
+  // `p`, which need not be aligned.
+  using wide = Avx2<double>;
+
+  static reg widen(const value *p) { return _mm256_loadu_pd(p); }
+};
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+template <typename T> const SimdBackend<T> &avx2_backend() {
+  static const SimdBackend<T> backend = SimdKernels<Avx2<T>>::backend();
+  return backend;
+}
+
+template const SimdBackend<float> &avx2_backend();
+template const SimdBackend<double> &avx2_backend();
@@ -0,0 +1,238 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "hilbert_namespace.h"
+#include "scratch_arena.h"
+#include "simd.h"
+#include "simd_backend.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <immintrin.h>
+#include <vector>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f,avx512dq"))), \
+                             apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq")
+#endif
+
+#include "simd_kernels.h"
+
+/*
+ * The AVX-512 policies of `SimdKernels`, with lane masks in mask registers.
+ * The sign flip needs AVX-512DQ.
+ */
+template <typename T> struct Avx512;
+
+template <> struct Avx512<double>;
+
+// 16 floats per register.
+template <> struct Avx512<float> {
+  using value = float;
+  using reg = __m512;
+  using mask = __mmask16;
+  using index = __m512i;
+
+  static constexpr Isa isa = Isa::Avx512;
+  static constexpr size_t width = 16;
+
+  static reg load(const value *p) { return _mm512_load_ps(p); }
+
+  static reg load(const value *p, const mask lanes) {
+    return _mm512_maskz_load_ps(lanes, p);
+  }
+
+  static void store(value *p, const reg v) { _mm512_store_ps(p, v); }
+
+  static void store(value *p, const reg v, const mask lanes) {
+    _mm512_mask_store_ps(p, lanes, v);
+  }
+
+  static void stream(value *p, const reg v) { _mm512_stream_ps(p, v); }
+
+  static void fence() { _mm_sfence(); }
+
+  // The first `n` lanes.
+  static mask tail(const size_t n) { return static_cast<mask>((1u << n) - 1); }
+
+  static mask lanes(const std::array<bool, width> &selected) {
+    mask bits = 0;
+    for (size_t l = 0; l < width; l++) {
+      bits |= static_cast<mask>(selected[l] ? 1u << l : 0);
+    }
+    return bits;
+  }
+
+  static index permutation(const std::array<int, width> &idx) {
+    return _mm512_loadu_si512(idx.data());
+  }
+
+  static reg zero() { return _mm512_setzero_ps(); }
+
+  static reg set1(const value x) { return _mm512_set1_ps(x); }
+
+  static reg add(const reg a, const reg b) { return _mm512_add_ps(a, b); }
+
+  static reg sub(const reg a, const reg b) { return _mm512_sub_ps(a, b); }
+
+  static reg mul(const reg a, const reg b) { return _mm512_mul_ps(a, b); }
+
+  // a * b + c
+  static reg fmadd(const reg a, const reg b, const reg c) {
+    return _mm512_fmadd_ps(a, b, c);
+  }
+
+  // c - a * b
+  static reg fnmadd(const reg a, const reg b, const reg c) {
+    return _mm512_fnmadd_ps(a, b, c);
+  }
+
+  // a * b - c
+  static reg fmsub(const reg a, const reg b, const reg c) {
+    return _mm512_fmsub_ps(a, b, c);
+  }
+
+  static reg neg(const reg v) {
+    return _mm512_xor_ps(v, _mm512_set1_ps(-0.0f));
+  }
+
+  // `b` on the selected lanes, `a` on the others.
+  static reg blend(const mask lanes, const reg a, const reg b) {
+    return _mm512_mask_blend_ps(lanes, a, b);
+  }
+
+  static reg permute(const reg v, const index idx) {
+    return _mm512_permutexvar_ps(idx, v);
+  }
+
+  static value reduce(const reg v) { return _mm512_reduce_add_ps(v); }
+
+  // The double precision policy, for the reductions, and `wide::width` floats
+  // from `p`, which need not be aligned, converted to doubles.
+  using wide = Avx512<double>;
+
+  static __m512d widen(const value *p) {
+    return _mm512_cvtps_pd(_mm256_loadu_ps(p));
+  }
+};
+
+// 8 doubles per register.
+template <> struct Avx512<double> {
+  using value = double;
+  using reg = __m512d;
+  using mask = __mmask8;
+  using index = __m512i;
+
+  static constexpr Isa isa = Isa::Avx512;
+  static constexpr size_t width = 8;
+
+  static reg load(const value *p) { return _mm512_load_pd(p); }
+
+  static reg load(const value *p, const mask lanes) {
+    return _mm512_maskz_load_pd(lanes, p);
+  }
+
+  static void store(value *p, const reg v) { _mm512_store_pd(p, v); }
+
+  static void store(value *p, const reg v, const mask lanes) {
+    _mm512_mask_store_pd(p, lanes, v);
+  }
+
+  static void stream(value *p, const reg v) { _mm512_stream_pd(p, v); }
+
+  static void fence() { _mm_sfence(); }
+
+  // The first `n` lanes.
+  static mask tail(const size_t n) { return static_cast<mask>((1u << n) - 1); }
+
+  static mask lanes(const std::array<bool, width> &selected) {
+    mask bits = 0;
+    for (size_t l = 0; l < width; l++) {
+      bits |= static_cast<mask>(selected[l] ? 1u << l : 0);
+    }
+    return bits;
+  }
+
+  static index permutation(const std::array<int, width> &idx) {
+    alignas(64) long long wide[width];
+    for (size_t l = 0; l < width; l++) {
+      wide[l] = idx[l];
+    }
+    return _mm512_load_si512(wide);
+  }
+
+  static reg zero() { return _mm512_setzero_pd(); }
+
+  static reg set1(const value x) { return _mm512_set1_pd(x); }
+
+  static reg add(const reg a, const reg b) { return _mm512_add_pd(a, b); }
+
+  static reg sub(const reg a, const reg b) { return _mm512_sub_pd(a, b); }
+
+  static reg mul(const reg a, const reg b) { return _mm512_mul_pd(a, b); }
+
+  // a * b + c
+  static reg fmadd(const reg a, const reg b, const reg c) {
+    return _mm512_fmadd_pd(a, b, c);
+  }
+
+  // c - a * b
+  static reg fnmadd(const reg a, const reg b, const reg c) {
+    return _mm512_fnmadd_pd(a, b, c);
+  }
+
+  // a * b - c
+  static reg fmsub(const reg a, const reg b, const reg c) {
+    return _mm512_fmsub_pd(a, b, c);
+  }
+
+  static reg neg(const reg v) { return _mm512_xor_pd(v, _mm512_set1_pd(-0.0)); }
+
+  // `b` on the selected lanes, `a` on the others.
+  static reg blend(const mask lanes, const reg a, const reg b) {
+    return _mm512_mask_blend_pd(lanes, a, b);
+  }
+
+  static reg permute(const reg v, const index idx) {
+    return _mm512_permutexvar_pd(idx, v);
+  }
+
+  static value reduce(const reg v) { return _mm512_reduce_add_pd(v); }
+
+  // The double precision policy, for the reductions, and `width` doubles from
+  // `p`, which need not be aligned.
+  using wide = Avx512<double>;
+
+  static reg widen(const value *p) { return _mm512_loadu_pd(p); }
+};
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+template <typename T> const SimdBackend<T> &avx512_backend() {
+  static const SimdBackend<T> backend = SimdKernels<Avx512<T>>::backend();
+  return backend;
+}
+
+template const SimdBackend<float> &avx512_backend();
+template const SimdBackend<double> &avx512_backend();
@@ -0,0 +1,121 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SIMD_BACKEND_H
+#define SIMD_BACKEND_H
+
+#include "hilbert_namespace.h"
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+/*
+ * Instruction sets the `simd` kernels are built for, from the narrowest to
+ * the widest. `Scalar` is portable C++, for any CPU.
+ */
+enum class Isa { Scalar, Sse, Avx2, Avx512 };
+
+/*
+ * The `simd` kernels built for one instruction set, on `T` (float or double)
+ * amplitudes, see `SimdKernels`. All the pointers must be 64-byte aligned;
+ * lengths need not fill the last register, as it is loaded and stored under
+ * a lane mask.
+ */
+template <typename T> struct SimdBackend {
+  using Amplitude = std::complex<T>;
+
+  Isa isa;
+
+  void (*cvmul)(const T *left_real, const T *left_imag, const T *right_real,
+                const T *right_imag, T *result_real, T *result_imag,
+                size_t length, bool stream);
+
+  void (*cvsmul)(const T *real, const T *imag, Amplitude k, T *result_real,
+                 T *result_imag, size_t length, bool stream);
+
+  void (*vadd)(const T *left, const T *right, T *result, size_t length,
+               bool stream);
+
+  void (*vsub)(const T *left, const T *right, T *result, size_t length,
+               bool stream);
+
+  // result = -vect, by flipping the sign bits.
+  void (*vneg)(const T *vect, T *result, size_t length);
+
+  T (*vsum)(const T *vect, size_t length);
+
+  Amplitude (*cdotu)(const T *x_real, const T *x_imag, const T *y_real,
+                     const T *y_imag, size_t length);
+
+  Amplitude (*cdotc)(const T *x_real, const T *x_imag, const T *y_real,
+                     const T *y_imag, size_t length);
+
+  void (*caxpy)(Amplitude a, const T *x_real, const T *x_imag, T *y_real,
+                T *y_imag, size_t length);
+
+  void (*cscal)(Amplitude a, T *x_real, T *x_imag, size_t length);
+
+  T (*cnrm2)(const T *x_real, const T *x_imag, size_t length);
+
+  // The sums of a leaf of a `Reduction`, in double precision, see
+  // `simd::leaf_sum`. Their pointers need not be aligned.
+  double (*leaf_sum)(const T *data, size_t length);
+
+  std::complex<double> (*leaf_csum)(const T *real, const T *imag,
+                                    size_t length);
+
+  std::complex<double> (*leaf_cdotc)(const T *x_real, const T *x_imag,
+                                     const T *y_real, const T *y_imag,
+                                     size_t length);
+
+  double (*leaf_mass)(const T *real, const T *imag, size_t length,
+                      size_t first, size_t mask, size_t value);
+
+  void (*gate_1q)(T *real, T *imag, size_t length, size_t target,
+                  size_t controls, const std::array<Amplitude, 4> &u);
+
+  void (*gate_diagonal)(T *real, T *imag, size_t length, size_t target,
+                        size_t controls, Amplitude d0, Amplitude d1);
+
+  void (*permute_flip)(T *real, T *imag, size_t length, size_t target,
+                       size_t controls);
+
+  // Expects a < b.
+  void (*permute_swap)(T *real, T *imag, size_t length, size_t a, size_t b,
+                       size_t controls);
+
+  void (*gate_kq)(T *real, T *imag, size_t length,
+                  const std::vector<size_t> &qubits, size_t controls,
+                  const T *gate_real, const T *gate_imag, size_t gate_stride);
+};
+
+/*
+ * The kernels of each instruction set, instantiated for float and double.
+ * The SIMD ones are compiled for their instruction set whatever the flags of
+ * the library, so they must only be obtained on a CPU supporting it.
+ */
+template <typename T> const SimdBackend<T> &scalar_backend();
+
+// SSE4.1.
+template <typename T> const SimdBackend<T> &sse_backend();
+
+// AVX2 and FMA.
+template <typename T> const SimdBackend<T> &avx2_backend();
+
+// AVX-512F and DQ, built with the HILBERT_AVX512 option.
+template <typename T> const SimdBackend<T> &avx512_backend();
+
+#endif // !SIMD_BACKEND_H
@@ -0,0 +1,965 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SIMD_KERNELS_H
+#define SIMD_KERNELS_H
+
+#include "hilbert_namespace.h"
+#include "reduction.h"
+#include "scratch_arena.h"
+#include "simd.h"
+#include "simd_backend.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+/*
+ * The vectorised kernels behind `simd`, written once over an instruction set
+ * policy `V` and instantiated by one translation unit per instruction set
+ * (simd_scalar.cpp, simd_sse.cpp, simd_avx2.cpp, simd_avx512.cpp).
+ *
+ * The library itself is built for the baseline instruction set. A SIMD
+ * translation unit includes every other header first, then enables its
+ * instruction set with a target pragma and includes this one, so that only
+ * the kernels and the policy use the wider instructions. Inline functions of
+ * the shared headers keep the baseline instructions, as the linker may pick
+ * any translation unit's copy of them for the whole library.
+ *
+ * `V` has `width` floats per register, a power of two, and provides aligned,
+ * streaming and masked loads and stores, FMA arithmetic, lane blends and
+ * permutations, and a horizontal sum. Lanes are addressed by the low
+ * log2(width) bits of an amplitude index: gates on qubits below them work
+ * within a register, the others across registers. A last register that is
+ * not full is loaded and stored under a lane mask, so there is no scalar tail.
+ *
+ * The reductions accumulate in double precision whatever `V::value`, on the
+ * policy `V::wide` of the same instruction set, into which `V::widen` loads
+ * and converts values.
+ */
+template <typename V> class SimdKernels {
+public:
+  SimdKernels() = delete;
+
+  static SimdBackend<typename V::value> backend() {
+    return {.isa = V::isa,
+            .cvmul = cvmul,
+            .cvsmul = cvsmul,
+            .vadd = add_or_sub<false>,
+            .vsub = add_or_sub<true>,
+            .vneg = vneg,
+            .vsum = vsum,
+            .cdotu = cdot<false>,
+            .cdotc = cdot<true>,
+            .caxpy = caxpy,
+            .cscal = cscal,
+            .cnrm2 = cnrm2,
+            .leaf_sum = leaf_sum,
+            .leaf_csum = leaf_csum,
+            .leaf_cdotc = leaf_cdotc,
+            .leaf_mass = leaf_mass,
+            .gate_1q = gate_1q,
+            .gate_diagonal = gate_diagonal,
+            .permute_flip = permute_flip,
+            .permute_swap = permute_swap,
+            .gate_kq = gate_kq};
+  }
+
+private:
+  using value = typename V::value;
+  using amplitude = std::complex<value>;
+  using reg = typename V::reg;
+  using mask = typename V::mask;
+  using index = typename V::index;
+
+  static constexpr size_t width = V::width;
+
+  // Amplitude index bits addressing a lane within a register.
+  static constexpr size_t lane_bits = width - 1;
+
+  // Qubits below this one lie within a register.
+  static constexpr size_t lane_qubits = std::countr_zero(width);
+
+  // Registers consumed per iteration of the reductions, each feeding its own
+  // accumulator so that consecutive FMAs do not wait on each other.
+  static constexpr size_t fma_unroll = 4;
+
+  using wide = typename V::wide;
+  using wide_reg = typename wide::reg;
+
+  // Double registers holding the lanes of a `Reduction` leaf.
+  static constexpr size_t wide_regs = Reduction::lanes / wide::width;
+
+  static_assert(wide_regs * wide::width == Reduction::lanes);
+
+  /*
+   * Loads and stores of whole registers, streaming the stores when `Stream`
+   * is set.
+   */
+  template <bool Stream> struct Whole {
+    reg load(const value *p) const { return V::load(p); }
+
+    void store(value *p, const reg v) const {
+      if constexpr (Stream) {
+        V::stream(p, v);
+      } else {
+        V::store(p, v);
+      }
+    }
+  };
+
+  /*
+   * Loads and stores of the `lanes` of a register only, the other lanes
+   * being read as zero and left untouched.
+   */
+  struct Partial {
+    mask lanes;
+
+    reg load(const value *p) const { return V::load(p, lanes); }
+
+    void store(value *p, const reg v) const { V::store(p, v, lanes); }
+  };
+
+  /*
+   * Calls `kernel(io, i)` for every register of [0, length), where `io` loads
+   * and stores it, streaming the stores when `stream` is set.
+   */
+  template <typename F>
+  static void sweep(const size_t length, const bool stream, F kernel) {
+    const size_t whole = length & ~lane_bits;
+    if (stream) {
+      for (size_t i = 0; i < whole; i += width) {
+        kernel(Whole<true>(), i);
+      }
+      V::fence();
+    } else {
+      for (size_t i = 0; i < whole; i += width) {
+        kernel(Whole<false>(), i);
+      }
+    }
+    if (whole < length) {
+      kernel(Partial{V::tail(length - whole)}, whole);
+    }
+  }
+
+  /*
+   * Calls `step(io, i, u)` for every register of [0, length), spreading
+   * consecutive registers over the `fma_unroll` accumulators `u`.
+   */
+  template <typename F> static void accumulate(const size_t length, F step) {
+    const size_t whole = length & ~lane_bits;
+    size_t i = 0;
+    for (; i + width * fma_unroll <= whole; i += width * fma_unroll) {
+      for (size_t u = 0; u < fma_unroll; u++) {
+        step(Whole<false>(), i + width * u, u);
+      }
+    }
+    for (; i < whole; i += width) {
+      step(Whole<false>(), i, 0);
+    }
+    if (whole < length) {
+      step(Partial{V::tail(length - whole)}, whole, 0);
+    }
+  }
+
+  static reg sum(const reg (&acc)[fma_unroll]) {
+    return V::add(V::add(acc[0], acc[1]), V::add(acc[2], acc[3]));
+  }
+
+  /*
+   * Calls `kernel(io, i)` for every register of the runs of amplitudes with
+   * all the bits in `fixed` clear, offset by `set`, a subset of `fixed`. No
+   * bit of `fixed` may address a lane. Bits of `fixed` beyond `length` are
+   * clear on the whole slice, so they select nothing. A state shorter than a
+   * register is a single partial one.
+   */
+  template <typename F>
+  static void sweep_runs(const size_t length, size_t fixed, const size_t set,
+                         F kernel) {
+    if (length < width) {
+      kernel(Partial{V::tail(length)}, 0);
+      return;
+    }
+    fixed &= length - 1;
+    const size_t count = length >> std::popcount(fixed);
+    const size_t run =
+        fixed == 0 ? length : size_t(1) << std::countr_zero(fixed);
+    for (size_t j = 0; j < count; j += run) {
+      const size_t base = simd::insert_zero_bits(j, fixed) | set;
+      for (size_t i = base; i < base + run; i += width) {
+        kernel(Whole<false>(), i);
+      }
+    }
+  }
+
+  /*
+   * Lane mask selecting the lanes for which `select(lane)` holds.
+   */
+  template <typename F> static mask lanes(F select) {
+    std::array<bool, width> selected;
+    for (size_t l = 0; l < width; l++) {
+      selected[l] = select(l);
+    }
+    return V::lanes(selected);
+  }
+
+  /*
+   * Lane mask selecting the lanes whose bits in `low_controls` are all set.
+   */
+  static mask control_lanes(const size_t low_controls) {
+    return lanes([&](size_t l) { return (l & low_controls) == low_controls; });
+  }
+
+  /*
+   * Lane permutation sending lane `partner(l)` to lane `l`.
+   */
+  template <typename F> static index permutation(F partner) {
+    std::array<int, width> idx;
+    for (size_t l = 0; l < width; l++) {
+      idx[l] = static_cast<int>(partner(l));
+    }
+    return V::permutation(idx);
+  }
+
+  /*
+   * Per-lane coefficients, `k(lane)` on each lane.
+   */
+  template <typename F>
+  static void coefficients(F k, reg &k_real, reg &k_imag) {
+    alignas(64) value re[width], im[width];
+    for (size_t l = 0; l < width; l++) {
+      const amplitude c = k(l);
+      re[l] = c.real();
+      im[l] = c.imag();
+    }
+    k_real = V::load(re);
+    k_imag = V::load(im);
+  }
+
+  /*
+   * Complex multiply-accumulate on split registers: acc += k * v.
+   */
+  static void cfmadd(const reg k_real, const reg k_imag, const reg v_real,
+                     const reg v_imag, reg &acc_real, reg &acc_imag) {
+    acc_real = V::fmadd(k_real, v_real, acc_real);
+    acc_real = V::fnmadd(k_imag, v_imag, acc_real);
+    acc_imag = V::fmadd(k_real, v_imag, acc_imag);
+    acc_imag = V::fmadd(k_imag, v_real, acc_imag);
+  }
+
+  /*
+   * In-place complex multiplication of a register by per-lane coefficients.
+   */
+  template <typename IO>
+  static void cmul_inplace(const IO &io, value *real, value *imag,
+                           const reg k_real, const reg k_imag) {
+    const reg v_r = io.load(real);
+    const reg v_i = io.load(imag);
+    io.store(real, V::fnmadd(k_imag, v_i, V::mul(k_real, v_r)));
+    io.store(imag, V::fmadd(k_imag, v_r, V::mul(k_real, v_i)));
+  }
+
+  static void cvmul(const value *a, const value *b, const value *c,
+                    const value *d, value *real, value *imag,
+                    const size_t length, const bool stream) {
+    // Considering the formula (a + bi)(c + di) = (ac - bd) + i(ad + bc):
+    sweep(length, stream, [&](const auto &io, const size_t i) {
+      const reg va = io.load(a + i);
+      const reg vb = io.load(b + i);
+      const reg vc = io.load(c + i);
+      const reg vd = io.load(d + i);
+      io.store(real + i, V::fmsub(va, vc, V::mul(vb, vd)));
+      io.store(imag + i, V::fmadd(va, vd, V::mul(vb, vc)));
+    });
+  }
+
+  static void cvsmul(const value *a, const value *b, const amplitude k,
+                     value *real, value *imag, const size_t length,
+                     const bool stream) {
+    const reg c = V::set1(k.real());
+    const reg d = V::set1(k.imag());
+    sweep(length, stream, [&](const auto &io, const size_t i) {
+      const reg va = io.load(a + i);
+      const reg vb = io.load(b + i);
+      io.store(real + i, V::fmsub(va, c, V::mul(vb, d)));
+      io.store(imag + i, V::fmadd(va, d, V::mul(vb, c)));
+    });
+  }
+
+  template <bool Sub>
+  static void add_or_sub(const value *left, const value *right, value *result,
+                         const size_t length, const bool stream) {
+    sweep(length, stream, [&](const auto &io, const size_t i) {
+      if constexpr (Sub) {
+        io.store(result + i, V::sub(io.load(left + i), io.load(right + i)));
+      } else {
+        io.store(result + i, V::add(io.load(left + i), io.load(right + i)));
+      }
+    });
+  }
+
+  static void vneg(const value *vect, value *result, const size_t length) {
+    sweep(length, false, [&](const auto &io, const size_t i) {
+      io.store(result + i, V::neg(io.load(vect + i)));
+    });
+  }
+
+  static value vsum(const value *vect, const size_t length) {
+    reg acc[fma_unroll] = {V::zero(), V::zero(), V::zero(), V::zero()};
+    accumulate(length, [&](const auto &io, const size_t i, const size_t u) {
+      acc[u] = V::add(acc[u], io.load(vect + i));
+    });
+    return V::reduce(sum(acc));
+  }
+
+  /*
+   * Dot product over the split layout, conjugating `x` when `Conj` is set.
+   */
+  template <bool Conj>
+  static amplitude cdot(const value *a, const value *b, const value *c,
+                        const value *d, const size_t length) {
+    reg re[fma_unroll] = {V::zero(), V::zero(), V::zero(), V::zero()};
+    reg im[fma_unroll] = {V::zero(), V::zero(), V::zero(), V::zero()};
+
+    // (a + bi)(c + di) = (ac - bd) + i(ad + bc), and with a conjugated x
+    // (a - bi)(c + di) = (ac + bd) + i(ad - bc).
+    accumulate(length, [&](const auto &io, const size_t i, const size_t u) {
+      const reg va = io.load(a + i);
+      const reg vb = io.load(b + i);
+      const reg vc = io.load(c + i);
+      const reg vd = io.load(d + i);
+      re[u] = V::fmadd(va, vc, re[u]);
+      im[u] = V::fmadd(va, vd, im[u]);
+      if constexpr (Conj) {
+        re[u] = V::fmadd(vb, vd, re[u]);
+        im[u] = V::fnmadd(vb, vc, im[u]);
+      } else {
+        re[u] = V::fnmadd(vb, vd, re[u]);
+        im[u] = V::fmadd(vb, vc, im[u]);
+      }
+    });
+    return amplitude(V::reduce(sum(re)), V::reduce(sum(im)));
+  }
+
+  static void caxpy(const amplitude a, const value *x_real, const value *x_imag,
+                    value *y_real, value *y_imag, const size_t length) {
+    const reg ar = V::set1(a.real());
+    const reg ai = V::set1(a.imag());
+    sweep(length, false, [&](const auto &io, const size_t i) {
+      const reg xr = io.load(x_real + i);
+      const reg xi = io.load(x_imag + i);
+      const reg yr = io.load(y_real + i);
+      const reg yi = io.load(y_imag + i);
+      io.store(y_real + i, V::fnmadd(ai, xi, V::fmadd(ar, xr, yr)));
+      io.store(y_imag + i, V::fmadd(ai, xr, V::fmadd(ar, xi, yi)));
+    });
+  }
+
+  static void cscal(const amplitude a, value *x_real, value *x_imag,
+                    const size_t length) {
+    const reg ar = V::set1(a.real());
+    const reg ai = V::set1(a.imag());
+    sweep(length, false, [&](const auto &io, const size_t i) {
+      const reg xr = io.load(x_real + i);
+      const reg xi = io.load(x_imag + i);
+      io.store(x_real + i, V::fmsub(ar, xr, V::mul(ai, xi)));
+      io.store(x_imag + i, V::fmadd(ar, xi, V::mul(ai, xr)));
+    });
+  }
+
+  static value cnrm2(const value *x_real, const value *x_imag,
+                     const size_t length) {
+    reg acc[fma_unroll] = {V::zero(), V::zero(), V::zero(), V::zero()};
+    accumulate(length, [&](const auto &io, const size_t i, const size_t u) {
+      const reg r = io.load(x_real + i);
+      const reg m = io.load(x_imag + i);
+      acc[u] = V::fmadd(m, m, V::fmadd(r, r, acc[u]));
+    });
+    return std::sqrt(V::reduce(sum(acc)));
+  }
+
+  /*
+   * Sums the `Sums` terms set by `term(x, i, r, terms)` over the `length`
+   * elements of a `Reduction` leaf, where `x` holds the `Inputs` widened to
+   * register `r` of the block of `Reduction::lanes` elements at `i`. Each lane accumulates on
+   * its own, and the lanes are added pairwise. A last block that is not full
+   * is read from copies of the inputs padded with zeros, whose terms are zero.
+   * Terms use no FMA, so that every instruction set rounds them alike.
+   */
+  template <size_t Inputs, size_t Sums, typename F>
+  static std::array<double, Sums>
+  leaf(const std::array<const value *, Inputs> &inputs, const size_t length,
+       F term) {
+    constexpr auto lanes = Reduction::lanes;
+    wide_reg acc[Sums][wide_regs];
+    for (size_t s = 0; s < Sums; s++) {
+      for (size_t r = 0; r < wide_regs; r++) {
+        acc[s][r] = wide::zero();
+      }
+    }
+    const auto add_block = [&](const value *const (&block)[Inputs],
+                               const size_t i) {
+      for (size_t r = 0; r < wide_regs; r++) {
+        wide_reg x[Inputs];
+        for (size_t n = 0; n < Inputs; n++) {
+          x[n] = V::widen(block[n] + r * wide::width);
+        }
+        wide_reg terms[Sums];
+        term(x, i, r, terms);
+        for (size_t s = 0; s < Sums; s++) {
+          acc[s][r] = wide::add(acc[s][r], terms[s]);
+        }
+      }
+    };
+
+    const size_t body = length / lanes * lanes;
+    for (size_t i = 0; i < body; i += lanes) {
+      const value *block[Inputs];
+      for (size_t n = 0; n < Inputs; n++) {
+        block[n] = inputs[n] + i;
+      }
+      add_block(block, i);
+    }
+    if (body < length) {
+      value padded[Inputs][lanes] = {};
+      const value *block[Inputs];
+      for (size_t n = 0; n < Inputs; n++) {
+        std::copy(inputs[n] + body, inputs[n] + length, padded[n]);
+        block[n] = padded[n];
+      }
+      add_block(block, body);
+    }
+
+    std::array<double, Sums> sums;
+    for (size_t s = 0; s < Sums; s++) {
+      alignas(64) double lane_sums[lanes];
+      for (size_t r = 0; r < wide_regs; r++) {
+        wide::store(lane_sums + r * wide::width, acc[s][r]);
+      }
+      sums[s] = simd::pairwise_lanes(lane_sums);
+    }
+    return sums;
+  }
+
+  static double leaf_sum(const value *data, const size_t length) {
+    return leaf<1, 1>({data}, length,
+                      [](const auto &x, size_t, size_t, auto &terms) {
+                        terms[0] = x[0];
+                      })[0];
+  }
+
+  static std::complex<double> leaf_csum(const value *real, const value *imag,
+                                        const size_t length) {
+    const auto sums = leaf<2, 2>(
+        {real, imag}, length, [](const auto &x, size_t, size_t, auto &terms) {
+          terms[0] = x[0];
+          terms[1] = x[1];
+        });
+    return {sums[0], sums[1]};
+  }
+
+  static std::complex<double> leaf_cdotc(const value *a, const value *b,
+                                         const value *c, const value *d,
+                                         const size_t length) {
+    // (a - bi)(c + di) = (ac + bd) + i(ad - bc)
+    const auto sums = leaf<4, 2>(
+        {a, b, c, d}, length, [](const auto &x, size_t, size_t, auto &terms) {
+          terms[0] = wide::add(wide::mul(x[0], x[2]), wide::mul(x[1], x[3]));
+          terms[1] = wide::sub(wide::mul(x[0], x[3]), wide::mul(x[1], x[2]));
+        });
+    return {sums[0], sums[1]};
+  }
+
+  /*
+   * The mass of the elements whose index, counted from `first`, matches
+   * `bits` on `mask`. `first` is a multiple of `Reduction::lanes`, so that
+   * the low bits of `mask` select the same lanes in every block, and the
+   * others whole blocks.
+   */
+  static double leaf_mass(const value *real, const value *imag,
+                          const size_t length, const size_t first,
+                          const size_t mask, const size_t bits) {
+    constexpr auto lane_mask = Reduction::lanes - 1;
+    const size_t selected = bits & mask;
+    typename wide::mask low[wide_regs];
+    for (size_t r = 0; r < wide_regs; r++) {
+      std::array<bool, wide::width> lanes;
+      for (size_t l = 0; l < wide::width; l++) {
+        lanes[l] = (((r * wide::width + l) ^ selected) & mask & lane_mask) == 0;
+      }
+      low[r] = wide::lanes(lanes);
+    }
+    return leaf<2, 1>(
+        {real, imag}, length,
+        [&](const auto &x, const size_t i, const size_t r, auto &terms) {
+          if ((((first + i) ^ selected) & mask & ~lane_mask) != 0) {
+            terms[0] = wide::zero();
+            return;
+          }
+          const auto m =
+              wide::add(wide::mul(x[0], x[0]), wide::mul(x[1], x[1]));
+          terms[0] = wide::blend(low[r], wide::zero(), m);
+        })[0];
+  }
+
+  static void gate_1q(value *real, value *imag, const size_t length,
+                      const size_t target, const size_t controls,
+                      const std::array<amplitude, 4> &u) {
+    if (target < lane_qubits) {
+      gate_1q_low(real, imag, length, target, controls, u);
+    } else {
+      gate_1q_high(real, imag, length, target, controls, u);
+    }
+  }
+
+  static void gate_diagonal(value *real, value *imag, const size_t length,
+                            const size_t target, const size_t controls,
+                            const amplitude d0, const amplitude d1) {
+    if (target < lane_qubits) {
+      gate_diagonal_low(real, imag, length, target, controls, d0, d1);
+    } else {
+      gate_diagonal_high(real, imag, length, target, controls, d0, d1);
+    }
+  }
+
+  static void permute_flip(value *real, value *imag, const size_t length,
+                           const size_t target, const size_t controls) {
+    if (target < lane_qubits) {
+      const size_t bit = size_t(1) << target;
+      permute_lanes(real, imag, length, controls,
+                    permutation([&](size_t l) { return l ^ bit; }));
+    } else {
+      permute_flip_high(real, imag, length, target, controls);
+    }
+  }
+
+  static void permute_swap(value *real, value *imag, const size_t length,
+                           const size_t a, const size_t b,
+                           const size_t controls) {
+    if (b < lane_qubits) {
+      // Exchanges bits a and b of the lane index.
+      const size_t both = (size_t(1) << a) | (size_t(1) << b);
+      permute_lanes(real, imag, length, controls, permutation([&](size_t l) {
+                      return ((l >> a) & 1) == ((l >> b) & 1) ? l : l ^ both;
+                    }));
+    } else if (a < lane_qubits) {
+      permute_swap_mixed(real, imag, length, a, b, controls);
+    } else {
+      permute_swap_high(real, imag, length, a, b, controls);
+    }
+  }
+
+  static void gate_kq(value *real, value *imag, const size_t length,
+                      const std::vector<size_t> &qubits, const size_t controls,
+                      const value *gate_real, const value *gate_imag,
+                      const size_t gate_stride) {
+    if (*std::min_element(qubits.begin(), qubits.end()) < lane_qubits) {
+      gate_kq_gather(real, imag, length, qubits, controls, gate_real,
+                     gate_imag, gate_stride);
+    } else {
+      gate_kq_high(real, imag, length, qubits, controls, gate_real, gate_imag,
+                   gate_stride);
+    }
+  }
+
+  /*
+   * Diagonal gate for targets across registers: each register lies entirely
+   * on one side of the target bit, so it is multiplied by d0 or d1.
+   */
+  static void gate_diagonal_high(value *real, value *imag, const size_t length,
+                                 const size_t target, const size_t controls,
+                                 const amplitude d0, const amplitude d1) {
+    const size_t stride = size_t(1) << target;
+    const size_t high_controls = controls & ~lane_bits;
+    const size_t low_controls = controls & lane_bits;
+    const bool touch_clear = d0 != amplitude(1);
+
+    reg k0_r, k0_i, k1_r, k1_i;
+    coefficients(
+        [&](size_t l) {
+          return (l & low_controls) == low_controls ? d0 : amplitude(1);
+        },
+        k0_r, k0_i);
+    coefficients(
+        [&](size_t l) {
+          return (l & low_controls) == low_controls ? d1 : amplitude(1);
+        },
+        k1_r, k1_i);
+
+    sweep_runs(length, stride | high_controls, high_controls,
+               [&](const auto &io, const size_t i) {
+                 if (touch_clear) {
+                   cmul_inplace(io, real + i, imag + i, k0_r, k0_i);
+                 }
+                 cmul_inplace(io, real + i + stride, imag + i + stride, k1_r,
+                              k1_i);
+               });
+  }
+
+  /*
+   * Diagonal gate for targets within a register: d0 and d1 are applied
+   * together as per-lane coefficients.
+   */
+  static void gate_diagonal_low(value *real, value *imag, const size_t length,
+                                const size_t target, const size_t controls,
+                                const amplitude d0, const amplitude d1) {
+    const size_t bit = size_t(1) << target;
+    const size_t high_controls = controls & ~lane_bits;
+    const size_t low_controls = controls & lane_bits;
+
+    reg k_r, k_i;
+    coefficients(
+        [&](size_t l) {
+          if ((l & low_controls) != low_controls) {
+            return amplitude(1);
+          }
+          return (l & bit) ? d1 : d0;
+        },
+        k_r, k_i);
+
+    sweep_runs(length, high_controls, high_controls,
+               [&](const auto &io, const size_t i) {
+                 cmul_inplace(io, real + i, imag + i, k_r, k_i);
+               });
+  }
+
+  /*
+   * Pauli-X for targets across registers: the two halves of each block are
+   * exchanged register by register, with no arithmetic.
+   */
+  static void permute_flip_high(value *real, value *imag, const size_t length,
+                                const size_t target, const size_t controls) {
+    const size_t stride = size_t(1) << target;
+    const size_t high_controls = controls & ~lane_bits;
+    const size_t low_controls = controls & lane_bits;
+    const mask selected = control_lanes(low_controls);
+
+    sweep_runs(
+        length, stride | high_controls, high_controls,
+        [&](const auto &io, const size_t i) {
+          const reg lo_r = io.load(real + i);
+          const reg lo_i = io.load(imag + i);
+          const reg hi_r = io.load(real + i + stride);
+          const reg hi_i = io.load(imag + i + stride);
+          if (low_controls == 0) {
+            io.store(real + i, hi_r);
+            io.store(imag + i, hi_i);
+            io.store(real + i + stride, lo_r);
+            io.store(imag + i + stride, lo_i);
+          } else {
+            io.store(real + i, V::blend(selected, lo_r, hi_r));
+            io.store(imag + i, V::blend(selected, lo_i, hi_i));
+            io.store(real + i + stride, V::blend(selected, hi_r, lo_r));
+            io.store(imag + i + stride, V::blend(selected, hi_i, lo_i));
+          }
+        });
+  }
+
+  /*
+   * Applies the same lane permutation to every register whose control bits
+   * across registers are set; lanes failing the control bits within the
+   * register are kept.
+   */
+  static void permute_lanes(value *real, value *imag, const size_t length,
+                            const size_t controls, const index partner) {
+    const size_t high_controls = controls & ~lane_bits;
+    const size_t low_controls = controls & lane_bits;
+    const mask selected = control_lanes(low_controls);
+
+    sweep_runs(length, high_controls, high_controls,
+               [&](const auto &io, const size_t i) {
+                 const reg v_r = io.load(real + i);
+                 const reg v_i = io.load(imag + i);
+                 reg p_r = V::permute(v_r, partner);
+                 reg p_i = V::permute(v_i, partner);
+                 if (low_controls != 0) {
+                   p_r = V::blend(selected, v_r, p_r);
+                   p_i = V::blend(selected, v_i, p_i);
+                 }
+                 io.store(real + i, p_r);
+                 io.store(imag + i, p_i);
+               });
+  }
+
+  /*
+   * SWAP for a within a register and b across registers: lanes with bit a set
+   * in the lower half of a block are exchanged with the lanes with bit a
+   * clear in the upper half.
+   */
+  static void permute_swap_mixed(value *real, value *imag, const size_t length,
+                                 const size_t a, const size_t b,
+                                 const size_t controls) {
+    const size_t bit_a = size_t(1) << a;
+    const size_t stride = size_t(1) << b;
+    const size_t high_controls = controls & ~lane_bits;
+    const size_t low_controls = controls & lane_bits;
+    const index partner = permutation([&](size_t l) { return l ^ bit_a; });
+    const mask lo_lanes = lanes([&](size_t l) {
+      return (l & bit_a) && (l & low_controls) == low_controls;
+    });
+    const mask hi_lanes = lanes([&](size_t l) {
+      return !(l & bit_a) && (l & low_controls) == low_controls;
+    });
+
+    sweep_runs(length, stride | high_controls, high_controls,
+               [&](const auto &io, const size_t i) {
+                 const reg lo_r = io.load(real + i);
+                 const reg lo_i = io.load(imag + i);
+                 const reg hi_r = io.load(real + i + stride);
+                 const reg hi_i = io.load(imag + i + stride);
+                 io.store(real + i,
+                          V::blend(lo_lanes, lo_r, V::permute(hi_r, partner)));
+                 io.store(imag + i,
+                          V::blend(lo_lanes, lo_i, V::permute(hi_i, partner)));
+                 io.store(real + i + stride,
+                          V::blend(hi_lanes, hi_r, V::permute(lo_r, partner)));
+                 io.store(imag + i + stride,
+                          V::blend(hi_lanes, hi_i, V::permute(lo_i, partner)));
+               });
+  }
+
+  /*
+   * SWAP for qubits a < b both across registers: whole registers at
+   * i | 1 << a and i | 1 << b are exchanged.
+   */
+  static void permute_swap_high(value *real, value *imag, const size_t length,
+                                const size_t a, const size_t b,
+                                const size_t controls) {
+    const size_t bit_a = size_t(1) << a;
+    const size_t bit_b = size_t(1) << b;
+    const size_t high_controls = controls & ~lane_bits;
+    const size_t low_controls = controls & lane_bits;
+    const mask selected = control_lanes(low_controls);
+
+    sweep_runs(
+        length, bit_a | bit_b | high_controls, high_controls,
+        [&](const auto &io, const size_t i) {
+          const reg x_r = io.load(real + (i | bit_a));
+          const reg x_i = io.load(imag + (i | bit_a));
+          const reg y_r = io.load(real + (i | bit_b));
+          const reg y_i = io.load(imag + (i | bit_b));
+          if (low_controls == 0) {
+            io.store(real + (i | bit_a), y_r);
+            io.store(imag + (i | bit_a), y_i);
+            io.store(real + (i | bit_b), x_r);
+            io.store(imag + (i | bit_b), x_i);
+          } else {
+            io.store(real + (i | bit_a), V::blend(selected, x_r, y_r));
+            io.store(imag + (i | bit_a), V::blend(selected, x_i, y_i));
+            io.store(real + (i | bit_b), V::blend(selected, y_r, x_r));
+            io.store(imag + (i | bit_b), V::blend(selected, y_i, x_i));
+          }
+        });
+  }
+
+  /*
+   * Single-qubit gate for targets across registers: both amplitudes of a pair
+   * lie in different registers, 2^target elements apart, so whole registers
+   * are loaded from each half of the block. Control bits across registers
+   * select which blocks are visited, the others mask lanes within a block.
+   */
+  static void gate_1q_high(value *real, value *imag, const size_t length,
+                           const size_t target, const size_t controls,
+                           const std::array<amplitude, 4> &u) {
+    const reg u00_r = V::set1(u[0].real());
+    const reg u00_i = V::set1(u[0].imag());
+    const reg u01_r = V::set1(u[1].real());
+    const reg u01_i = V::set1(u[1].imag());
+    const reg u10_r = V::set1(u[2].real());
+    const reg u10_i = V::set1(u[2].imag());
+    const reg u11_r = V::set1(u[3].real());
+    const reg u11_i = V::set1(u[3].imag());
+
+    const size_t stride = size_t(1) << target;
+    const size_t high_controls = controls & ~lane_bits;
+    const size_t low_controls = controls & lane_bits;
+    const mask selected = control_lanes(low_controls);
+
+    sweep_runs(length, stride | high_controls, high_controls,
+               [&](const auto &io, const size_t i) {
+                 const reg a_r = io.load(real + i);
+                 const reg a_i = io.load(imag + i);
+                 const reg b_r = io.load(real + i + stride);
+                 const reg b_i = io.load(imag + i + stride);
+
+                 reg na_r = V::zero(), na_i = V::zero();
+                 reg nb_r = V::zero(), nb_i = V::zero();
+                 cfmadd(u00_r, u00_i, a_r, a_i, na_r, na_i);
+                 cfmadd(u01_r, u01_i, b_r, b_i, na_r, na_i);
+                 cfmadd(u10_r, u10_i, a_r, a_i, nb_r, nb_i);
+                 cfmadd(u11_r, u11_i, b_r, b_i, nb_r, nb_i);
+
+                 if (low_controls != 0) {
+                   na_r = V::blend(selected, a_r, na_r);
+                   na_i = V::blend(selected, a_i, na_i);
+                   nb_r = V::blend(selected, b_r, nb_r);
+                   nb_i = V::blend(selected, b_i, nb_i);
+                 }
+
+                 io.store(real + i, na_r);
+                 io.store(imag + i, na_i);
+                 io.store(real + i + stride, nb_r);
+                 io.store(imag + i + stride, nb_i);
+               });
+  }
+
+  /*
+   * Single-qubit gate for targets within a register: each lane is combined
+   * with its partner lane (obtained with a permute) using per-lane
+   * coefficients.
+   */
+  static void gate_1q_low(value *real, value *imag, const size_t length,
+                          const size_t target, const size_t controls,
+                          const std::array<amplitude, 4> &u) {
+    const size_t bit = size_t(1) << target;
+    const index partner = permutation([&](size_t l) { return l ^ bit; });
+
+    // Lanes with the target bit clear compute u00 a + u01 b, the others
+    // compute u10 a + u11 b, where `a` is the lane with the bit clear.
+    reg cs_r, cs_i, co_r, co_i;
+    coefficients([&](size_t l) { return (l & bit) ? u[3] : u[0]; }, cs_r, cs_i);
+    coefficients([&](size_t l) { return (l & bit) ? u[2] : u[1]; }, co_r, co_i);
+
+    const size_t high_controls = controls & ~lane_bits;
+    const size_t low_controls = controls & lane_bits;
+    const mask selected = control_lanes(low_controls);
+
+    sweep_runs(length, high_controls, high_controls,
+               [&](const auto &io, const size_t i) {
+                 const reg v_r = io.load(real + i);
+                 const reg v_i = io.load(imag + i);
+                 const reg p_r = V::permute(v_r, partner);
+                 const reg p_i = V::permute(v_i, partner);
+
+                 reg n_r = V::zero(), n_i = V::zero();
+                 cfmadd(cs_r, cs_i, v_r, v_i, n_r, n_i);
+                 cfmadd(co_r, co_i, p_r, p_i, n_r, n_i);
+
+                 if (low_controls != 0) {
+                   n_r = V::blend(selected, v_r, n_r);
+                   n_i = V::blend(selected, v_i, n_i);
+                 }
+
+                 io.store(real + i, n_r);
+                 io.store(imag + i, n_i);
+               });
+  }
+
+  /*
+   * k-qubit gate with every target across registers: the 2^k amplitudes of a
+   * group lie in different registers, so `width` consecutive groups are
+   * processed at once, one per lane, with the gate elements broadcast.
+   * Control bits within a register mask lanes.
+   */
+  static void gate_kq_high(value *real, value *imag, const size_t length,
+                           const std::vector<size_t> &qubits,
+                           const size_t controls, const value *gate_real,
+                           const value *gate_imag, const size_t gate_stride) {
+    const auto offsets = simd::local_offsets(qubits);
+    const size_t dim = offsets.size();
+    const size_t high_controls = controls & ~lane_bits;
+    const size_t low_controls = controls & lane_bits;
+    const mask selected = control_lanes(low_controls);
+
+    // The 2^k input registers, spilled to scratch.
+    ScratchArena::Scope scope;
+    auto *in_r = ScratchArena::local().allocate_as<value>(dim * width);
+    auto *in_i = ScratchArena::local().allocate_as<value>(dim * width);
+    sweep_runs(
+        length, offsets.back() | high_controls, high_controls,
+        [&](const auto &io, const size_t i) {
+          for (size_t c = 0; c < dim; c++) {
+            V::store(in_r + c * width, io.load(real + i + offsets[c]));
+            V::store(in_i + c * width, io.load(imag + i + offsets[c]));
+          }
+          for (size_t r = 0; r < dim; r++) {
+            reg out_r = V::zero(), out_i = V::zero();
+            for (size_t c = 0; c < dim; c++) {
+              cfmadd(V::set1(gate_real[r * gate_stride + c]),
+                     V::set1(gate_imag[r * gate_stride + c]),
+                     V::load(in_r + c * width), V::load(in_i + c * width),
+                     out_r, out_i);
+            }
+            if (low_controls != 0) {
+              out_r = V::blend(selected, V::load(in_r + r * width), out_r);
+              out_i = V::blend(selected, V::load(in_i + r * width), out_i);
+            }
+            io.store(real + i + offsets[r], out_r);
+            io.store(imag + i + offsets[r], out_i);
+          }
+        });
+  }
+
+  /*
+   * k-qubit gate with a target within a register: each group of 2^k
+   * amplitudes is gathered, multiplied with the rows vectorised (gate
+   * columns, padded to whole registers, times the broadcast amplitude) and
+   * scattered back.
+   */
+  static void gate_kq_gather(value *real, value *imag, const size_t length,
+                             const std::vector<size_t> &qubits,
+                             const size_t controls, const value *gate_real,
+                             const value *gate_imag, const size_t gate_stride) {
+    const auto offsets = simd::local_offsets(qubits);
+    const size_t dim = offsets.size();
+    const size_t rows = std::max(dim, width);
+
+    ScratchArena::Scope scope;
+    auto &arena = ScratchArena::local();
+    auto *column_r = arena.allocate_as<value>(dim * rows);
+    auto *column_i = arena.allocate_as<value>(dim * rows);
+    std::fill_n(column_r, dim * rows, value(0));
+    std::fill_n(column_i, dim * rows, value(0));
+    for (size_t r = 0; r < dim; r++) {
+      for (size_t c = 0; c < dim; c++) {
+        column_r[c * rows + r] = gate_real[r * gate_stride + c];
+        column_i[c * rows + r] = gate_imag[r * gate_stride + c];
+      }
+    }
+    auto *in_r = arena.allocate_as<value>(dim);
+    auto *in_i = arena.allocate_as<value>(dim);
+    auto *out_r = arena.allocate_as<value>(rows);
+    auto *out_i = arena.allocate_as<value>(rows);
+
+    const size_t fixed = (offsets.back() | controls) & (length - 1);
+    const size_t count = length >> std::popcount(fixed);
+    for (size_t j = 0; j < count; j++) {
+      const size_t base = simd::insert_zero_bits(j, fixed) | controls;
+      for (size_t c = 0; c < dim; c++) {
+        in_r[c] = real[base | offsets[c]];
+        in_i[c] = imag[base | offsets[c]];
+      }
+      for (size_t r = 0; r < rows; r += width) {
+        reg acc_r = V::zero(), acc_i = V::zero();
+        for (size_t c = 0; c < dim; c++) {
+          cfmadd(V::set1(in_r[c]), V::set1(in_i[c]),
+                 V::load(column_r + c * rows + r),
+                 V::load(column_i + c * rows + r), acc_r, acc_i);
+        }
+        V::store(out_r + r, acc_r);
+        V::store(out_i + r, acc_i);
+      }
+      for (size_t r = 0; r < dim; r++) {
+        real[base | offsets[r]] = out_r[r];
+        imag[base | offsets[r]] = out_i[r];
+      }
+    }
+  }
+};
+
+#endif // !SIMD_KERNELS_H
@@ -0,0 +1,106 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "hilbert_namespace.h"
+#include "simd_backend.h"
+#include "simd_kernels.h"
+#include <array>
+#include <cstddef>
+
+/*
+ * The portable policy of `SimdKernels`: one float or double per register, so
+ * that the kernels run on any CPU, and lanes never need to be masked or
+ * permuted.
+ */
+template <typename T> struct Scalar {
+  using value = T;
+  using reg = T;
+  using mask = bool;
+  using index = int;
+
+  static constexpr Isa isa = Isa::Scalar;
+  static constexpr size_t width = 1;
+
+  static reg load(const value *p) { return *p; }
+
+  static reg load(const value *p, const mask lanes) {
+    return lanes ? *p : reg(0);
+  }
+
+  static void store(value *p, const reg v) { *p = v; }
+
+  static void store(value *p, const reg v, const mask lanes) {
+    if (lanes) {
+      *p = v;
+    }
+  }
+
+  static void stream(value *p, const reg v) { *p = v; }
+
+  static void fence() {}
+
+  // The first `n` lanes.
+  static mask tail(const size_t n) { return n > 0; }
+
+  static mask lanes(const std::array<bool, width> &selected) {
+    return selected[0];
+  }
+
+  static index permutation(const std::array<int, width> &idx) { return idx[0]; }
+
+  static reg zero() { return 0; }
+
+  static reg set1(const value x) { return x; }
+
+  static reg add(const reg a, const reg b) { return a + b; }
+
+  static reg sub(const reg a, const reg b) { return a - b; }
+
+  static reg mul(const reg a, const reg b) { return a * b; }
+
+  // a * b + c
+  static reg fmadd(const reg a, const reg b, const reg c) { return a * b + c; }
+
+  // c - a * b
+  static reg fnmadd(const reg a, const reg b, const reg c) { return c - a * b; }
+
+  // a * b - c
+  static reg fmsub(const reg a, const reg b, const reg c) { return a * b - c; }
+
+  static reg neg(const reg v) { return -v; }
+
+  // `b` on the selected lanes, `a` on the others.
+  static reg blend(const mask lanes, const reg a, const reg b) {
+    return lanes ? b : a;
+  }
+
+  static reg permute(const reg v, const index) { return v; }
+
+  static value reduce(const reg v) { return v; }
+
+  // The double precision policy, for the reductions, and the value at `p`
+  // converted to double.
+  using wide = Scalar<double>;
+
+  static double widen(const value *p) { return *p; }
+};
+
+template <typename T> const SimdBackend<T> &scalar_backend() {
+  static const SimdBackend<T> backend = SimdKernels<Scalar<T>>::backend();
+  return backend;
+}
+
+template const SimdBackend<float> &scalar_backend();
+template const SimdBackend<double> &scalar_backend();
@@ -0,0 +1,284 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "hilbert_namespace.h"
+#include "scratch_arena.h"
+#include "simd.h"
+#include "simd_backend.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <immintrin.h>
+#include <vector>
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("sse4.1"))), \
+                             apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+
+#include "simd_kernels.h"
+
+/*
+ * The SSE4.1 policies of `SimdKernels`, with no FMA. A lane mask is a
+ * register with every bit of the selected lanes set, and a lane permutation
+ * is a byte shuffle. SSE has no masked loads and stores, so those go lane by
+ * lane.
+ */
+template <typename T> struct Sse;
+
+template <> struct Sse<double>;
+
+// 4 floats per register.
+template <> struct Sse<float> {
+  using value = float;
+  using reg = __m128;
+  using mask = __m128;
+  using index = __m128i;
+
+  static constexpr Isa isa = Isa::Sse;
+  static constexpr size_t width = 4;
+
+  static reg load(const value *p) { return _mm_load_ps(p); }
+
+  static reg load(const value *p, const mask lanes) {
+    const int bits = _mm_movemask_ps(lanes);
+    alignas(16) value v[width] = {};
+    for (size_t l = 0; l < width; l++) {
+      if ((bits >> l) & 1) {
+        v[l] = p[l];
+      }
+    }
+    return _mm_load_ps(v);
+  }
+
+  static void store(value *p, const reg v) { _mm_store_ps(p, v); }
+
+  static void store(value *p, const reg v, const mask lanes) {
+    const int bits = _mm_movemask_ps(lanes);
+    alignas(16) value s[width];
+    _mm_store_ps(s, v);
+    for (size_t l = 0; l < width; l++) {
+      if ((bits >> l) & 1) {
+        p[l] = s[l];
+      }
+    }
+  }
+
+  static void stream(value *p, const reg v) { _mm_stream_ps(p, v); }
+
+  static void fence() { _mm_sfence(); }
+
+  // The first `n` lanes.
+  static mask tail(const size_t n) {
+    return _mm_castsi128_ps(_mm_cmpgt_epi32(
+        _mm_set1_epi32(static_cast<int>(n)), _mm_setr_epi32(0, 1, 2, 3)));
+  }
+
+  static mask lanes(const std::array<bool, width> &selected) {
+    alignas(16) int bits[width];
+    for (size_t l = 0; l < width; l++) {
+      bits[l] = selected[l] ? -1 : 0;
+    }
+    return _mm_castsi128_ps(
+        _mm_load_si128(reinterpret_cast<const __m128i *>(bits)));
+  }
+
+  // Byte `b` of lane `l` is taken from byte `b` of lane `idx[l]`.
+  static index permutation(const std::array<int, width> &idx) {
+    alignas(16) char bytes[4 * width];
+    for (size_t l = 0; l < width; l++) {
+      for (size_t b = 0; b < 4; b++) {
+        bytes[4 * l + b] = static_cast<char>(4 * idx[l] + b);
+      }
+    }
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(bytes));
+  }
+
+  static reg zero() { return _mm_setzero_ps(); }
+
+  static reg set1(const value x) { return _mm_set1_ps(x); }
+
+  static reg add(const reg a, const reg b) { return _mm_add_ps(a, b); }
+
+  static reg sub(const reg a, const reg b) { return _mm_sub_ps(a, b); }
+
+  static reg mul(const reg a, const reg b) { return _mm_mul_ps(a, b); }
+
+  // a * b + c
+  static reg fmadd(const reg a, const reg b, const reg c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+  }
+
+  // c - a * b
+  static reg fnmadd(const reg a, const reg b, const reg c) {
+    return _mm_sub_ps(c, _mm_mul_ps(a, b));
+  }
+
+  // a * b - c
+  static reg fmsub(const reg a, const reg b, const reg c) {
+    return _mm_sub_ps(_mm_mul_ps(a, b), c);
+  }
+
+  static reg neg(const reg v) { return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+
+  // `b` on the selected lanes, `a` on the others.
+  static reg blend(const mask lanes, const reg a, const reg b) {
+    return _mm_blendv_ps(a, b, lanes);
+  }
+
+  static reg permute(const reg v, const index idx) {
+    return _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(v), idx));
+  }
+
+  static value reduce(const reg v) {
+    const __m128 odd = _mm_movehdup_ps(v);
+    const __m128 pairs = _mm_add_ps(v, odd);
+    return _mm_cvtss_f32(_mm_add_ss(pairs, _mm_movehl_ps(odd, pairs)));
+  }
+
+  // The double precision policy, for the reductions, and `wide::width` floats
+  // from `p`, which need not be aligned, converted to doubles.
+  using wide = Sse<double>;
+
+  static __m128d widen(const value *p) {
+    return _mm_cvtps_pd(_mm_castsi128_ps(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p))));
+  }
+};
+
+// 2 doubles per register.
+template <> struct Sse<double> {
+  using value = double;
+  using reg = __m128d;
+  using mask = __m128d;
+  using index = __m128i;
+
+  static constexpr Isa isa = Isa::Sse;
+  static constexpr size_t width = 2;
+
+  static reg load(const value *p) { return _mm_load_pd(p); }
+
+  static reg load(const value *p, const mask lanes) {
+    const int bits = _mm_movemask_pd(lanes);
+    return _mm_setr_pd(bits & 1 ? p[0] : 0, bits & 2 ? p[1] : 0);
+  }
+
+  static void store(value *p, const reg v) { _mm_store_pd(p, v); }
+
+  static void store(value *p, const reg v, const mask lanes) {
+    const int bits = _mm_movemask_pd(lanes);
+    if (bits & 1) {
+      _mm_storel_pd(p, v);
+    }
+    if (bits & 2) {
+      _mm_storeh_pd(p + 1, v);
+    }
+  }
+
+  static void stream(value *p, const reg v) { _mm_stream_pd(p, v); }
+
+  static void fence() { _mm_sfence(); }
+
+  // The first `n` lanes, comparing both 32-bit halves of each lane.
+  static mask tail(const size_t n) {
+    return _mm_castsi128_pd(_mm_cmpgt_epi32(
+        _mm_set1_epi32(static_cast<int>(n)), _mm_setr_epi32(0, 0, 1, 1)));
+  }
+
+  static mask lanes(const std::array<bool, width> &selected) {
+    alignas(16) long long bits[width];
+    for (size_t l = 0; l < width; l++) {
+      bits[l] = selected[l] ? -1 : 0;
+    }
+    return _mm_castsi128_pd(
+        _mm_load_si128(reinterpret_cast<const __m128i *>(bits)));
+  }
+
+  // Byte `b` of lane `l` is taken from byte `b` of lane `idx[l]`.
+  static index permutation(const std::array<int, width> &idx) {
+    alignas(16) char bytes[8 * width];
+    for (size_t l = 0; l < width; l++) {
+      for (size_t b = 0; b < 8; b++) {
+        bytes[8 * l + b] = static_cast<char>(8 * idx[l] + b);
+      }
+    }
+    return _mm_load_si128(reinterpret_cast<const __m128i *>(bytes));
+  }
+
+  static reg zero() { return _mm_setzero_pd(); }
+
+  static reg set1(const value x) { return _mm_set1_pd(x); }
+
+  static reg add(const reg a, const reg b) { return _mm_add_pd(a, b); }
+
+  static reg sub(const reg a, const reg b) { return _mm_sub_pd(a, b); }
+
+  static reg mul(const reg a, const reg b) { return _mm_mul_pd(a, b); }
+
+  // a * b + c
+  static reg fmadd(const reg a, const reg b, const reg c) {
+    return _mm_add_pd(_mm_mul_pd(a, b), c);
+  }
+
+  // c - a * b
+  static reg fnmadd(const reg a, const reg b, const reg c) {
+    return _mm_sub_pd(c, _mm_mul_pd(a, b));
+  }
+
+  // a * b - c
+  static reg fmsub(const reg a, const reg b, const reg c) {
+    return _mm_sub_pd(_mm_mul_pd(a, b), c);
+  }
+
+  static reg neg(const reg v) { return _mm_xor_pd(v, _mm_set1_pd(-0.0)); }
+
+  // `b` on the selected lanes, `a` on the others.
+  static reg blend(const mask lanes, const reg a, const reg b) {
+    return _mm_blendv_pd(a, b, lanes);
+  }
+
+  static reg permute(const reg v, const index idx) {
+    return _mm_castsi128_pd(_mm_shuffle_epi8(_mm_castpd_si128(v), idx));
+  }
+
+  static value reduce(const reg v) {
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+  }
+
+  // The double precision policy, for the reductions, and `width` doubles from
+  // `p`, which need not be aligned.
+  using wide = Sse<double>;
+
+  static reg widen(const value *p) { return _mm_loadu_pd(p); }
+};
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+template <typename T> const SimdBackend<T> &sse_backend() {
+  static const SimdBackend<T> backend = SimdKernels<Sse<T>>::backend();
+  return backend;
+}
+
+template const SimdBackend<float> &sse_backend();
+template const SimdBackend<double> &sse_backend();
@@ -0,0 +1,135 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef SPLIT_SPAN_H
+#define SPLIT_SPAN_H
+
+#include "hilbert_namespace.h"
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+/*
+ * This class is a non-owning view over complex elements stored with real and
+ * imaginary parts split, as in `ComplexVectSplit` or a row of a
+ * `ComplexVectMatrix`. Taking a view copies nothing.
+ *
+ * The spans cover the padded elements: those past `size()` are zero, so that
+ * kernels can run over whole SIMD registers with aligned loads. `T` is
+ * `const __complex_precision` for read-only views, see `ConstSplitSpan`.
+ */
+template <typename T> class BasicSplitSpan final {
+public:
+  BasicSplitSpan(const std::span<T> real, const std::span<T> imag,
+                 const size_t size)
+      : real_(real), imag_(imag), size_(size) {
+    if (real.size() != imag.size() || size > real.size()) {
+      throw std::invalid_argument("Split span sizes do not match");
+    }
+  }
+
+  // A writable view converts to a read-only one.
+  template <typename U>
+    requires std::is_convertible_v<U (*)[], T (*)[]>
+  BasicSplitSpan(const BasicSplitSpan<U> &other)
+      : BasicSplitSpan(other.padded_real(), other.padded_imag(),
+                       other.size()) {}
+
+  [[nodiscard]] Complex get(const size_t i) const {
+    return Complex(real_[i], imag_[i]);
+  }
+
+  void set(const size_t i, const Complex c) const
+    requires(!std::is_const_v<T>)
+  {
+    real_[i] = c.real();
+    imag_[i] = c.imag();
+  }
+
+  /*
+   * @return the real parts, `size()` long.
+   */
+  [[nodiscard]] std::span<T> real() const { return real_.first(size_); }
+
+  /*
+   * @return the imaginary parts, `size()` long.
+   */
+  [[nodiscard]] std::span<T> imag() const { return imag_.first(size_); }
+
+  /*
+   * @return the real parts, `padded_size()` long.
+   */
+  [[nodiscard]] std::span<T> padded_real() const { return real_; }
+
+  /*
+   * @return the imaginary parts, `padded_size()` long.
+   */
+  [[nodiscard]] std::span<T> padded_imag() const { return imag_; }
+
+  [[nodiscard]] size_t size() const { return size_; }
+
+  [[nodiscard]] size_t padded_size() const { return real_.size(); }
+
+private:
+  std::span<T> real_;
+  std::span<T> imag_;
+  size_t size_;
+};
+
+using SplitSpan = BasicSplitSpan<__complex_precision>;
+using ConstSplitSpan = BasicSplitSpan<const __complex_precision>;
+
+/*
+ * This class is a non-owning view over split complex elements lying `stride`
+ * apart, such as a column of a `ComplexVectMatrix`.
+ */
+class StridedSplitSpan final {
+public:
+  StridedSplitSpan(const __complex_precision *real,
+                   const __complex_precision *imag, const size_t size,
+                   const size_t stride)
+      : real_(real), imag_(imag), size_(size), stride_(stride) {}
+
+  [[nodiscard]] Complex get(const size_t i) const {
+    return Complex(real_[i * stride_], imag_[i * stride_]);
+  }
+
+  /*
+   * Copies the elements into the contiguous `result`, which must hold
+   * `size()` elements, conjugating them on the way when `conjugate` is set.
+   */
+  void gather(const SplitSpan result, const bool conjugate = false) const {
+    const auto real = result.padded_real();
+    const auto imag = result.padded_imag();
+    const __complex_precision sign = conjugate ? -1 : 1;
+    for (size_t i = 0; i < size_; i++) {
+      real[i] = real_[i * stride_];
+      imag[i] = sign * imag_[i * stride_];
+    }
+  }
+
+  [[nodiscard]] size_t size() const { return size_; }
+
+  [[nodiscard]] size_t stride() const { return stride_; }
+
+private:
+  const __complex_precision *real_;
+  const __complex_precision *imag_;
+  size_t size_;
+  size_t stride_;
+};
+
+#endif // !SPLIT_SPAN_H
@@ -0,0 +1,135 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SYSTEM_INFO_H
+#define SYSTEM_INFO_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#endif
+
+/*
+ * This class queries the machine the simulator runs on.
+ */
+class SystemInfo {
+public:
+  SystemInfo() = delete;
+
+  /*
+   * @return the size of the L2 cache in bytes, or 1 MiB when it cannot be
+   * detected.
+   */
+  static size_t l2_cache_bytes() {
+    constexpr size_t fallback = size_t(1) << 20;
+#ifdef __APPLE__
+    size_t size = 0;
+    size_t length = sizeof(size);
+    if (sysctlbyname("hw.l2cachesize", &size, &length, nullptr, 0) == 0 &&
+        size > 0) {
+      return size;
+    }
+#elif defined(_SC_LEVEL2_CACHE_SIZE)
+    const auto size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) {
+      return static_cast<size_t>(size);
+    }
+#endif
+    return fallback;
+  }
+
+  /*
+   * x86 instruction set extensions usable on this machine: reported by cpuid
+   * and, for the AVX and AVX-512 registers, saved by the operating system on
+   * context switches. All false on other architectures.
+   */
+  struct CpuFeatures {
+    bool sse41 = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+    bool avx512dq = false;
+  };
+
+  static CpuFeatures cpu_features() {
+    CpuFeatures features;
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||             \
+    defined(_M_IX86)
+    const auto max_leaf = cpuid(0)[0];
+    if (max_leaf < 1) {
+      return features;
+    }
+    const auto leaf1 = cpuid(1);
+    const auto leaf7 = max_leaf >= 7 ? cpuid(7) : std::array<uint32_t, 4>{};
+    const bool osxsave = (leaf1[2] >> 27) & 1;
+    const auto xcr0 = osxsave ? xgetbv() : 0;
+    const bool ymm = (xcr0 & 0x6) == 0x6;
+    const bool zmm = (xcr0 & 0xe6) == 0xe6;
+
+    features.sse41 = (leaf1[2] >> 19) & 1;
+    features.fma = ymm && ((leaf1[2] >> 12) & 1);
+    features.avx2 = ymm && ((leaf7[1] >> 5) & 1);
+    features.avx512f = zmm && ((leaf7[1] >> 16) & 1);
+    features.avx512dq = zmm && ((leaf7[1] >> 17) & 1);
+#endif
+    return features;
+  }
+
+private:
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) ||             \
+    defined(_M_IX86)
+  /*
+   * @return eax, ebx, ecx and edx of cpuid `leaf`, sub-leaf 0.
+   */
+  static std::array<uint32_t, 4> cpuid(const uint32_t leaf) {
+    std::array<uint32_t, 4> regs{};
+#if defined(_MSC_VER)
+    int out[4];
+    __cpuidex(out, static_cast<int>(leaf), 0);
+    for (size_t r = 0; r < 4; r++) {
+      regs[r] = static_cast<uint32_t>(out[r]);
+    }
+#else
+    __cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    return regs;
+  }
+
+  /*
+   * @return XCR0, the register states enabled by the operating system.
+   */
+  static uint64_t xgetbv() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (uint64_t(edx) << 32) | eax;
+#endif
+  }
+#endif
+};
+
+#endif // !SYSTEM_INFO_H
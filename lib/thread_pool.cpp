@@ -0,0 +1,294 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "thread_pool.h"
+#include "numa.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+// Chunks handed out per thread, so that uneven chunks can balance out.
+constexpr size_t chunks_per_thread = 4;
+
+// Set on the pool's own threads, whose nested loops run serially.
+thread_local const ThreadPool *worker_pool = nullptr;
+thread_local size_t worker_index = 0;
+
+struct ThreadPool::Job {
+  Job(const std::function<void(size_t, size_t)> &f, const size_t count,
+      const size_t grain, const Schedule schedule)
+      : f(f), count(count), grain(grain),
+        num_chunks((count + grain - 1) / grain), schedule(schedule),
+        taken(std::make_unique<std::atomic<bool>[]>(num_chunks)) {}
+
+  /*
+   * Whether thread `thread` can still take a chunk.
+   */
+  [[nodiscard]] bool has_work(const size_t thread) const {
+    if (schedule == Schedule::Static) {
+      return thread < num_chunks && !taken[thread];
+    }
+    return next_chunk < num_chunks;
+  }
+
+  const std::function<void(size_t, size_t)> &f;
+  const size_t count;
+  const size_t grain;
+  const size_t num_chunks;
+  const Schedule schedule;
+  // Chunks taken so far under `Static`, or next chunk under `Dynamic`.
+  std::atomic<size_t> next_chunk = 0;
+  std::unique_ptr<std::atomic<bool>[]> taken;
+  std::atomic<size_t> done_chunks = 0;
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable finished;
+};
+
+ThreadPool::ThreadPool(const size_t num_workers) { start(num_workers); }
+
+ThreadPool::~ThreadPool() { stop(); }
+
+ThreadPool &ThreadPool::instance() {
+  static ThreadPool pool([] {
+    size_t num_threads = std::thread::hardware_concurrency();
+    if (const auto *env = std::getenv("HILBERT_NUM_THREADS")) {
+      num_threads = std::stoul(env);
+    }
+    return num_threads > 1 ? num_threads - 1 : 0;
+  }());
+  return pool;
+}
+
+void ThreadPool::resize(const size_t num_workers) {
+  stop();
+  start(num_workers);
+}
+
+void ThreadPool::start(const size_t num_workers) {
+  std::vector<size_t> cpus;
+  for (const auto &node : Numa::nodes()) {
+    cpus.insert(cpus.end(), node.begin(), node.end());
+  }
+  const auto pin = num_workers < cpus.size();
+  stopping_ = false;
+  task_queues_.resize(num_workers);
+  for (auto &queue : task_queues_) {
+    queue = std::make_unique<TaskQueue>();
+  }
+  workers_.reserve(num_workers);
+  for (size_t w = 0; w < num_workers; w++) {
+    // The first CPU is left to the thread that calls the loops.
+    const auto cpu = pin ? cpus[w + 1] : 0;
+    workers_.emplace_back([this, w, pin, cpu] {
+      if (pin) {
+        Numa::pin_thread({cpu});
+      }
+      worker_pool = this;
+      worker_index = w;
+      work();
+    });
+  }
+}
+
+void ThreadPool::stop() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  task_queues_.clear();
+}
+
+void ThreadPool::work() {
+  while (true) {
+    if (run_task()) {
+      continue;
+    }
+    const auto thread = worker_index + 1;
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock lock(mutex_);
+      wake_.wait(lock, [this, thread, &job] {
+        job = next_job(thread);
+        return stopping_ || job || pending_tasks_ > 0;
+      });
+      // Only a stopping pool lets its workers go: `run_task` takes a task
+      // off its deque before counting it out, outside `mutex_`, so the count
+      // can read zero while a run still has tasks on the way.
+      if (!job && stopping_ && pending_tasks_ <= 0) {
+        return;
+      }
+    }
+    if (job) {
+      run_chunks(job, thread);
+    }
+  }
+}
+
+void ThreadPool::push_task(std::function<void()> task) {
+  const auto queue = worker_pool == this
+                         ? worker_index
+                         : next_queue_.fetch_add(1) % task_queues_.size();
+  {
+    // The count may briefly go negative, if the task is stolen before it is
+    // counted, but never stays positive with every deque empty.
+    std::lock_guard lock(mutex_);
+    {
+      std::lock_guard queue_lock(task_queues_[queue]->mutex);
+      task_queues_[queue]->tasks.push_back(std::move(task));
+    }
+    pending_tasks_++;
+  }
+  wake_.notify_one();
+}
+
+bool ThreadPool::run_task() {
+  std::function<void()> task;
+  const auto num_queues = task_queues_.size();
+  const auto own = worker_pool == this;
+  if (own) {
+    auto &queue = *task_queues_[worker_index];
+    std::lock_guard lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+  }
+  for (size_t i = own ? 1 : 0; !task && i < num_queues; i++) {
+    auto &queue = *task_queues_[(worker_index + i) % num_queues];
+    std::lock_guard lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+  }
+  if (!task) {
+    return false;
+  }
+  pending_tasks_--;
+  task();
+  return true;
+}
+
+bool ThreadPool::run_job() {
+  if (worker_pool != this) {
+    return false;
+  }
+  const auto thread = worker_index + 1;
+  std::shared_ptr<Job> job;
+  {
+    std::lock_guard lock(mutex_);
+    job = next_job(thread);
+  }
+  if (!job) {
+    return false;
+  }
+  run_chunks(job, thread);
+  return true;
+}
+
+std::shared_ptr<ThreadPool::Job>
+ThreadPool::next_job(const size_t thread) const {
+  for (const auto &job : jobs_) {
+    if (job->has_work(thread)) {
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void ThreadPool::run_chunks(const std::shared_ptr<Job> &job,
+                            const size_t thread) {
+  while (true) {
+    size_t chunk = thread;
+    if (job->schedule == Schedule::Static) {
+      if (thread >= job->num_chunks || job->taken[thread].exchange(true)) {
+        break;
+      }
+      job->next_chunk++;
+    } else {
+      chunk = job->next_chunk.fetch_add(1);
+      if (chunk >= job->num_chunks) {
+        break;
+      }
+    }
+    const auto start = chunk * job->grain;
+    const auto end = std::min(start + job->grain, job->count);
+    try {
+      job->f(start, end);
+    } catch (...) {
+      std::lock_guard lock(job->mutex);
+      if (!job->error) {
+        job->error = std::current_exception();
+      }
+    }
+    if (job->done_chunks.fetch_add(1) + 1 == job->num_chunks) {
+      std::lock_guard lock(job->mutex);
+      job->finished.notify_all();
+    }
+  }
+
+  // Once every chunk has been handed out, no thread needs to pick the job up.
+  if (job->next_chunk < job->num_chunks) {
+    return;
+  }
+  std::lock_guard lock(mutex_);
+  const auto it = std::find(jobs_.begin(), jobs_.end(), job);
+  if (it != jobs_.end()) {
+    jobs_.erase(it);
+  }
+}
+
+void ThreadPool::parallel_for(const size_t count,
+                              const std::function<void(size_t, size_t)> &f,
+                              const size_t min_grain,
+                              const Schedule schedule) {
+  if (count == 0) {
+    return;
+  }
+  const auto num_threads = workers_.size() + 1;
+  const auto num_chunks = schedule == Schedule::Static
+                              ? num_threads
+                              : num_threads * chunks_per_thread;
+  const auto grain = std::max<size_t>(
+      {min_grain, 1, (count + num_chunks - 1) / num_chunks});
+  if (workers_.empty() || worker_pool == this || count <= grain) {
+    f(0, count);
+    return;
+  }
+
+  auto job = std::make_shared<Job>(f, count, grain, schedule);
+  {
+    std::lock_guard lock(mutex_);
+    jobs_.push_back(job);
+  }
+  wake_.notify_all();
+
+  // The calling thread works on its own loop rather than sleeping.
+  run_chunks(job, 0);
+  std::unique_lock lock(job->mutex);
+  job->finished.wait(
+      lock, [&job] { return job->done_chunks == job->num_chunks; });
+  if (job->error) {
+    std::rethrow_exception(job->error);
+  }
+}
@@ -0,0 +1,179 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/*
+ * How the chunks of a parallel loop are assigned to threads:
+ * - `Dynamic` hands chunks out one at a time, to whichever thread is free.
+ * - `Static` cuts the loop into one chunk per thread, and always gives chunk
+ *   `t` to the same thread, so that data first touched by a static loop stays
+ *   on that thread's NUMA node for later static loops. Chunk 0 runs on the
+ *   thread calling the loop, which is not pinned, unlike the workers. A
+ *   worker waiting on a future takes its chunk meanwhile, so that a static
+ *   loop never waits on a worker that is itself waiting.
+ *   Loops over the same buffer should cut it with `parallel_for_static`.
+ */
+enum class Schedule { Dynamic, Static };
+
+/*
+ * This class is a process-wide pool of worker threads, started once and reused
+ * by every parallel loop, so that small loops do not pay for spawning threads.
+ *
+ * A loop over [0, count) is cut into chunks that the workers, and the calling
+ * thread, take one at a time from a shared counter, so that chunks of unequal
+ * cost balance out. Loops no longer than `min_grain`, and loops started from
+ * within a worker, run on the calling thread. Workers are pinned to distinct
+ * CPUs, filling one NUMA node before the next, when there are enough CPUs.
+ *
+ * Independent tasks are queued on one deque per worker: a worker runs its own
+ * tasks newest first, and steals the oldest tasks of the others when it runs
+ * out. A thread waiting on a task's future runs queued tasks meanwhile, so
+ * that tasks can wait on the tasks they submitted without blocking a worker.
+ */
+class ThreadPool final {
+public:
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /*
+   * Starts `num_workers` threads. With no workers, every loop runs on the
+   * calling thread.
+   */
+  explicit ThreadPool(size_t num_workers);
+
+  ~ThreadPool();
+
+  /*
+   * @return the pool shared by the whole process. Its size is read from the
+   * environment variable HILBERT_NUM_THREADS (the total number of threads,
+   * the caller included), or else from the number of hardware threads.
+   */
+  static ThreadPool &instance();
+
+  [[nodiscard]] size_t num_workers() const { return workers_.size(); }
+
+  /*
+   * Stops the workers and starts `num_workers` new ones. It must not be called
+   * while a loop is running.
+   */
+  void resize(size_t num_workers);
+
+  /*
+   * Calls `f(start, end)` on chunks covering [0, count), in parallel, and
+   * returns once all of them are done. Chunks are never shorter than
+   * `min_grain`. If `f` throws, the first exception is rethrown here.
+   */
+  void parallel_for(size_t count, const std::function<void(size_t, size_t)> &f,
+                    size_t min_grain = 1,
+                    Schedule schedule = Schedule::Dynamic);
+
+  /*
+   * Queues `task` on the calling worker's deque, or on the workers' deques in
+   * turn when called from outside the pool. With no workers, the task runs
+   * immediately.
+   * @return the future of the result of `task`.
+   */
+  template <typename F>
+  std::future<std::invoke_result_t<F>> submit(F task) {
+    using R = std::invoke_result_t<F>;
+    auto packaged = std::make_shared<std::packaged_task<R()>>(std::move(task));
+    auto future = packaged->get_future();
+    if (workers_.empty()) {
+      (*packaged)();
+    } else {
+      push_task([packaged] { (*packaged)(); });
+    }
+    return future;
+  }
+
+  /*
+   * Waits for `future`, running queued tasks, and on a worker the chunks of
+   * loops left to it, until it is ready.
+   * @return the result of the task, or rethrows its exception.
+   */
+  template <typename T> T wait(std::future<T> &future) {
+    while (future.wait_for(std::chrono::seconds(0)) !=
+           std::future_status::ready) {
+      if (!run_task() && !run_job()) {
+        std::this_thread::yield();
+      }
+    }
+    return future.get();
+  }
+
+private:
+  struct Job;
+
+  struct TaskQueue {
+    std::mutex mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  void push_task(std::function<void()> task);
+
+  /*
+   * Runs one queued task, if any: the newest of the calling worker's own, or
+   * else the oldest of another deque.
+   * @return whether a task was run.
+   */
+  bool run_task();
+
+  /*
+   * Runs the chunks left to the calling worker in the first job that has any.
+   * From outside the pool, it does nothing.
+   * @return whether a job was found.
+   */
+  bool run_job();
+
+  void start(size_t num_workers);
+
+  void stop();
+
+  void work();
+
+  /*
+   * @return the first job with a chunk left for thread `thread`, where the
+   * caller of a loop is thread 0 and worker `w` is thread `w + 1`.
+   */
+  std::shared_ptr<Job> next_job(size_t thread) const;
+
+  void run_chunks(const std::shared_ptr<Job> &job, size_t thread);
+
+  std::vector<std::thread> workers_;
+  std::vector<std::unique_ptr<TaskQueue>> task_queues_;
+  std::atomic<std::ptrdiff_t> pending_tasks_ = 0;
+  std::atomic<size_t> next_queue_ = 0;
+  std::deque<std::shared_ptr<Job>> jobs_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+};
+
+#endif // !THREAD_POOL_H
@@ -0,0 +1,126 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef UNITARY_GATE_H
+#define UNITARY_GATE_H
+
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * This class represents a dense k-qubit gate: a 2^k x 2^k matrix together
+ * with the qubits it acts on. Bit `q` of a local basis index stands for qubit
+ * `qubits[q]`. It is the common currency of gate fusion, which multiplies
+ * runs of gates into a single `UnitaryGate`.
+ */
+class UnitaryGate final {
+public:
+  UnitaryGate(ComplexVectMatrix matrix, std::vector<size_t> qubits)
+      : matrix_(std::move(matrix)), qubits_(std::move(qubits)) {
+    if (qubits_.empty() || matrix_.row_size() != matrix_.column_size() ||
+        matrix_.row_size() != (size_t(1) << qubits_.size())) {
+      throw std::invalid_argument("Gate must be a 2^k x 2^k matrix");
+    }
+    auto sorted = qubits_;
+    std::sort(sorted.begin(), sorted.end());
+    if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end()) {
+      throw std::invalid_argument("Qubits must be distinct");
+    }
+  }
+
+  /*
+   * The 2^t x 2^t `u` on the qubits `targets`, applied where all the qubits in
+   * `controls` are set, as a dense gate over the targets and their controls.
+   */
+  static std::unique_ptr<UnitaryGate>
+  controlled(const ComplexVectMatrix &u, const std::vector<size_t> &targets,
+             const std::vector<size_t> &controls) {
+    std::vector<size_t> qubits = targets;
+    qubits.insert(qubits.end(), controls.begin(), controls.end());
+    const size_t dim = size_t(1) << qubits.size();
+    const size_t block_size = u.row_size();
+    // Targets are the low bits, so the controlled block is the last one.
+    const size_t block = dim - block_size;
+    ComplexVector m(dim * dim);
+    for (size_t i = 0; i < block; i++) {
+      m[i * dim + i] = 1;
+    }
+    for (size_t r = 0; r < block_size; r++) {
+      for (size_t c = 0; c < block_size; c++) {
+        m[(block + r) * dim + block + c] = u.get(r, c);
+      }
+    }
+    return std::make_unique<UnitaryGate>(ComplexVectMatrix(m, dim, dim),
+                                         qubits);
+  }
+
+  static std::unique_ptr<UnitaryGate>
+  controlled(const ComplexVectMatrix &u, const size_t target,
+             const std::vector<size_t> &controls) {
+    return controlled(u, std::vector<size_t>({target}), controls);
+  }
+
+  [[nodiscard]] const ComplexVectMatrix &matrix() const { return matrix_; }
+
+  [[nodiscard]] const std::vector<size_t> &qubits() const { return qubits_; }
+
+  [[nodiscard]] size_t num_qubits() const { return qubits_.size(); }
+
+  /*
+   * @return the same gate over `qubits`, a superset of its own qubits in any
+   * order, acting as the identity on the added ones.
+   */
+  [[nodiscard]] std::unique_ptr<UnitaryGate>
+  expand(const std::vector<size_t> &qubits) const {
+    std::vector<size_t> positions;
+    size_t own_bits = 0;
+    for (auto q : qubits_) {
+      const auto it = std::find(qubits.begin(), qubits.end(), q);
+      if (it == qubits.end()) {
+        throw std::invalid_argument("Qubits must contain the gate's qubits");
+      }
+      positions.push_back(static_cast<size_t>(it - qubits.begin()));
+      own_bits |= size_t(1) << positions.back();
+    }
+    const auto local = [&positions](size_t index) {
+      size_t l = 0;
+      for (size_t q = 0; q < positions.size(); q++) {
+        l |= ((index >> positions[q]) & 1) << q;
+      }
+      return l;
+    };
+
+    const size_t dim = size_t(1) << qubits.size();
+    ComplexVector m(dim * dim);
+    for (size_t r = 0; r < dim; r++) {
+      for (size_t c = 0; c < dim; c++) {
+        if ((r & ~own_bits) == (c & ~own_bits)) {
+          m[r * dim + c] = matrix_.get(local(r), local(c));
+        }
+      }
+    }
+    return std::make_unique<UnitaryGate>(ComplexVectMatrix(m, dim, dim),
+                                         qubits);
+  }
+
+private:
+  ComplexVectMatrix matrix_;
+  std::vector<size_t> qubits_;
+};
+
+#endif // !UNITARY_GATE_H
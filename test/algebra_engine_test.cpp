@@ -15,7 +15,12 @@
 #include "algebra_engine.h"
 #include "complex_vectorised_matrix.h"
 #include "hilbert_namespace_test.h"
+#include "thread_pool.h"
+#include <cmath>
+#include <complex>
 #include <memory>
+#include <stdexcept>
+#include <utility>
 
 bool it_should_compute_conjugate_transpose() {
   // Given
@@ -84,6 +89,64 @@ bool it_should_compute_matrix_vector_product() {
   return are_matrices_equal(*expected, *result);
 }
 
+/*
+ * Whether `a` and `b` are equal, infinities included, or both have a NaN
+ * part.
+ */
+bool same_element(const Complex a, const Complex b) {
+  const auto is_nan = [](const Complex c) {
+    return std::isnan(c.real()) || std::isnan(c.imag());
+  };
+  return is_nan(a) ? is_nan(b) : a == b || approx_equal(a, b);
+}
+
+bool it_should_multiply_alike_by_rows_elements_and_whole() {
+  // Given: zero coefficients on the left, facing an infinity on the right.
+  ComplexVector left_elements(3 * 4, Complex(0.5, -0.25));
+  left_elements[1 * 4] = 0;
+  left_elements[2 * 4] = 0;
+  ComplexVector right_elements(4 * 5, Complex(-0.75, 1));
+  right_elements[2] = Complex(INFINITY, 0);
+  const auto left = ComplexVectMatrix(left_elements, 3, 4);
+  const auto right = ComplexVectMatrix(right_elements, 4, 5);
+
+  // When
+  const auto product = AlgebraEngine::matrix_multiplication(left, right);
+  const auto whole = product->to_matrix();
+
+  // Then: 0 * inf is NaN, whichever way the product is computed.
+  for (size_t m = 0; m < whole->row_size(); m++) {
+    const auto row = product->get(m);
+    for (size_t n = 0; n < whole->column_size(); n++) {
+      if (!same_element(row->get(n), whole->get(m, n)) ||
+          !same_element(product->get(m, n), whole->get(m, n))) {
+        return false;
+      }
+    }
+  }
+  return std::isnan(whole->get(1, 2).real());
+}
+
+bool it_should_build_dense_product_rows() {
+  // Given
+  constexpr size_t size = 512;
+  const auto left = random_matrix(size, size, 3);
+  const auto right = random_matrix(size, size, 4);
+  const auto product = AlgebraEngine::matrix_multiplication(left, right);
+
+  // When
+  auto perf_test = pt_start(std::to_string(size) + "x" +
+                            std::to_string(size) + " dense product by rows");
+  bool all_rows = true;
+  for (size_t m = 0; m < size; m++) {
+    all_rows = all_rows && product->get(m)->size() == size;
+  }
+  pt_stop(perf_test);
+
+  // Then
+  return all_rows;
+}
+
 bool it_should_compute_scalar_product() {
   // Given
   auto a = ComplexVectMatrix::identity_2x2();
@@ -170,6 +233,270 @@ bool it_should_compute_matrix_power() {
   return verify_identity_matrix(*actual, std::pow(2, times));
 }
 
+bool it_should_apply_large_tensor_power() {
+  // Given: far more factors than the lazy tensor product can materialise.
+  auto h = ComplexVectMatrix::hadamard_2x2();
+  constexpr size_t times = 22;
+  const auto size = size_t(1) << times;
+  ComplexVectMatrix zero(1, size);
+  zero.real_data()[0] = 1;
+
+  // When
+  auto perf_test_setup = pt_start(std::to_string(times) + " Kronecker factors");
+  const auto op = AlgebraEngine::kronecker_power(*h, times);
+  pt_stop(perf_test_setup);
+  const auto perf_test_apply = pt_start("vec-trick application");
+  const auto actual = op->apply(zero);
+  pt_stop(perf_test_apply);
+
+  // Then: H^n|0...0> is the uniform superposition.
+  const auto amplitude = Complex(1 / std::sqrt(__complex_precision(size)));
+  for (size_t n = 0; n < size; n++) {
+    if (!approx_equal(actual->get(0, n), amplitude)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool it_should_apply_rectangular_tensor_product() {
+  // Given: factors whose intermediate tensor, applied from the last, is far
+  // larger than both the vector and the result.
+  constexpr size_t size = 200;
+  ComplexVector row(size);
+  ComplexVector column(size);
+  for (size_t i = 0; i < size; i++) {
+    row[i] = Complex(__complex_precision(i % 7) - 3, 1);
+    column[i] = Complex(1, __complex_precision(i % 5) - 2);
+  }
+  const KroneckerOperator op({ComplexVectMatrix(row, 1, size),
+                              ComplexVectMatrix(column, size, 1)});
+  const auto vects = random_amplitudes(op.column_size(), 3);
+
+  // When
+  const auto actual = op.apply(*vects);
+
+  // Then
+  const auto expected = GemmEngine::multiply_vectors(*op.to_matrix(), *vects);
+  if (actual->row_size() != 1 || actual->column_size() != size) {
+    return false;
+  }
+  for (size_t n = 0; n < size; n++) {
+    if (std::abs(actual->get(0, n) - expected->get(0, n)) > 1e-3) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Whether `vect` is the tensor product of `times` qubits 0.6|0> + 0.8i|1>.
+ */
+bool is_qubit_power(const ComplexVectMatrix &vect, const size_t times) {
+  if (vect.row_size() != 1 || vect.column_size() != (size_t(1) << times)) {
+    return false;
+  }
+  for (size_t n = 0; n < vect.column_size(); n++) {
+    Complex expected = 1;
+    for (size_t t = 0; t < times; t++) {
+      expected *= ((n >> t) & 1) ? Complex(0, 0.8) : Complex(0.6);
+    }
+    if (!approx_equal(vect.get(0, n), expected)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool it_should_materialise_vector_in_column_tiles() {
+  // Given
+  auto &pool = ThreadPool::instance();
+  const auto num_workers = pool.num_workers();
+  auto q = ComplexVectMatrix(ComplexMatrix({{{0.6, 0}, {0, 0.8}}}));
+  constexpr size_t times = 14;
+  const auto lazy = AlgebraEngine::tensor_product(q, times);
+
+  // When
+  pool.resize(3);
+  const auto tiled = lazy->to_matrix();
+  pool.resize(0);
+  const auto whole_row = lazy->to_matrix();
+  pool.resize(num_workers);
+
+  // Then
+  return is_qubit_power(*tiled, times) && is_qubit_power(*whole_row, times);
+}
+
+/*
+ * Whether the columns [col_begin, col_end) of row `row` of `lazy` match the
+ * whole row.
+ */
+bool is_row_range(const LazyOperation &lazy, const size_t row,
+                  const size_t col_begin, const size_t col_end) {
+  const auto whole_row = lazy.get(row);
+  const auto range = lazy.get(row, col_begin, col_end);
+  if (range->size() != col_end - col_begin) {
+    return false;
+  }
+  for (size_t n = col_begin; n < col_end; n++) {
+    if (!approx_equal(range->get(n - col_begin), whole_row->get(n))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool it_should_get_column_range_of_row() {
+  // Given
+  auto h = ComplexVectMatrix::hadamard_2x2();
+  auto q = ComplexVectMatrix(ComplexMatrix({{{0.6, 0}, {0, 0.8}}}));
+  constexpr size_t times = 10;
+  const auto vect = AlgebraEngine::tensor_product(q, times)->to_matrix();
+  const auto mat = AlgebraEngine::tensor_product(*h, times)->to_matrix();
+
+  // When
+  const auto tensor = AlgebraEngine::tensor_product(q, times);
+  const auto sum =
+      AlgebraEngine::sum(*vect, *AlgebraEngine::tensor_product(q, times));
+  const auto product = AlgebraEngine::matrix_vector_product(*mat, *vect);
+  const auto lazy_product = AlgebraEngine::matrix_vector_product(
+      AlgebraEngine::tensor_product(*h, times), *vect);
+  const auto scalar = AlgebraEngine::scalar_product(*vect, Complex(0, 2));
+  const auto outer = AlgebraEngine::outer_product(q, *vect);
+
+  // Then
+  return is_row_range(*tensor, 0, 3, 1000) && is_row_range(*sum, 0, 5, 517) &&
+         is_row_range(*product, 0, 1, 1023) &&
+         is_row_range(*lazy_product, 0, 100, 130) &&
+         is_row_range(*scalar, 0, 17, 17) && is_row_range(*outer, 1, 9, 1024);
+}
+
+bool it_should_materialise_large_vector() {
+  // Given
+  auto q = ComplexVectMatrix(ComplexMatrix({{{0.6, 0}, {0, 0.8}}}));
+  constexpr size_t times = 18;
+  const auto lazy = AlgebraEngine::tensor_product(q, times);
+
+  // When
+  auto perf_test = pt_start("1x2^" + std::to_string(times) +
+                            " vector materialisation");
+  const auto actual = lazy->to_matrix();
+  pt_stop(perf_test);
+  print_info(std::to_string(ThreadPool::instance().num_workers() + 1) +
+             " threads");
+
+  // Then
+  return is_qubit_power(*actual, times);
+}
+
+bool it_should_evaluate_independent_branches() {
+  // Given
+  auto &pool = ThreadPool::instance();
+  const auto num_workers = pool.num_workers();
+  auto h = ComplexVectMatrix::hadamard_2x2();
+  auto q = ComplexVectMatrix(ComplexMatrix({{{0.6, 0}, {0, 0.8}}}));
+  constexpr size_t times = 6;
+  const auto lazy = AlgebraEngine::matrix_vector_product(
+      AlgebraEngine::tensor_product(*h, times),
+      AlgebraEngine::tensor_product(q, times));
+
+  // When
+  pool.resize(3);
+  const auto parallel = lazy->to_matrix();
+  pool.resize(num_workers);
+
+  // Then
+  const auto hq = AlgebraEngine::matrix_vector_product(*h, q)->to_matrix();
+  const auto expected = AlgebraEngine::tensor_product(*hq, times)->to_matrix();
+  return *expected == *parallel;
+}
+
+bool it_should_propagate_branch_exception() {
+  // Given
+  auto &pool = ThreadPool::instance();
+  const auto num_workers = pool.num_workers();
+  auto h = ComplexVectMatrix::hadamard_2x2();
+  constexpr size_t times = 6;
+  auto failing = std::make_unique<LazyOperation>(
+      ComplexVectMatrix(1, size_t{1} << times),
+      [](const ComplexVectMatrix &, const ComplexVectMatrix &,
+         const size_t) -> std::unique_ptr<ComplexVectSplit> {
+        throw std::runtime_error("Failing operand");
+      });
+  const auto lazy = AlgebraEngine::matrix_vector_product(
+      AlgebraEngine::tensor_product(*h, times), std::move(failing));
+
+  // When - Then
+  pool.resize(3);
+  try {
+    (void)lazy->to_matrix();
+    pool.resize(num_workers);
+    return false;
+  } catch (const std::runtime_error &) {
+    pool.resize(num_workers);
+    return true;
+  }
+}
+
+bool it_should_evaluate_large_branches() {
+  // Given
+  auto h = ComplexVectMatrix::hadamard_2x2();
+  auto q = ComplexVectMatrix(ComplexMatrix({{{0.6, 0}, {0, 0.8}}}));
+  constexpr size_t times = 9;
+  const auto lazy = AlgebraEngine::matrix_vector_product(
+      AlgebraEngine::tensor_product(*h, times),
+      AlgebraEngine::tensor_product(q, times));
+
+  // When
+  auto perf_test = pt_start("2^" + std::to_string(times) +
+                            " matrix-vector product of lazy operands");
+  const auto actual = lazy->to_matrix();
+  pt_stop(perf_test);
+
+  // Then
+  const auto hq = AlgebraEngine::matrix_vector_product(*h, q)->to_matrix();
+  const auto expected = AlgebraEngine::tensor_product(*hq, times)->to_matrix();
+  return *expected == *actual;
+}
+
+bool it_should_multiply_lazy_operands_by_vectors() {
+  // Given: a lazy matrix, and two vectors as the rows of a matrix.
+  auto h = ComplexVectMatrix::hadamard_2x2();
+  constexpr size_t times = 4;
+  const auto mat = AlgebraEngine::tensor_product(*h, times)->to_matrix();
+  const auto vect = random_amplitudes(mat->column_size(), 2);
+  auto two = ComplexVector(2 * vect->column_size());
+  for (size_t n = 0; n < vect->column_size(); n++) {
+    two[n] = vect->get(0, n);
+    two[vect->column_size() + n] = std::conj(vect->get(0, n));
+  }
+  const auto two_vects = ComplexVectMatrix(two, 2, vect->column_size());
+
+  // When
+  const auto by_gemv =
+      AlgebraEngine::matrix_vector_product(*mat, two_vects)->to_matrix();
+  const auto lazy_mat = AlgebraEngine::matrix_vector_product(
+      AlgebraEngine::tensor_product(*h, times), two_vects);
+  const auto lazy_both = AlgebraEngine::matrix_vector_product(
+      AlgebraEngine::tensor_product(*h, times),
+      std::make_unique<LazyOperation>(two_vects));
+
+  // Then: as the rows, computed on demand.
+  for (const auto *lazy : {lazy_mat.get(), lazy_both.get()}) {
+    const auto actual = lazy->to_matrix();
+    for (size_t r = 0; r < 2; r++) {
+      const auto row = lazy->get(r);
+      for (size_t m = 0; m < mat->row_size(); m++) {
+        if (!approx_equal(actual->get(r, m), by_gemv->get(r, m)) ||
+            !approx_equal(row->get(m), by_gemv->get(r, m))) {
+          return false;
+        }
+      }
+    }
+  }
+  return by_gemv->row_size() == 2 && by_gemv->column_size() == 16;
+}
+
 bool it_should_verify_unitarity() {
   // Given
   auto a = ComplexVectMatrix::hadamard_2x2();
@@ -207,15 +534,48 @@ int main() {
   run_test("it_should_compute_outer_product", it_should_compute_outer_product,
            failed, total, true);
 
+  run_test("it_should_multiply_alike_by_rows_elements_and_whole",
+           it_should_multiply_alike_by_rows_elements_and_whole, failed, total,
+           true);
+
+  run_test("it_should_build_dense_product_rows",
+           it_should_build_dense_product_rows, failed, total, false);
+
   run_test("it_should_compute_matrix_vector_product",
            it_should_compute_matrix_vector_product, failed, total, true);
 
+  run_test("it_should_multiply_lazy_operands_by_vectors",
+           it_should_multiply_lazy_operands_by_vectors, failed, total, true);
+
   run_test("it_should_verify_unitarity", it_should_verify_unitarity, failed,
            total, false);
 
   run_test("it_should_compute_matrix_power", it_should_compute_matrix_power,
            failed, total, false);
 
+  run_test("it_should_apply_large_tensor_power",
+           it_should_apply_large_tensor_power, failed, total, false);
+
+  run_test("it_should_apply_rectangular_tensor_product",
+           it_should_apply_rectangular_tensor_product, failed, total, true);
+
+  run_test("it_should_materialise_vector_in_column_tiles",
+           it_should_materialise_vector_in_column_tiles, failed, total, true);
+
+  run_test("it_should_get_column_range_of_row",
+           it_should_get_column_range_of_row, failed, total, true);
+
+  run_test("it_should_materialise_large_vector",
+           it_should_materialise_large_vector, failed, total, false);
+
+  run_test("it_should_evaluate_independent_branches",
+           it_should_evaluate_independent_branches, failed, total, true);
+  run_test("it_should_propagate_branch_exception",
+           it_should_propagate_branch_exception, failed, total, true);
+
+  run_test("it_should_evaluate_large_branches",
+           it_should_evaluate_large_branches, failed, total, false);
+
   test_resumen(failed, total);
   return failed == 0 ? 0 : 1;
 }
@@ -13,9 +13,12 @@
 // limitations under the License.
 
 #include "circuit_engine.h"
+#include "dense_state.h"
 #include "hilbert_namespace_test.h"
 #include "qubit.h"
 #include "state_vector.h"
+#include <cmath>
+#include <string>
 #include <vector>
 
 bool it_should_compute_qft() {
@@ -56,6 +59,113 @@ bool it_should_compute_qft_and_inverse() {
   return state == *state_iqft;
 }
 
+bool it_should_compute_dense_qft() {
+  // Given
+  auto ket_0_q = Qubit(1, 0);
+  auto ket_1_q = Qubit(0, 1);
+  auto state = StateVector({ket_1_q, ket_0_q, ket_1_q, ket_1_q, ket_0_q});
+  auto dense_state = DenseState(state);
+
+  // When
+  CircuitEngine::qft(dense_state);
+
+  // Then
+  return DenseState(*CircuitEngine::qft(state)) == dense_state;
+}
+
+bool it_should_compute_dense_qft_and_inverse() {
+  // Given
+  constexpr size_t num_qubits = 16;
+  auto ket_0_q = Qubit(1, 0);
+  auto ket_1_q = Qubit(0, 1);
+  std::vector<Qubit> qubits(num_qubits, ket_0_q);
+  qubits[3] = ket_1_q;
+  qubits[11] = ket_1_q;
+  auto state = DenseState(StateVector(qubits));
+
+  // When
+  auto perf_test_qft = pt_start(std::to_string(num_qubits) + " qubits QFT");
+  CircuitEngine::qft(state);
+  pt_stop(perf_test_qft);
+  CircuitEngine::inverse_qft(state);
+
+  // Then
+  return DenseState(StateVector(qubits)) == state;
+}
+
+bool it_should_compute_fft_qft() {
+  bool all_equal = true;
+  for (const size_t num_qubits : {1, 2, 3, 5, 10, 14, 15, 16}) {
+    // Given
+    auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 17);
+    auto state = DenseState(*amplitudes);
+    auto expected = DenseState(*amplitudes);
+
+    // When
+    CircuitEngine::qft(state, QftMode::Fft);
+
+    // Then
+    CircuitEngine::qft(expected, QftMode::Gates);
+    all_equal = all_equal && expected == state;
+  }
+  return all_equal;
+}
+
+bool it_should_compute_fft_qft_and_inverse() {
+  // Given
+  constexpr size_t num_qubits = 17;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 19);
+  auto state = DenseState(*amplitudes);
+
+  // When
+  CircuitEngine::qft(state, QftMode::Fft);
+  CircuitEngine::inverse_qft(state, QftMode::Fft);
+
+  // Then
+  return DenseState(*amplitudes) == state;
+}
+
+bool it_should_compute_double_fft_qft() {
+  bool all_close = true;
+  for (const size_t num_qubits : {1, 2, 3, 5, 10, 14}) {
+    // Given
+    auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 29);
+    auto state = DoubleDenseState(*amplitudes);
+    auto expected = DoubleDenseState(*amplitudes);
+
+    // When
+    CircuitEngine::qft(state, QftMode::Fft);
+
+    // Then
+    CircuitEngine::qft(expected, QftMode::Gates);
+    for (size_t i = 0; i < state.size(); i++) {
+      all_close = all_close && std::abs(state.get(i) - expected.get(i)) < 1e-12;
+    }
+  }
+  return all_close;
+}
+
+bool it_should_compute_large_fft_qft() {
+  // Given
+  constexpr size_t num_qubits = 20;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 23);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+
+  // When
+  auto perf_test_fft =
+      pt_start(std::to_string(num_qubits) + " qubits QFT, FFT mode");
+  CircuitEngine::qft(state, QftMode::Fft);
+  pt_stop(perf_test_fft);
+
+  // Then
+  auto perf_test_gates =
+      pt_start(std::to_string(num_qubits) + " qubits QFT, gates mode");
+  CircuitEngine::qft(expected, QftMode::Gates);
+  pt_stop(perf_test_gates);
+  return expected == state;
+}
+
 int main() {
   int total = 0;
   int failed = 0;
@@ -65,6 +175,24 @@ int main() {
   run_test("it_should_compute_qft_and_inverse",
            it_should_compute_qft_and_inverse, failed, total);
 
+  run_test("it_should_compute_dense_qft", it_should_compute_dense_qft, failed,
+           total);
+
+  run_test("it_should_compute_dense_qft_and_inverse",
+           it_should_compute_dense_qft_and_inverse, failed, total);
+
+  run_test("it_should_compute_fft_qft", it_should_compute_fft_qft, failed,
+           total, true);
+
+  run_test("it_should_compute_fft_qft_and_inverse",
+           it_should_compute_fft_qft_and_inverse, failed, total, true);
+
+  run_test("it_should_compute_double_fft_qft",
+           it_should_compute_double_fft_qft, failed, total, true);
+
+  run_test("it_should_compute_large_fft_qft", it_should_compute_large_fft_qft,
+           failed, total, false);
+
   test_resumen(failed, total);
   return failed == 0 ? 0 : 1;
 }
@@ -13,7 +13,32 @@
 // limitations under the License.
 
 #include "complex_vector_split.h"
+#include "complex_vectorised_matrix.h"
 #include "hilbert_namespace_test.h"
+#include "simd.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Whether both parts are 64-byte aligned, padded to whole SIMD registers and
+ * zero past the last element.
+ */
+bool is_padded(const ComplexVectSplit &cvs) {
+  const auto real = reinterpret_cast<std::uintptr_t>(cvs.real_data());
+  const auto imag = reinterpret_cast<std::uintptr_t>(cvs.imag_data());
+  if (real % 64 != 0 || imag % 64 != 0 ||
+      cvs.padded_size() % ComplexVectSplit::simd_width != 0 ||
+      cvs.padded_size() < cvs.size()) {
+    return false;
+  }
+  for (size_t i = cvs.size(); i < cvs.padded_size(); i++) {
+    if (cvs.real_data()[i] != 0 || cvs.imag_data()[i] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
 
 bool it_should_create_cvs_from_complex_vector() {
   // Given
@@ -59,6 +84,88 @@ bool it_should_conjugate_cvs() {
   return conj_exp == conj_act;
 }
 
+bool it_should_pad_cvs() {
+  // Given
+  auto cvs = ComplexVectSplit(std::vector<Complex>(13, {1, 2}));
+
+  // When
+  for (size_t i = 0; i < 6; i++) {
+    cvs.add({3, 4});
+  }
+
+  // Then
+  return cvs.size() == 19 && cvs.padded_size() == 32 && is_padded(cvs) &&
+         cvs.get(12) == Complex(1, 2) && cvs.get(18) == Complex(3, 4);
+}
+
+bool it_should_keep_padding_through_operations() {
+  // Given
+  auto left = ComplexVectSplit(std::vector<Complex>(11, {1, -2}));
+  auto right = ComplexVectSplit(std::vector<Complex>(11, {0.5, 3}));
+
+  // When
+  auto product = simd::cvmul(left, right);
+  auto sum = simd::cvadd(left, right);
+  auto difference = simd::cvsub(left, right);
+  auto scaled = simd::cvsmul(left, {2, 1});
+  auto conjugate = left.conj();
+
+  // Then
+  return is_padded(*product) && is_padded(*sum) && is_padded(*difference) &&
+         is_padded(*scaled) && is_padded(*conjugate) &&
+         product->get(10) == Complex(6.5, 2) &&
+         approx_equal(simd::cvsve(*sum), Complex(16.5, 11));
+}
+
+bool it_should_view_cvs_without_copy() {
+  // Given
+  auto cvs = ComplexVectSplit(std::vector<Complex>(5, {1, -1}));
+
+  // When
+  const auto view = cvs.span();
+  const ConstSplitSpan read_only = view;
+  view.set(4, {7, 8});
+
+  // Then
+  return view.real().data() == cvs.real_data() &&
+         read_only.imag().data() == cvs.imag_data() &&
+         cvs.real_span().size() == 5 && read_only.padded_size() == 16 &&
+         cvs.get(4) == Complex(7, 8) && read_only.get(4) == Complex(7, 8);
+}
+
+bool it_should_operate_on_views() {
+  // Given
+  const ComplexVectMatrix mat(
+      ComplexMatrix({{1, 2, Complex(0, 1)}, {3, Complex(0, -1), 4}}));
+  auto result = ComplexVectSplit(3);
+
+  // When
+  simd::cvmul(mat.row(0), mat.row(1), result.span());
+  const auto sum = simd::cvadd(mat.row(0), mat.row(1));
+
+  // Then
+  return is_padded(result) && result.get(0) == Complex(3) &&
+         result.get(1) == Complex(0, -2) && result.get(2) == Complex(0, 4) &&
+         is_padded(*sum) && sum->get(2) == Complex(4, 1);
+}
+
+bool it_should_multiply_large_cvs() {
+  // Given
+  constexpr size_t size = (size_t(1) << 22) + 3;
+  auto left = ComplexVectSplit(std::vector<Complex>(size, {1, -2}));
+  auto right = ComplexVectSplit(std::vector<Complex>(size, {0.5, 3}));
+
+  // When
+  auto perf_test = pt_start(std::to_string(size) + " complex products",
+                            6 * sizeof(__complex_precision) * size);
+  auto product = simd::cvmul(left, right);
+  pt_stop(perf_test);
+
+  // Then
+  return is_padded(*product) && product->get(0) == Complex(6.5, 2) &&
+         product->get(size - 1) == Complex(6.5, 2);
+}
+
 int main() {
   int total = 0;
   int failed = 0;
@@ -71,6 +178,20 @@ int main() {
 
   run_test("it_should_conjugate_cvs", it_should_conjugate_cvs, failed, total);
 
+  run_test("it_should_pad_cvs", it_should_pad_cvs, failed, total, true);
+
+  run_test("it_should_keep_padding_through_operations",
+           it_should_keep_padding_through_operations, failed, total, true);
+
+  run_test("it_should_view_cvs_without_copy", it_should_view_cvs_without_copy,
+           failed, total, true);
+
+  run_test("it_should_operate_on_views", it_should_operate_on_views, failed,
+           total, true);
+
+  run_test("it_should_multiply_large_cvs", it_should_multiply_large_cvs,
+           failed, total, false);
+
   test_resumen(failed, total);
   return failed == 0 ? 0 : 1;
 }
@@ -14,7 +14,12 @@
 
 #include "complex_vectorised_matrix.h"
 #include "hilbert_namespace_test.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
+#include <utility>
 
 bool it_should_create_vectorised_matrix() {
   // When
@@ -54,6 +59,75 @@ bool it_should_split_vect_matrix() {
   return real_exp == real_act && imag_exp == imag_act;
 }
 
+bool it_should_view_rows_without_copy() {
+  // Given
+  const ComplexVectMatrix mat(
+      ComplexMatrix({{1, Complex(0, 2), 3}, {4, 5, Complex(6, -1)}}));
+
+  // When
+  const auto first = mat.row(0);
+  const auto second = mat.row(1);
+
+  // Then
+  const auto padding_is_zero = [](std::span<const __complex_precision> s) {
+    return std::all_of(s.begin() + 3, s.end(),
+                       [](__complex_precision x) { return x == 0; });
+  };
+  return first.size() == 3 && first.padded_size() % 8 == 0 &&
+         reinterpret_cast<std::uintptr_t>(second.real().data()) % 32 == 0 &&
+         first.get(1) == Complex(0, 2) && second.get(2) == Complex(6, -1) &&
+         padding_is_zero(first.padded_real()) &&
+         padding_is_zero(second.padded_imag()) &&
+         mat.row(0).real().data() == first.real().data();
+}
+
+bool it_should_view_columns() {
+  // Given
+  const ComplexVectMatrix mat(ComplexVector({1, 2, 3, 4, 5, 6}), 3, 2);
+
+  // When
+  const auto column = mat.column(1);
+  const auto gathered = mat.get_column(1);
+
+  // Then
+  return column.size() == 3 && column.get(0) == Complex(2) &&
+         column.get(2) == Complex(6) &&
+         *gathered->get() == ComplexVector({2, 4, 6});
+}
+
+bool it_should_reject_elements_past_the_row() {
+  // Given
+  const ComplexVectMatrix mat(ComplexVector({1, 2, 3, 4}), 2, 2);
+
+  // When
+  try {
+    (void)mat.get(0, 2);
+  } catch (const std::out_of_range &) {
+    // Then
+    return true;
+  }
+  return false;
+}
+
+bool it_should_reject_mismatched_elements() {
+  // Given
+  const ComplexVector elements({1, 2, 3});
+
+  // When
+  size_t rejected = 0;
+  for (const auto &[rows, columns] :
+       {std::pair<size_t, size_t>(2, 2), std::pair<size_t, size_t>(1, 2)}) {
+    try {
+      const ComplexVectMatrix mat(elements, rows, columns);
+    } catch (const std::invalid_argument &) {
+      rejected++;
+    }
+  }
+
+  // Then
+  return rejected == 2;
+}
+
 int main() {
   int total = 0;
   int failed = 0;
@@ -67,6 +141,17 @@ int main() {
   run_test("it_should_split_vect_matrix", it_should_split_vect_matrix, failed,
            total);
 
+  run_test("it_should_view_rows_without_copy",
+           it_should_view_rows_without_copy, failed, total);
+
+  run_test("it_should_view_columns", it_should_view_columns, failed, total);
+
+  run_test("it_should_reject_elements_past_the_row",
+           it_should_reject_elements_past_the_row, failed, total);
+
+  run_test("it_should_reject_mismatched_elements",
+           it_should_reject_mismatched_elements, failed, total);
+
   test_resumen(failed, total);
   return failed == 0 ? 0 : 1;
 }
@@ -0,0 +1,585 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "complex_vectorised_matrix.h"
+#include "dense_state.h"
+#include "diagonal_gate.h"
+#include "hilbert_namespace_test.h"
+#include "permutation_gate.h"
+#include "qubit.h"
+#include "state_vector.h"
+#include "unitary_gate.h"
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Reference single-qubit gate application, one amplitude pair at a time.
+ */
+void apply_gate_reference(ComplexVector &amplitudes,
+                          const ComplexVectMatrix &gate, const size_t target,
+                          const size_t controls = 0) {
+  const size_t bit = size_t(1) << target;
+  for (size_t i = 0; i < amplitudes.size(); i++) {
+    if ((i & bit) || (i & controls) != controls) {
+      continue;
+    }
+    const auto a = amplitudes[i];
+    const auto b = amplitudes[i | bit];
+    amplitudes[i] = gate.get(0, 0) * a + gate.get(0, 1) * b;
+    amplitudes[i | bit] = gate.get(1, 0) * a + gate.get(1, 1) * b;
+  }
+}
+
+bool it_should_create_zero_state() {
+  // When
+  auto state = DenseState(3);
+
+  // Then
+  bool aligned =
+      reinterpret_cast<std::uintptr_t>(state.real_data()) % 64 == 0 &&
+      reinterpret_cast<std::uintptr_t>(state.imag_data()) % 64 == 0;
+  bool is_zero_state = approx_equal(state.get(0), Complex(1));
+  for (size_t i = 1; i < state.size(); i++) {
+    is_zero_state = is_zero_state && approx_equal(state.get(i), Complex(0));
+  }
+  return aligned && state.size() == 8 && is_zero_state;
+}
+
+bool it_should_expand_state_vector() {
+  // Given
+  auto ket_1_q = Qubit(0, 1);
+  auto ket_plus_q = Qubit(1 / std::sqrt(2), 1 / std::sqrt(2));
+  auto state_vector = StateVector({ket_1_q, ket_plus_q});
+
+  // When
+  auto state = DenseState(state_vector);
+
+  // Then
+  auto h = static_cast<__complex_precision>(1 / std::sqrt(2));
+  auto expected = DenseState(ComplexVectMatrix(ComplexVector({0, 0, h, h})));
+  return expected == state;
+}
+
+bool it_should_factorise_product_state() {
+  // Given
+  auto ket_0_q = Qubit(1, 0);
+  auto ket_1_q = Qubit(0, 1);
+  auto ket_a_q = Qubit(1 / std::sqrt(2), Complex(0, 1 / std::sqrt(2)));
+  auto state_vector = StateVector({ket_a_q, ket_1_q, ket_0_q, ket_a_q});
+
+  // When
+  auto result = DenseState(state_vector).to_state_vector();
+
+  // Then
+  return state_vector == *result;
+}
+
+bool it_should_not_factorise_entangled_state() {
+  // Given
+  auto h = static_cast<__complex_precision>(1 / std::sqrt(2));
+  auto bell = DenseState(ComplexVectMatrix(ComplexVector({h, 0, 0, h})));
+
+  // When - Then
+  try {
+    auto result = bell.to_state_vector();
+    return false;
+  } catch (const std::runtime_error &e) {
+    return true;
+  }
+}
+
+bool it_should_not_factorise_zero_state() {
+  // Given
+  auto zero = DenseState(ComplexVectMatrix(ComplexVector({0, 0, 0, 0})));
+
+  // When - Then
+  try {
+    auto result = zero.to_state_vector();
+    return false;
+  } catch (const std::invalid_argument &e) {
+    return true;
+  }
+}
+
+bool it_should_apply_gate_in_place() {
+  // Given
+  auto state = DenseState(StateVector({Qubit(1, 0), Qubit(0, 1)}));
+
+  // When
+  state.apply_gate(*ComplexVectMatrix::pauli_x(), 0);
+  state.apply_gate(*ComplexVectMatrix::hadamard_2x2(), 1);
+
+  // Then
+  auto ket_plus_q = Qubit(1 / std::sqrt(2), 1 / std::sqrt(2));
+  auto expected = StateVector({ket_plus_q, Qubit(1, 0)});
+  return expected == *state.to_state_vector();
+}
+
+bool it_should_apply_gate_to_every_target() {
+  // Given
+  constexpr size_t num_qubits = 6;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 42);
+  auto gate = ComplexVectMatrix(
+      ComplexMatrix({{{0.6, 0.1}, {-0.3, 0.7}}, {{0.2, -0.5}, {0.8, 0.4}}}));
+
+  bool all_equal = true;
+  for (size_t t = 0; t < num_qubits; t++) {
+    auto state = DenseState(*amplitudes);
+    ComplexVector expected(state.size());
+    for (size_t i = 0; i < state.size(); i++) {
+      expected[i] = amplitudes->get(0, i);
+    }
+
+    // When
+    state.apply_gate(gate, t);
+
+    // Then
+    apply_gate_reference(expected, gate, t);
+    all_equal = all_equal &&
+                DenseState(ComplexVectMatrix(expected, 1, expected.size())) ==
+                    state;
+  }
+  return all_equal;
+}
+
+bool it_should_apply_controlled_gate_to_every_target() {
+  // Given
+  constexpr size_t num_qubits = 6;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 7);
+  auto gate = ComplexVectMatrix(
+      ComplexMatrix({{{0.6, 0.1}, {-0.3, 0.7}}, {{0.2, -0.5}, {0.8, 0.4}}}));
+  const std::vector<size_t> control_masks = {0b000001, 0b000110, 0b001000,
+                                             0b110000, 0b101001, 0b011111};
+
+  bool all_equal = true;
+  for (size_t t = 0; t < num_qubits; t++) {
+    for (auto controls : control_masks) {
+      controls &= ~(size_t(1) << t);
+      auto state = DenseState(*amplitudes);
+      ComplexVector expected(state.size());
+      for (size_t i = 0; i < state.size(); i++) {
+        expected[i] = amplitudes->get(0, i);
+      }
+
+      // When
+      state.apply_controlled_gate(gate, t, controls);
+
+      // Then
+      apply_gate_reference(expected, gate, t, controls);
+      all_equal =
+          all_equal &&
+          DenseState(ComplexVectMatrix(expected, 1, expected.size())) == state;
+    }
+  }
+  return all_equal;
+}
+
+bool it_should_not_apply_gate_controlled_by_target() {
+  // Given
+  auto state = DenseState(3);
+
+  // When - Then
+  try {
+    state.apply_controlled_gate(*ComplexVectMatrix::pauli_x(), 1, 0b011);
+    return false;
+  } catch (const std::invalid_argument &e) {
+    return true;
+  }
+}
+
+bool it_should_apply_diagonal_gate_to_every_target() {
+  // Given
+  constexpr size_t num_qubits = 6;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 11);
+  const std::vector<DiagonalGate> gates = {
+      DiagonalGate(Complex(0.6, 0.8), Complex(-0.28, 0.96)),
+      DiagonalGate(Complex(1), Complex(0, 1))};
+  const std::vector<size_t> control_masks = {0b000000, 0b000011, 0b001000,
+                                             0b101001};
+
+  bool all_equal = true;
+  for (const auto &gate : gates) {
+    for (size_t t = 0; t < num_qubits; t++) {
+      for (auto controls : control_masks) {
+        controls &= ~(size_t(1) << t);
+        auto state = DenseState(*amplitudes);
+        ComplexVector expected(state.size());
+        for (size_t i = 0; i < state.size(); i++) {
+          expected[i] = amplitudes->get(0, i);
+        }
+
+        // When
+        state.apply_controlled_gate(gate, t, controls);
+
+        // Then
+        apply_gate_reference(expected, *gate.to_matrix(), t, controls);
+        all_equal = all_equal &&
+                    DenseState(ComplexVectMatrix(expected, 1,
+                                                 expected.size())) == state;
+      }
+    }
+  }
+  return all_equal;
+}
+
+bool it_should_detect_diagonal_gate() {
+  // Given
+  auto amplitudes = random_amplitudes(16, 3);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+
+  // When
+  state.apply_controlled_gate(*ComplexVectMatrix::pauli_z(), 2, 0b1001);
+
+  // Then
+  expected.apply_controlled_gate(*DiagonalGate::pauli_z(), 2, 0b1001);
+  return DiagonalGate::is_diagonal(*ComplexVectMatrix::pauli_z()) &&
+         !DiagonalGate::is_diagonal(*ComplexVectMatrix::pauli_x()) &&
+         expected == state;
+}
+
+/*
+ * Reference permutation application, one basis state at a time.
+ */
+void apply_permutation_reference(ComplexVector &amplitudes,
+                                 const PermutationGate &gate,
+                                 const std::vector<size_t> &targets,
+                                 const size_t controls) {
+  const auto source = amplitudes;
+  for (size_t i = 0; i < amplitudes.size(); i++) {
+    if ((i & controls) != controls) {
+      continue;
+    }
+    size_t local = 0;
+    size_t rest = i;
+    for (size_t q = 0; q < targets.size(); q++) {
+      local |= ((i >> targets[q]) & 1) << q;
+      rest &= ~(size_t(1) << targets[q]);
+    }
+    const auto image = gate.permutation()[local];
+    size_t j = rest;
+    for (size_t q = 0; q < targets.size(); q++) {
+      j |= ((image >> q) & 1) << targets[q];
+    }
+    amplitudes[j] = source[i];
+  }
+}
+
+bool it_should_apply_permutation_to_every_target() {
+  // Given
+  constexpr size_t num_qubits = 6;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 13);
+  const std::vector<size_t> control_masks = {0b000000, 0b000001, 0b000110,
+                                             0b001000, 0b110000, 0b101001};
+  const auto x = PermutationGate::pauli_x();
+  const auto swap = PermutationGate::swap();
+  const auto cycle = PermutationGate({1, 2, 3, 0});
+
+  bool all_equal = true;
+  for (size_t a = 0; a < num_qubits; a++) {
+    for (size_t b = 0; b < num_qubits; b++) {
+      for (auto controls : control_masks) {
+        controls &= ~((size_t(1) << a) | (size_t(1) << b));
+        std::vector<std::pair<const PermutationGate *, std::vector<size_t>>>
+            cases;
+        if (a == b) {
+          cases.emplace_back(x.get(), std::vector<size_t>({a}));
+        } else {
+          cases.emplace_back(swap.get(), std::vector<size_t>({a, b}));
+          cases.emplace_back(&cycle, std::vector<size_t>({a, b}));
+        }
+        for (const auto &[gate, targets] : cases) {
+          auto state = DenseState(*amplitudes);
+          ComplexVector expected(state.size());
+          for (size_t i = 0; i < state.size(); i++) {
+            expected[i] = amplitudes->get(0, i);
+          }
+
+          // When
+          state.apply_controlled_gate(*gate, targets, controls);
+
+          // Then
+          apply_permutation_reference(expected, *gate, targets, controls);
+          all_equal = all_equal &&
+                      DenseState(ComplexVectMatrix(expected, 1,
+                                                   expected.size())) == state;
+        }
+      }
+    }
+  }
+  return all_equal;
+}
+
+bool it_should_detect_permutation_gate() {
+  // Given
+  auto amplitudes = random_amplitudes(16, 5);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+
+  // When
+  state.apply_controlled_gate(*ComplexVectMatrix::pauli_x(), 1, 0b1100);
+
+  // Then
+  expected.apply_controlled_gate(*PermutationGate::pauli_x(), {1}, 0b1100);
+  return PermutationGate::is_permutation(*ComplexVectMatrix::pauli_x()) &&
+         !PermutationGate::is_permutation(*ComplexVectMatrix::hadamard_2x2()) &&
+         PermutationGate(*PermutationGate::swap()->to_matrix()).is_swap() &&
+         expected == state;
+}
+
+bool it_should_not_apply_permutation_to_repeated_targets() {
+  // Given
+  auto state = DenseState(3);
+
+  // When - Then
+  try {
+    state.apply_gate(*PermutationGate::swap(), {1, 1});
+    return false;
+  } catch (const std::invalid_argument &e) {
+    return true;
+  }
+}
+
+bool it_should_apply_gates_across_slices() {
+  // Given: a state of several slices, with targets and controls on both
+  // sides of the slice size.
+  constexpr size_t num_qubits = 18;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 17);
+  auto state = DenseState(*amplitudes);
+  ComplexVector expected(state.size());
+  for (size_t i = 0; i < state.size(); i++) {
+    expected[i] = amplitudes->get(0, i);
+  }
+  const auto gate = ComplexVectMatrix(
+      ComplexMatrix({{{0.6, 0.1}, {-0.3, 0.7}}, {{0.2, -0.5}, {0.8, 0.4}}}));
+  const auto phase = DiagonalGate(Complex(0.8, 0.6), Complex(0, 1));
+  const auto swap = PermutationGate::swap();
+  const auto cycle = PermutationGate({1, 2, 3, 0});
+
+  // When
+  for (const size_t t : {0, 5, 15, 16, 17}) {
+    const auto other = (t + 1) % num_qubits;
+    const auto control = size_t(1) << ((t + 9) % num_qubits);
+    state.apply_controlled_gate(gate, t, control);
+    state.apply_gate(phase, t);
+    state.apply_gate(*swap, {t, other});
+    state.apply_controlled_gate(cycle, {other, t}, control);
+    state.apply_gate(*UnitaryGate::controlled(gate, {t}, {other}));
+
+    apply_gate_reference(expected, gate, t, control);
+    apply_gate_reference(expected, *phase.to_matrix(), t);
+    apply_permutation_reference(expected, *swap, {t, other}, 0);
+    apply_permutation_reference(expected, cycle, {other, t}, control);
+    apply_gate_reference(expected, gate, t, size_t(1) << other);
+  }
+
+  // Then
+  return DenseState(ComplexVectMatrix(expected, 1, expected.size())) == state;
+}
+
+/*
+ * Applies a gate of every kind, on each target, to `state`.
+ */
+template <typename T> void apply_every_gate(BasicDenseState<T> &state) {
+  const auto gate = ComplexVectMatrix(
+      ComplexMatrix({{{0.6, 0.1}, {-0.3, 0.7}}, {{0.2, -0.5}, {0.8, 0.4}}}));
+  const auto phase = DiagonalGate(Complex(0.8, 0.6), Complex(0, 1));
+  const auto swap = PermutationGate::swap();
+  const auto n = state.num_qubits();
+  for (size_t t = 0; t < n; t++) {
+    const auto other = (t + 1) % n;
+    state.apply_controlled_gate(gate, t, size_t(1) << ((t + 2) % n));
+    state.apply_gate(phase, t);
+    state.apply_gate(*swap, {t, other});
+    state.apply_gate(*UnitaryGate::controlled(gate, {t}, {other}));
+  }
+}
+
+bool it_should_apply_gates_in_double_precision() {
+  // Given
+  constexpr size_t num_qubits = 6;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 44);
+  auto state = DoubleDenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+
+  // When
+  apply_every_gate(state);
+
+  // Then
+  apply_every_gate(expected);
+  bool all_equal = true;
+  for (size_t i = 0; i < state.size(); i++) {
+    all_equal =
+        all_equal && approx_equal(Complex(state.get(i)), expected.get(i));
+  }
+  return all_equal;
+}
+
+bool it_should_reduce_amplitudes() {
+  // Given: |1> on qubit 2, |0> on qubit 1 and |+> on qubit 0.
+  auto state = DenseState(3);
+  state.apply_gate(*ComplexVectMatrix::pauli_x(), 2);
+  state.apply_gate(*ComplexVectMatrix::hadamard_2x2(), 0);
+  const auto other = DenseState(3);
+
+  // When
+  const auto norm = state.norm();
+  const auto probabilities = std::vector<double>(
+      {state.probability(0), state.probability(1), state.probability(2)});
+  const auto overlap = state.inner_product(state);
+  const auto orthogonal = other.inner_product(state);
+
+  // Then
+  return std::abs(norm - 1) < 1e-6 && std::abs(probabilities[0] - 0.5) < 1e-6 &&
+         probabilities[1] == 0 && std::abs(probabilities[2] - 1) < 1e-6 &&
+         std::abs(overlap - 1.0) < 1e-6 && orthogonal == 0.0;
+}
+
+bool it_should_permute_large_state() {
+  // Given
+  constexpr size_t num_qubits = 24;
+  auto state = DenseState(num_qubits);
+  state.set(0, 0);
+  state.set(1, 1);
+  const auto bytes_per_sweep = 4 * state.size() * sizeof(__complex_precision);
+  const auto x = PermutationGate::pauli_x();
+  const auto swap = PermutationGate::swap();
+
+  // When
+  auto perf_test_flips =
+      pt_start(std::to_string(num_qubits) + " qubits X on every target",
+               num_qubits * bytes_per_sweep);
+  for (size_t t = 0; t < num_qubits; t++) {
+    state.apply_gate(*x, {t});
+  }
+  pt_stop(perf_test_flips);
+
+  auto perf_test_swaps =
+      pt_start(std::to_string(num_qubits - 1) + " adjacent swaps",
+               (num_qubits - 1) * bytes_per_sweep / 2);
+  for (size_t t = 0; t + 1 < num_qubits; t++) {
+    state.apply_gate(*swap, {t, t + 1});
+  }
+  pt_stop(perf_test_swaps);
+
+  // Then: |0...01> is flipped to |1...10>, then rotated to |01...1>.
+  const size_t last = state.size() - 1;
+  const size_t expected = last & ~(size_t(1) << (num_qubits - 1));
+  bool is_basis_state = approx_equal(state.get(expected), Complex(1));
+  for (size_t i = 0; i < state.size(); i++) {
+    is_basis_state =
+        is_basis_state && (i == expected || state.get(i) == Complex(0));
+  }
+  return is_basis_state;
+}
+
+bool it_should_expand_large_state_vector() {
+  // Given: a full-size state when measuring, a smaller one otherwise so that
+  // the Debug suite stays quick.
+#ifdef PERFORMANCE_TESTING
+  constexpr size_t num_qubits = 25;
+#else
+  constexpr size_t num_qubits = 20;
+#endif
+  auto ket_plus_q = Qubit(1 / std::sqrt(2), 1 / std::sqrt(2));
+  auto state_vector = StateVector(std::vector<Qubit>(num_qubits, ket_plus_q));
+
+  // When
+  auto perf_test_expansion =
+      pt_start(std::to_string(num_qubits) + " qubits Kronecker expansion");
+  auto state = DenseState(state_vector);
+  pt_stop(perf_test_expansion);
+
+  auto perf_test_gates = pt_start(std::to_string(num_qubits) + " hadamards");
+  for (size_t t = 0; t < num_qubits; t++) {
+    state.apply_gate(*ComplexVectMatrix::hadamard_2x2(), t);
+  }
+  pt_stop(perf_test_gates);
+
+  // Then
+  bool is_zero_state = approx_equal(state.get(0), Complex(1));
+  for (size_t i = 1; i < state.size(); i++) {
+    is_zero_state = is_zero_state && approx_equal(state.get(i), Complex(0));
+  }
+  return is_zero_state;
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_create_zero_state", it_should_create_zero_state, failed,
+           total, true);
+
+  run_test("it_should_expand_state_vector", it_should_expand_state_vector,
+           failed, total, true);
+
+  run_test("it_should_factorise_product_state",
+           it_should_factorise_product_state, failed, total, true);
+
+  run_test("it_should_not_factorise_entangled_state",
+           it_should_not_factorise_entangled_state, failed, total, true);
+
+  run_test("it_should_not_factorise_zero_state",
+           it_should_not_factorise_zero_state, failed, total, true);
+
+  run_test("it_should_apply_gate_in_place", it_should_apply_gate_in_place,
+           failed, total, true);
+
+  run_test("it_should_apply_gate_to_every_target",
+           it_should_apply_gate_to_every_target, failed, total, true);
+
+  run_test("it_should_apply_controlled_gate_to_every_target",
+           it_should_apply_controlled_gate_to_every_target, failed, total,
+           true);
+
+  run_test("it_should_not_apply_gate_controlled_by_target",
+           it_should_not_apply_gate_controlled_by_target, failed, total, true);
+
+  run_test("it_should_apply_diagonal_gate_to_every_target",
+           it_should_apply_diagonal_gate_to_every_target, failed, total, true);
+
+  run_test("it_should_detect_diagonal_gate", it_should_detect_diagonal_gate,
+           failed, total, true);
+
+  run_test("it_should_apply_permutation_to_every_target",
+           it_should_apply_permutation_to_every_target, failed, total, true);
+
+  run_test("it_should_detect_permutation_gate",
+           it_should_detect_permutation_gate, failed, total, true);
+
+  run_test("it_should_not_apply_permutation_to_repeated_targets",
+           it_should_not_apply_permutation_to_repeated_targets, failed, total,
+           true);
+
+  run_test("it_should_apply_gates_across_slices",
+           it_should_apply_gates_across_slices, failed, total, true);
+
+  run_test("it_should_apply_gates_in_double_precision",
+           it_should_apply_gates_in_double_precision, failed, total, true);
+
+  run_test("it_should_reduce_amplitudes", it_should_reduce_amplitudes,
+           failed, total, true);
+
+  run_test("it_should_expand_large_state_vector",
+           it_should_expand_large_state_vector, failed, total, false);
+
+  run_test("it_should_permute_large_state", it_should_permute_large_state,
+           failed, total, false);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,430 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "algebra_engine.h"
+#include "circuit.h"
+#include "circuit_engine.h"
+#include "complex_vectorised_matrix.h"
+#include "dense_state.h"
+#include "executor.h"
+#include "gate_engine.h"
+#include "hilbert_namespace_test.h"
+#include "permutation_gate.h"
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * A circuit using every gate kind, with and without controls.
+ */
+std::unique_ptr<Circuit> mixed_circuit() {
+  auto u = ComplexVectMatrix(
+      ComplexMatrix({{{0.6, 0.1}, {-0.3, 0.7}}, {{0.2, -0.5}, {0.8, 0.4}}}));
+  auto circuit = std::make_unique<Circuit>(5);
+  circuit->h(0)
+      .h(4, {1})
+      .x(2)
+      .cnot(0, 3)
+      .y(1, {2, 4})
+      .z(3)
+      .phase(4, 0.3, {0})
+      .r_k(2, 3)
+      .swap(0, 4)
+      .swap(1, 2, {3})
+      .unitary(u, {1})
+      .unitary(*PermutationGate::swap()->to_matrix(), {3, 0}, {2});
+  return circuit;
+}
+
+bool it_should_record_without_applying() {
+  // When
+  auto circuit = mixed_circuit();
+
+  // Then
+  const auto &ops = circuit->ops();
+  return circuit->size() == 12 && ops[3].kind == GateKind::PauliX &&
+         ops[3].targets == std::vector<size_t>({3}) &&
+         ops[3].controls == std::vector<size_t>({0}) &&
+         ops[4].control_mask() == 0b10100 && ops[6].angle == 0.3 &&
+         ops[11].kind == GateKind::Unitary;
+}
+
+bool it_should_not_record_invalid_qubits() {
+  // Given
+  auto circuit = Circuit(3);
+
+  // When - Then
+  bool out_of_range = false;
+  try {
+    circuit.h(3);
+  } catch (const std::out_of_range &e) {
+    out_of_range = true;
+  }
+  bool repeated = false;
+  try {
+    circuit.x(1, {1});
+  } catch (const std::invalid_argument &e) {
+    repeated = true;
+  }
+  return out_of_range && repeated && circuit.size() == 0;
+}
+
+bool it_should_run_circuit() {
+  // Given
+  auto amplitudes = random_amplitudes(32, 4);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+  auto circuit = mixed_circuit();
+
+  // When
+  Executor().run(*circuit, state);
+
+  // Then
+  for (const auto &op : circuit->ops()) {
+    expected.apply_controlled_gate(*op.to_unitary(), 0);
+  }
+  return expected == state;
+}
+
+bool it_should_run_fused_circuit() {
+  // Given
+  auto amplitudes = random_amplitudes(32, 5);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+  auto circuit = mixed_circuit();
+  circuit->h(1).y(1).h(1);
+
+  // When
+  auto executor = Executor(3);
+  executor.run(*circuit, state);
+
+  // Then: only the final run of dense gates is merged.
+  Executor().run(*circuit, expected);
+  return executor.fusion_stats().gates_in == circuit->size() &&
+         executor.fusion_stats().gates_out == circuit->size() - 2 &&
+         expected == state;
+}
+
+bool it_should_keep_special_gates_out_of_fusion() {
+  // Given: a multi-controlled X, a phase and a swap between dense gates.
+  constexpr size_t num_qubits = 6;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 14);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+  auto circuit = Circuit(num_qubits);
+  circuit.h(0).y(0).x(5, {0, 1, 2, 3, 4}).h(0).z(0).h(0).swap(0, 1).h(1);
+
+  // When
+  auto executor = Executor(num_qubits);
+  executor.run(circuit, state);
+
+  // Then: h(0) y(0), x, h(0), z, h(0), swap and h(1) are applied in turn.
+  Executor().run(circuit, expected);
+  return executor.fusion_stats().gates_out == 7 && expected == state;
+}
+
+/*
+ * A deterministic circuit of random gates over every qubit, with controls.
+ */
+std::unique_ptr<Circuit> random_circuit(const size_t num_qubits,
+                                        const size_t num_gates,
+                                        const unsigned seed) {
+  std::mt19937 gen(seed);
+  auto circuit = std::make_unique<Circuit>(num_qubits);
+  // Unitary, so that the amplitudes keep their magnitude over many gates.
+  const auto h = static_cast<__complex_precision>(1 / std::sqrt(2));
+  auto u = ComplexVectMatrix(ComplexMatrix({{h, {0, h}}, {{0, h}, h}}));
+  for (size_t g = 0; g < num_gates; g++) {
+    const size_t a = gen() % num_qubits;
+    const size_t b = (a + 1 + gen() % (num_qubits - 1)) % num_qubits;
+    std::vector<size_t> controls;
+    const size_t c = gen() % num_qubits;
+    if (gen() % 2 == 0 && c != a && c != b) {
+      controls.push_back(c);
+    }
+    switch (gen() % 6) {
+    case 0:
+      circuit->h(a, controls);
+      break;
+    case 1:
+      circuit->x(a, controls);
+      break;
+    case 2:
+      circuit->phase(a, 0.1 * static_cast<double>(g), controls);
+      break;
+    case 3:
+      circuit->swap(a, b, controls);
+      break;
+    case 4:
+      circuit->unitary(u, {a}, controls);
+      break;
+    default:
+      circuit->unitary(*AlgebraEngine::tensor_product(
+                                        u, *ComplexVectMatrix::hadamard_2x2())
+                            ->to_matrix(),
+                       {a, b}, controls);
+    }
+  }
+  return circuit;
+}
+
+bool it_should_run_cache_blocked() {
+  // Given
+  constexpr size_t num_qubits = 9;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 6);
+  auto circuit = random_circuit(num_qubits, 200, 8);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+
+  // When
+  auto executor = Executor(0, ExecutionMode::CacheBlocked, 4);
+  executor.run(*circuit, state);
+
+  // Then
+  Executor().run(*circuit, expected);
+  return executor.blocking_stats().swaps > 0 &&
+         executor.blocking_stats().passes > 1 && expected == state;
+}
+
+bool it_should_run_fused_cache_blocked() {
+  // Given
+  constexpr size_t num_qubits = 10;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 9);
+  auto circuit = random_circuit(num_qubits, 100, 10);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+
+  // When
+  Executor(3, ExecutionMode::CacheBlocked, 5).run(*circuit, state);
+
+  // Then
+  Executor().run(*circuit, expected);
+  return expected == state;
+}
+
+bool it_should_run_double_precision_cache_blocked() {
+  // Given
+  constexpr size_t num_qubits = 9;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 11);
+  auto circuit = random_circuit(num_qubits, 200, 12);
+  auto state = DoubleDenseState(*amplitudes);
+  auto expected = DoubleDenseState(*amplitudes);
+
+  // When
+  Executor(0, ExecutionMode::CacheBlocked, 4).run(*circuit, state);
+
+  // Then
+  Executor().run(*circuit, expected);
+  bool all_close = true;
+  for (size_t i = 0; i < state.size(); i++) {
+    all_close = all_close && std::abs(state.get(i) - expected.get(i)) < 1e-12;
+  }
+  return all_close;
+}
+
+/*
+ * Distance of `state` from |0...0>, in the largest amplitude.
+ */
+template <typename T> double zero_state_error(const BasicDenseState<T> &state) {
+  double error = std::abs(std::complex<double>(state.get(0)) - 1.0);
+  for (size_t i = 1; i < state.size(); i++) {
+    error = std::max(error, std::abs(std::complex<double>(state.get(i))));
+  }
+  return error;
+}
+
+bool it_should_stay_accurate_in_double_precision() {
+  // Given: layers of H, phases and CNOTs, then the same layers undone.
+  constexpr size_t num_qubits = 12;
+  constexpr size_t num_layers = 100;
+  auto circuit = Circuit(num_qubits);
+  for (size_t l = 0; l < num_layers; l++) {
+    for (size_t q = 0; q < num_qubits; q++) {
+      circuit.h(q).phase(q, 0.1 * static_cast<double>(l + q));
+    }
+    for (size_t q = 0; q + 1 < num_qubits; q++) {
+      circuit.cnot(q, q + 1);
+    }
+  }
+  for (size_t l = num_layers; l-- > 0;) {
+    for (size_t q = num_qubits - 1; q-- > 0;) {
+      circuit.cnot(q, q + 1);
+    }
+    for (size_t q = num_qubits; q-- > 0;) {
+      circuit.phase(q, -0.1 * static_cast<double>(l + q)).h(q);
+    }
+  }
+  auto single = DenseState(num_qubits);
+  auto state = DoubleDenseState(num_qubits);
+
+  // When
+  Executor().run(circuit, state);
+
+  // Then
+  Executor().run(circuit, single);
+  const auto single_error = zero_state_error(single);
+  const auto double_error = zero_state_error(state);
+  print_info("Error after " + std::to_string(circuit.size()) +
+             " gates: single " + std::to_string(single_error) + ", double " +
+             std::to_string(double_error));
+  return double_error < 1e-10 && double_error < single_error;
+}
+
+bool it_should_fuse_in_double_precision() {
+  // Given: runs of dense gates fused into 3-qubit gates, between CNOTs.
+  constexpr size_t num_qubits = 8;
+  constexpr size_t num_layers = 50;
+  auto circuit = Circuit(num_qubits);
+  for (size_t l = 0; l < num_layers; l++) {
+    for (size_t q = 0; q < num_qubits; q++) {
+      circuit.h(q).y((q + l) % num_qubits);
+    }
+    for (size_t q = l % 2; q + 1 < num_qubits; q += 2) {
+      circuit.cnot(q, q + 1);
+    }
+  }
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 15);
+  auto state = DoubleDenseState(*amplitudes);
+  auto reference = DoubleDenseState(*amplitudes);
+
+  // When
+  auto executor = Executor(3);
+  executor.run(circuit, state);
+
+  // Then: as accurate as the unfused gates, built in double precision.
+  Executor().run(circuit, reference);
+  double error = 0;
+  for (size_t i = 0; i < state.size(); i++) {
+    error = std::max(error, std::abs(state.get(i) - reference.get(i)));
+  }
+  print_info("Fused double-precision error: " + std::to_string(error));
+  return executor.fusion_stats().gates_out < circuit.size() && error < 1e-12;
+}
+
+bool it_should_not_run_on_different_qubits() {
+  // Given
+  auto state = DenseState(4);
+
+  // When - Then
+  try {
+    Executor().run(*mixed_circuit(), state);
+    return false;
+  } catch (const std::invalid_argument &e) {
+    return true;
+  }
+}
+
+bool it_should_run_large_qft() {
+  // Given
+  constexpr size_t num_qubits = 20;
+  auto circuit = CircuitEngine::qft_circuit(num_qubits);
+  circuit->append(*CircuitEngine::inverse_qft_circuit(num_qubits));
+  auto state = DenseState(num_qubits);
+  auto fused_state = DenseState(num_qubits);
+
+  // When
+  auto perf_test =
+      pt_start(std::to_string(circuit->size()) + " gates, QFT and inverse");
+  Executor().run(*circuit, state);
+  pt_stop(perf_test);
+
+  auto executor = Executor(4);
+  auto perf_test_fused = pt_start("QFT and inverse, fused");
+  executor.run(*circuit, fused_state);
+  pt_stop(perf_test_fused);
+  print_info(std::to_string(executor.fusion_stats().gates_out) +
+             " fused gates");
+
+  // Then
+  auto zero_state = DenseState(num_qubits);
+  return zero_state == state && zero_state == fused_state;
+}
+
+bool it_should_run_large_circuit_cache_blocked() {
+  // Given
+  constexpr size_t num_qubits = 22;
+  auto circuit = random_circuit(num_qubits, 200, 11);
+  auto state = DenseState(num_qubits);
+  auto expected = DenseState(num_qubits);
+
+  // When
+  auto executor = Executor(0, ExecutionMode::CacheBlocked);
+  auto perf_test_blocked = pt_start(std::to_string(circuit->size()) +
+                                    " random gates, cache blocked");
+  executor.run(*circuit, state);
+  pt_stop(perf_test_blocked);
+  print_info(std::to_string(Executor::cache_local_qubits()) +
+             " local qubits, " +
+             std::to_string(executor.blocking_stats().swaps) + " swaps, " +
+             std::to_string(executor.blocking_stats().passes) + " passes");
+
+  // Then
+  auto perf_test_direct =
+      pt_start(std::to_string(circuit->size()) + " random gates, direct");
+  Executor().run(*circuit, expected);
+  pt_stop(perf_test_direct);
+  return expected == state;
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_record_without_applying",
+           it_should_record_without_applying, failed, total, true);
+
+  run_test("it_should_not_record_invalid_qubits",
+           it_should_not_record_invalid_qubits, failed, total, true);
+
+  run_test("it_should_run_circuit", it_should_run_circuit, failed, total,
+           true);
+
+  run_test("it_should_run_fused_circuit", it_should_run_fused_circuit, failed,
+           total, true);
+
+  run_test("it_should_keep_special_gates_out_of_fusion",
+           it_should_keep_special_gates_out_of_fusion, failed, total, true);
+
+  run_test("it_should_run_cache_blocked", it_should_run_cache_blocked, failed,
+           total, true);
+
+  run_test("it_should_run_fused_cache_blocked",
+           it_should_run_fused_cache_blocked, failed, total, true);
+
+  run_test("it_should_run_double_precision_cache_blocked",
+           it_should_run_double_precision_cache_blocked, failed, total, true);
+
+  run_test("it_should_stay_accurate_in_double_precision",
+           it_should_stay_accurate_in_double_precision, failed, total, true);
+
+  run_test("it_should_fuse_in_double_precision",
+           it_should_fuse_in_double_precision, failed, total, true);
+
+  run_test("it_should_not_run_on_different_qubits",
+           it_should_not_run_on_different_qubits, failed, total, true);
+
+  run_test("it_should_run_large_qft", it_should_run_large_qft, failed, total,
+           false);
+
+  run_test("it_should_run_large_circuit_cache_blocked",
+           it_should_run_large_circuit_cache_blocked, failed, total, false);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}
@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "complex_vectorised_matrix.h"
+#include "dense_state.h"
 #include "gate_engine.h"
 #include "hilbert_namespace_test.h"
 #include <memory>
@@ -29,6 +30,19 @@ bool it_should_apply_gate() {
   return are_matrices_equal(*ComplexVectMatrix::ket_1(), *result);
 }
 
+bool it_should_apply_gate_to_dense_state() {
+  // Given
+  auto gate = ComplexVectMatrix::pauli_x();
+  auto state = DenseState(2);
+
+  // When
+  GateEngine::apply_gate(*gate, state, 1);
+
+  // Then
+  return approx_equal(state.get(2), Complex(1)) &&
+         approx_equal(state.get(0), Complex(0));
+}
+
 bool it_should_apply_controlled_gate() {
   // Given
   auto target = std::make_unique<Qubit>(1, 0);
@@ -61,6 +75,9 @@ int main() {
 
   run_test("it_should_apply_gate", it_should_apply_gate, failed, total);
 
+  run_test("it_should_apply_gate_to_dense_state",
+           it_should_apply_gate_to_dense_state, failed, total);
+
   run_test("it_should_apply_controlled_gate", it_should_apply_controlled_gate,
            failed, total);
 
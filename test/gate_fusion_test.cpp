@@ -0,0 +1,215 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "circuit_engine.h"
+#include "complex_vectorised_matrix.h"
+#include "dense_state.h"
+#include "gate_engine.h"
+#include "gate_fusion.h"
+#include "hilbert_namespace_test.h"
+#include "unitary_gate.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * The gates of `CircuitEngine::qft`, as dense gates.
+ */
+std::vector<UnitaryGate> qft_gates(const size_t num_qubits) {
+  std::vector<UnitaryGate> gates;
+  const auto circuit = CircuitEngine::qft_circuit(num_qubits);
+  for (const auto &op : circuit->ops()) {
+    gates.push_back(*op.to_unitary());
+  }
+  return gates;
+}
+
+bool it_should_expand_gate() {
+  // Given
+  auto cnot = UnitaryGate::controlled(*ComplexVectMatrix::pauli_x(), 0, {1});
+  auto amplitudes = random_amplitudes(8, 1);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+
+  // When
+  state.apply_gate(*cnot->expand({2, 1, 0}));
+
+  // Then
+  GateEngine::cnot(expected, 1, 0);
+  return expected == state;
+}
+
+bool it_should_apply_gate_on_any_qubits() {
+  // Given
+  constexpr size_t num_qubits = 7;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 2);
+  const std::vector<std::vector<size_t>> qubit_sets = {
+      {0, 1}, {5, 1}, {3, 4}, {0, 2, 6}, {6, 3, 4}, {1, 0, 2, 5}};
+
+  bool all_equal = true;
+  for (const auto &qubits : qubit_sets) {
+    // A product of controlled gates, applied one by one as a reference.
+    std::vector<UnitaryGate> gates;
+    const auto h = ComplexVectMatrix::hadamard_2x2();
+    const auto y = ComplexVectMatrix::pauli_y();
+    for (size_t q = 0; q < qubits.size(); q++) {
+      gates.emplace_back(*h, std::vector<size_t>({qubits[q]}));
+      const auto next = qubits[(q + 1) % qubits.size()];
+      gates.push_back(*UnitaryGate::controlled(*y, qubits[q], {next}));
+    }
+    auto fusion = GateFusion(qubits.size());
+    const auto fused = fusion.fuse(gates);
+
+    const bool uses_last = std::find(qubits.begin(), qubits.end(),
+                                     num_qubits - 1) != qubits.end();
+    for (const size_t controls : {size_t(0), size_t(1) << (num_qubits - 1)}) {
+      if (uses_last && controls != 0) {
+        continue;
+      }
+      auto state = DenseState(*amplitudes);
+      auto expected = DenseState(*amplitudes);
+
+      // When
+      state.apply_controlled_gate(fused.front(), controls);
+
+      // Then
+      for (const auto &gate : gates) {
+        expected.apply_controlled_gate(gate, controls);
+      }
+      all_equal = all_equal && fused.size() == 1 && expected == state;
+    }
+  }
+  return all_equal;
+}
+
+bool it_should_fuse_qft() {
+  // Given
+  constexpr size_t num_qubits = 8;
+  auto amplitudes = random_amplitudes(size_t(1) << num_qubits, 3);
+  auto state = DenseState(*amplitudes);
+  auto expected = DenseState(*amplitudes);
+  const auto gates = qft_gates(num_qubits);
+
+  // When
+  auto fusion = GateFusion(3);
+  const auto fused = fusion.fuse(gates);
+  for (const auto &gate : fused) {
+    state.apply_gate(gate);
+  }
+
+  // Then
+  CircuitEngine::qft(expected);
+  return fusion.stats().gates_in == gates.size() &&
+         fusion.stats().gates_out == fused.size() &&
+         fused.size() < gates.size() && expected == state;
+}
+
+bool it_should_keep_wide_gates() {
+  // Given
+  auto toffoli =
+      UnitaryGate::controlled(*ComplexVectMatrix::pauli_x(), 0, {1, 2});
+  auto h = UnitaryGate(*ComplexVectMatrix::hadamard_2x2(), {0});
+
+  // When
+  auto fusion = GateFusion(2);
+  const auto fused = fusion.fuse({h, *toffoli, h});
+
+  // Then
+  return fused.size() == 3 &&
+         fusion.stats().bytes_saved(10, sizeof(__complex_precision)) == 0;
+}
+
+bool it_should_not_fuse_disjoint_gates() {
+  // Given
+  const auto h = ComplexVectMatrix::hadamard_2x2();
+  auto cnot = UnitaryGate::controlled(*ComplexVectMatrix::pauli_x(), 1, {0});
+  const auto h0 = UnitaryGate(*h, {0});
+  const auto h1 = UnitaryGate(*h, {1});
+  const auto h2 = UnitaryGate(*h, {2});
+
+  // When
+  auto fusion = GateFusion(4);
+  const auto layer = fusion.fuse({h0, h1, h2});
+  const auto entangler = fusion.fuse({h0, h1, *cnot});
+
+  // Then: h(1) shares a qubit with the CNOT, h(0) with neither before it.
+  return layer.size() == 3 && entangler.size() == 2 &&
+         entangler.back().num_qubits() == 2;
+}
+
+bool it_should_fuse_large_qft() {
+  // Given
+  constexpr size_t num_qubits = 18;
+  const auto gates = qft_gates(num_qubits);
+  auto state = DenseState(num_qubits);
+  auto expected = DenseState(num_qubits);
+
+  // When
+  auto perf_test_unfused =
+      pt_start(std::to_string(gates.size()) + " QFT gates, unfused");
+  for (const auto &gate : gates) {
+    expected.apply_gate(gate);
+  }
+  pt_stop(perf_test_unfused);
+
+  bool all_equal = true;
+  for (const size_t max_qubits : {2, 3, 4, 5}) {
+    auto fusion = GateFusion(max_qubits);
+    auto perf_test_fusion =
+        pt_start("Fusion pass, k = " + std::to_string(max_qubits));
+    const auto fused = fusion.fuse(gates);
+    pt_stop(perf_test_fusion);
+
+    auto fused_state = DenseState(num_qubits);
+    auto perf_test_fused =
+        pt_start(std::to_string(fused.size()) + " QFT gates, fused");
+    for (const auto &gate : fused) {
+      fused_state.apply_gate(gate);
+    }
+    pt_stop(perf_test_fused);
+    print_info("Bytes saved: " +
+               std::to_string(fusion.stats().bytes_saved(
+                   num_qubits, sizeof(__complex_precision))));
+
+    all_equal = all_equal && expected == fused_state;
+  }
+  return all_equal;
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_expand_gate", it_should_expand_gate, failed, total,
+           true);
+
+  run_test("it_should_apply_gate_on_any_qubits",
+           it_should_apply_gate_on_any_qubits, failed, total, true);
+
+  run_test("it_should_fuse_qft", it_should_fuse_qft, failed, total, true);
+
+  run_test("it_should_keep_wide_gates", it_should_keep_wide_gates, failed,
+           total, true);
+
+  run_test("it_should_not_fuse_disjoint_gates",
+           it_should_not_fuse_disjoint_gates, failed, total, true);
+
+  run_test("it_should_fuse_large_qft", it_should_fuse_large_qft, failed,
+           total, false);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "algebra_engine.h"
+#include "complex_vector_split.h"
+#include "complex_vectorised_matrix.h"
+#include "gemm_engine.h"
+#include "hilbert_namespace_test.h"
+#include "thread_pool.h"
+#include <chrono>
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Whether `product` is `left` * `right`, as computed in double precision,
+ * up to a rounding error growing with the number of terms.
+ */
+bool is_product(const ComplexVectMatrix &product, const ComplexVectMatrix &left,
+                const ComplexVectMatrix &right) {
+  const auto depth = left.column_size();
+  if (product.row_size() != left.row_size() ||
+      product.column_size() != right.column_size()) {
+    return false;
+  }
+  for (size_t m = 0; m < product.row_size(); m++) {
+    for (size_t n = 0; n < product.column_size(); n++) {
+      std::complex<double> expected = 0;
+      for (size_t k = 0; k < depth; k++) {
+        expected += std::complex<double>(left.get(m, k)) *
+                    std::complex<double>(right.get(k, n));
+      }
+      if (std::abs(std::complex<double>(product.get(m, n)) - expected) >
+          1e-6 * static_cast<double>(depth)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/*
+ * Whether the padding of every row of `mat` is zero.
+ */
+bool is_padding_zero(const ComplexVectMatrix &mat) {
+  for (size_t m = 0; m < mat.row_size(); m++) {
+    for (size_t n = mat.column_size(); n < mat.stride(); n++) {
+      if (mat.real_data()[m * mat.stride() + n] != 0 ||
+          mat.imag_data()[m * mat.stride() + n] != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool it_should_multiply_small_matrices() {
+  // Given
+  const auto h = ComplexVectMatrix::hadamard_2x2();
+  const auto x = ComplexVectMatrix::pauli_x();
+
+  // When
+  const auto hh = GemmEngine::multiply(*h, *h);
+  const auto hx = GemmEngine::multiply(*h, *x, GemmMethod::ThreeM);
+
+  // Then
+  return verify_identity_matrix(*hh, 2) && is_product(*hx, *h, *x);
+}
+
+bool it_should_multiply_across_block_edges() {
+  // Given: sizes that are not multiples of any block, with a depth spanning
+  // several slices and more rows than a block.
+  const auto left = random_matrix(GemmEngine::block_rows + 7,
+                                  2 * GemmEngine::block_depth + 3, 1);
+  const auto right = random_matrix(left.column_size(), 37, 2);
+
+  // When
+  const auto standard = GemmEngine::multiply(left, right);
+  const auto three_m = GemmEngine::multiply(left, right, GemmMethod::ThreeM);
+
+  // Then
+  return is_product(*standard, left, right) &&
+         is_product(*three_m, left, right) && is_padding_zero(*standard) &&
+         is_padding_zero(*three_m);
+}
+
+bool it_should_multiply_vectors() {
+  // Given
+  const auto row = random_matrix(1, 300, 3);
+  const auto column = random_matrix(300, 1, 4);
+
+  // When
+  const auto inner = GemmEngine::multiply(row, column);
+  const auto outer = GemmEngine::multiply(column, row);
+
+  // Then
+  return is_product(*inner, row, column) && is_product(*outer, column, row);
+}
+
+bool it_should_not_depend_on_thread_count() {
+  // Given
+  const auto left = random_matrix(100, 140, 5);
+  const auto right = random_matrix(140, 60, 6);
+  auto &pool = ThreadPool::instance();
+  const auto initial = pool.num_workers();
+
+  // When
+  std::vector<std::unique_ptr<ComplexVectMatrix>> products;
+  for (const size_t workers : {0, 1, 3, 7}) {
+    pool.resize(workers);
+    products.push_back(GemmEngine::multiply(left, right));
+  }
+  pool.resize(initial);
+
+  // Then: bit for bit, as every element is summed in the same order.
+  for (size_t i = 1; i < products.size(); i++) {
+    if (!(*products[i] == *products[0])) {
+      return false;
+    }
+  }
+  return is_product(*products[0], left, right);
+}
+
+bool it_should_reject_mismatched_sizes() {
+  // Given
+  const auto left = random_matrix(3, 4, 7);
+  const auto right = random_matrix(5, 3, 8);
+
+  // When
+  try {
+    const auto product = GemmEngine::multiply(left, right);
+  } catch (const std::invalid_argument &) {
+    // Then
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Whether row r of `products` is `mat` times row r of `vects`, as computed in
+ * double precision.
+ */
+bool are_vector_products(const ComplexVectMatrix &products,
+                         const ComplexVectMatrix &mat,
+                         const ComplexVectMatrix &vects) {
+  for (size_t r = 0; r < vects.row_size(); r++) {
+    for (size_t m = 0; m < mat.row_size(); m++) {
+      std::complex<double> expected = 0;
+      for (size_t n = 0; n < mat.column_size(); n++) {
+        expected += std::complex<double>(mat.get(m, n)) *
+                    std::complex<double>(vects.get(r, n));
+      }
+      if (std::abs(std::complex<double>(products.get(r, m)) - expected) >
+          1e-5) {
+        return false;
+      }
+    }
+  }
+  return products.row_size() == vects.row_size() &&
+         products.column_size() == mat.row_size() &&
+         is_padding_zero(products);
+}
+
+bool it_should_multiply_several_vectors() {
+  // Given: more vectors than the micro-kernel takes at once, and some left.
+  const auto mat = random_matrix(70, 45, 13);
+  const auto vects = random_matrix(GemmEngine::micro_vectors * 2 + 3, 45, 14);
+
+  // When
+  const auto products = GemmEngine::multiply_vectors(mat, vects);
+
+  // Then
+  return are_vector_products(*products, mat, vects);
+}
+
+bool it_should_multiply_single_vector() {
+  // Given: the single vector of a matrix-vector product.
+  const auto mat = random_matrix(70, 45, 15);
+  const auto vect = random_matrix(1, 45, 16);
+
+  // When
+  const auto product = GemmEngine::multiply_vectors(mat, vect);
+
+  // Then
+  return are_vector_products(*product, mat, vect);
+}
+
+bool it_should_materialise_matrix_multiplication() {
+  // Given
+  const auto left = random_matrix(40, 50, 9);
+  const auto right = random_matrix(50, 60, 10);
+  const auto lazy = AlgebraEngine::matrix_multiplication(left, right);
+
+  // When
+  const auto product = lazy->to_matrix();
+
+  // Then: as the rows, computed on demand.
+  for (size_t m = 0; m < product->row_size(); m++) {
+    const auto row = lazy->get(m);
+    for (size_t n = 0; n < product->column_size(); n++) {
+      if (!approx_equal(product->get(m, n), row->get(n))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool it_should_multiply_large_matrices() {
+  // Given
+  constexpr size_t size = 512;
+  const auto left = random_matrix(size, size, 11);
+  const auto right = random_matrix(size, size, 12);
+  const auto lazy = AlgebraEngine::matrix_multiplication(left, right);
+  const auto flops = 8.0 * size * size * size;
+
+  // When
+  auto perf_test_rows = pt_start(std::to_string(size) + " product by rows");
+  std::vector<std::unique_ptr<ComplexVectSplit>> by_rows;
+  for (size_t m = 0; m < size; m++) {
+    by_rows.push_back(lazy->get(m));
+  }
+  pt_stop(perf_test_rows);
+
+  auto perf_test_standard = pt_start(std::to_string(size) + " GEMM");
+  const auto start = std::chrono::high_resolution_clock::now();
+  const auto standard = GemmEngine::multiply(left, right);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::high_resolution_clock::now() - start;
+  pt_stop(perf_test_standard);
+
+  auto perf_test_three_m = pt_start(std::to_string(size) + " 3M GEMM");
+  const auto three_m = GemmEngine::multiply(left, right, GemmMethod::ThreeM);
+  pt_stop(perf_test_three_m);
+
+  // Then
+  print_info("GEMM GFLOP/s: " + std::to_string(flops / elapsed.count() / 1e9));
+  for (size_t m = 0; m < size; m += 37) {
+    for (size_t n = 0; n < size; n++) {
+      if (std::abs(standard->get(m, n) - by_rows[m]->get(n)) > 1e-3 ||
+          std::abs(three_m->get(m, n) - by_rows[m]->get(n)) > 1e-3) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool it_should_multiply_large_matrix_by_vectors() {
+  // Given
+  constexpr size_t size = 4096;
+  constexpr size_t count = 8;
+  const auto mat = random_matrix(size, size, 15);
+  const auto vect = random_matrix(1, size, 16);
+  const auto vects = random_matrix(count, size, 17);
+  const auto lazy = AlgebraEngine::matrix_vector_product(mat, vects);
+  const auto bytes = 2 * size * size * sizeof(__complex_precision);
+
+  // When
+  auto perf_test_rows =
+      pt_start(std::to_string(count) + " GEMV by rows", count * bytes);
+  std::vector<std::unique_ptr<ComplexVectSplit>> by_rows;
+  for (size_t r = 0; r < count; r++) {
+    by_rows.push_back(lazy->get(r));
+  }
+  pt_stop(perf_test_rows);
+
+  auto perf_test_single = pt_start("GEMV", bytes);
+  const auto single = GemmEngine::multiply_vectors(mat, vect);
+  pt_stop(perf_test_single);
+  const auto single_by_rows =
+      AlgebraEngine::matrix_vector_product(mat, vect)->get(0);
+
+  auto perf_test_batched =
+      pt_start(std::to_string(count) + " batched GEMV", bytes);
+  const auto batched = GemmEngine::multiply_vectors(mat, vects);
+  pt_stop(perf_test_batched);
+
+  // Then
+  for (size_t m = 0; m < size; m++) {
+    if (std::abs(single->get(0, m) - single_by_rows->get(m)) > 1e-3) {
+      return false;
+    }
+    for (size_t r = 0; r < count; r++) {
+      if (std::abs(batched->get(r, m) - by_rows[r]->get(m)) > 1e-3) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_multiply_small_matrices",
+           it_should_multiply_small_matrices, failed, total, true);
+
+  run_test("it_should_multiply_across_block_edges",
+           it_should_multiply_across_block_edges, failed, total, true);
+
+  run_test("it_should_multiply_vectors", it_should_multiply_vectors, failed,
+           total, true);
+
+  run_test("it_should_not_depend_on_thread_count",
+           it_should_not_depend_on_thread_count, failed, total, true);
+
+  run_test("it_should_reject_mismatched_sizes",
+           it_should_reject_mismatched_sizes, failed, total, true);
+
+  run_test("it_should_multiply_several_vectors",
+           it_should_multiply_several_vectors, failed, total, true);
+
+  run_test("it_should_multiply_single_vector",
+           it_should_multiply_single_vector, failed, total, true);
+
+  run_test("it_should_materialise_matrix_multiplication",
+           it_should_materialise_matrix_multiplication, failed, total, true);
+
+  run_test("it_should_multiply_large_matrices",
+           it_should_multiply_large_matrices, failed, total, false);
+
+  run_test("it_should_multiply_large_matrix_by_vectors",
+           it_should_multiply_large_matrix_by_vectors, failed, total, false);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}
@@ -20,6 +20,8 @@
 #include "lazy_operation.h"
 #include <cstddef>
 #include <iostream>
+#include <memory>
+#include <random>
 
 #include <chrono>
 
@@ -31,10 +33,15 @@ inline std::string mussec(unsigned long long delta_mus) {
   return std::to_string(delta_sec);
 }
 
+/*
+ * Times a scope. When `bytes` is given, the effective memory bandwidth is
+ * reported as well, for kernels that are bound by memory rather than flops.
+ */
 class PerfTest {
 public:
-  explicit PerfTest(const std::string title)
-      : title_(title), start_(std::chrono::high_resolution_clock::now()) {}
+  explicit PerfTest(const std::string title, const size_t bytes = 0)
+      : title_(title), bytes_(bytes),
+        start_(std::chrono::high_resolution_clock::now()) {}
 
   ~PerfTest() {
     const auto end = std::chrono::high_resolution_clock::now();
@@ -44,10 +51,16 @@ public:
     std::cout << std::endl
               << "** Elapsed time " << title_ << ": \033[1m" << duration_seconds
               << " seconds\033[0m";
+    if (bytes_ > 0 && duration.count() > 0) {
+      const auto gb_per_s = static_cast<double>(bytes_) / 1000 /
+                            static_cast<double>(duration.count());
+      std::cout << " (\033[1m" << gb_per_s << " GB/s\033[0m)";
+    }
   }
 
 private:
   const std::string title_;
+  const size_t bytes_;
   const std::chrono::high_resolution_clock::time_point start_;
 };
 
@@ -57,9 +70,10 @@ inline void print_info(const std::string info) {
 #endif
 }
 
-inline PerfTest *pt_start(const std::string title) {
+inline PerfTest *pt_start(const std::string title,
+                          [[maybe_unused]] const size_t bytes = 0) {
 #ifdef PERFORMANCE_TESTING
-  return new PerfTest(title);
+  return new PerfTest(title, bytes);
 #else
   return nullptr;
 #endif
@@ -71,6 +85,28 @@ inline void pt_stop(PerfTest *pt) {
   }
 }
 
+/*
+ * A `rows` x `columns` matrix of pseudo-random elements.
+ */
+inline ComplexVectMatrix random_matrix(const size_t rows, const size_t columns,
+                                       const unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<__complex_precision> dist(-1, 1);
+  ComplexVector elements(rows * columns);
+  for (auto &e : elements) {
+    e = Complex(dist(gen), dist(gen));
+  }
+  return ComplexVectMatrix(elements, rows, columns);
+}
+
+/*
+ * Deterministic pseudo-random amplitudes, not normalised.
+ */
+inline std::unique_ptr<ComplexVectMatrix>
+random_amplitudes(const size_t size, const unsigned seed) {
+  return std::make_unique<ComplexVectMatrix>(random_matrix(1, size, seed));
+}
+
 inline bool are_matrices_equal(const ComplexVectMatrix &left,
                                const LazyOperation &right) {
   return left == *right.to_matrix();
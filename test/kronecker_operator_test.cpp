@@ -0,0 +1,162 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "algebra_engine.h"
+#include "complex_vectorised_matrix.h"
+#include "gemm_engine.h"
+#include "hilbert_namespace_test.h"
+#include "kronecker_operator.h"
+#include "thread_pool.h"
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+/*
+ * Whether `left` and `right` have the same sizes and elements, up to `error`.
+ */
+bool are_close(const ComplexVectMatrix &left, const ComplexVectMatrix &right,
+               const double error) {
+  if (left.row_size() != right.row_size() ||
+      left.column_size() != right.column_size()) {
+    return false;
+  }
+  for (size_t m = 0; m < left.row_size(); m++) {
+    for (size_t n = 0; n < left.column_size(); n++) {
+      if (std::abs(left.get(m, n) - right.get(m, n)) > error) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool it_should_materialise_as_tensor_product() {
+  // Given
+  const auto a = random_matrix(2, 3, 1);
+  const auto b = random_matrix(3, 2, 2);
+  const auto h = ComplexVectMatrix::hadamard_2x2();
+  const KroneckerOperator op({a, b});
+  constexpr size_t times = 5;
+  const auto power = AlgebraEngine::kronecker_power(*h, times);
+
+  // When
+  const auto actual = op.to_matrix();
+  const auto actual_power = power->to_matrix();
+
+  // Then
+  const auto expected = AlgebraEngine::tensor_product(a, b)->to_matrix();
+  const auto expected_power =
+      AlgebraEngine::tensor_product(*h, times)->to_matrix();
+  return op.row_size() == 6 && op.column_size() == 6 &&
+         are_close(*actual, *expected, 1e-6) &&
+         are_close(*actual_power, *expected_power, 1e-6) &&
+         approx_equal(op.get(4, 1), expected->get(4, 1));
+}
+
+bool it_should_apply_to_vectors() {
+  // Given: factors of every shape, so that the modes change size.
+  const KroneckerOperator op({random_matrix(2, 3, 3), random_matrix(3, 2, 4),
+                              random_matrix(4, 4, 5),
+                              random_matrix(1, 2, 6)});
+  const auto vects = random_matrix(5, op.column_size(), 7);
+
+  // When
+  const auto actual = op.apply(vects);
+
+  // Then
+  const auto expected = GemmEngine::multiply_vectors(*op.to_matrix(), vects);
+  for (size_t m = 0; m < actual->row_size(); m++) {
+    for (size_t n = actual->column_size(); n < actual->stride(); n++) {
+      if (actual->real_data()[m * actual->stride() + n] != 0 ||
+          actual->imag_data()[m * actual->stride() + n] != 0) {
+        return false;
+      }
+    }
+  }
+  return are_close(*actual, *expected, 1e-4);
+}
+
+bool it_should_not_depend_on_thread_count() {
+  // Given
+  auto &pool = ThreadPool::instance();
+  const auto num_workers = pool.num_workers();
+  const auto op = AlgebraEngine::kronecker_power(random_matrix(2, 2, 8), 16);
+  const auto vect = random_amplitudes(op->column_size(), 9);
+
+  // When
+  pool.resize(3);
+  const auto parallel = op->apply(*vect);
+  pool.resize(0);
+  const auto serial = op->apply(*vect);
+  pool.resize(num_workers);
+
+  // Then
+  return *parallel == *serial;
+}
+
+bool it_should_reject_invalid_operands() {
+  // Given
+  const KroneckerOperator op(
+      {random_matrix(2, 2, 10), random_matrix(2, 2, 11)});
+  const auto vect = random_amplitudes(8, 12);
+
+  // When
+  size_t rejected = 0;
+  try {
+    const KroneckerOperator empty(std::vector<ComplexVectMatrix>{});
+  } catch (const std::invalid_argument &) {
+    rejected++;
+  }
+  try {
+    const KroneckerOperator empty_factor({ComplexVectMatrix()});
+  } catch (const std::invalid_argument &) {
+    rejected++;
+  }
+  try {
+    (void)op.apply(*vect);
+  } catch (const std::invalid_argument &) {
+    rejected++;
+  }
+  try {
+    (void)op.get(4, 0);
+  } catch (const std::out_of_range &) {
+    rejected++;
+  }
+
+  // Then
+  return rejected == 4;
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_materialise_as_tensor_product",
+           it_should_materialise_as_tensor_product, failed, total, true);
+
+  run_test("it_should_apply_to_vectors", it_should_apply_to_vectors, failed,
+           total, true);
+
+  run_test("it_should_not_depend_on_thread_count",
+           it_should_not_depend_on_thread_count, failed, total, true);
+
+  run_test("it_should_reject_invalid_operands",
+           it_should_reject_invalid_operands, failed, total, true);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}
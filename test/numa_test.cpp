@@ -0,0 +1,190 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "dense_state.h"
+#include "hilbert_namespace_test.h"
+#include "numa.h"
+#include "parallel.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+bool it_should_list_nodes() {
+  // Given
+  const auto nodes = Numa::nodes();
+
+  // When
+  size_t num_cpus = 0;
+  for (const auto &node : nodes) {
+    num_cpus += node.size();
+  }
+
+  // Then
+  return !nodes.empty() &&
+         std::all_of(nodes.begin(), nodes.end(),
+                     [](const auto &node) { return !node.empty(); }) &&
+         num_cpus <= std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool it_should_pin_thread() {
+  // Given
+  const auto cpu = Numa::nodes().front().front();
+  bool pinned = false;
+
+  // When
+  std::thread([cpu, &pinned] { pinned = Numa::pin_thread({cpu}); }).join();
+
+  // Then
+#ifdef __linux__
+  return pinned;
+#else
+  return !pinned;
+#endif
+}
+
+bool it_should_first_touch_zeros() {
+  // Given
+  constexpr size_t count = (size_t(1) << 18) + 5;
+  FirstTouchVector<__complex_precision> buffer(count);
+
+  // When
+  Numa::first_touch(buffer.data(), count);
+
+  // Then
+  return std::all_of(buffer.begin(), buffer.end(),
+                     [](__complex_precision x) { return x == 0; });
+}
+
+bool it_should_keep_static_chunks_on_their_thread() {
+  // Given
+  auto pool = ThreadPool(3);
+  constexpr size_t count = 1000;
+  std::vector<std::thread::id> first(count), second(count);
+
+  // When
+  pool.parallel_for(
+      count,
+      [&first](size_t start, size_t end) {
+        std::fill(first.begin() + start, first.begin() + end,
+                  std::this_thread::get_id());
+      },
+      1, Schedule::Static);
+  pool.parallel_for(
+      count,
+      [&second](size_t start, size_t end) {
+        std::fill(second.begin() + start, second.begin() + end,
+                  std::this_thread::get_id());
+      },
+      1, Schedule::Static);
+
+  // Then
+  return first == second;
+}
+
+bool it_should_cut_static_chunks_alike() {
+  // Given
+  auto &pool = ThreadPool::instance();
+  const auto num_workers = pool.num_workers();
+  constexpr size_t count = size_t(1) << 20;
+  constexpr size_t block = size_t(1) << 14;
+  std::vector<std::thread::id> elements(count), blocks(count);
+
+  // When
+  pool.resize(3);
+  parallel_for_static(count, [&elements](size_t start, size_t end) {
+    std::fill(elements.begin() + start, elements.begin() + end,
+              std::this_thread::get_id());
+  });
+  parallel_for_static(
+      count,
+      [&blocks](size_t start, size_t end) {
+        for (size_t b = start; b < end; b += block) {
+          std::fill(blocks.begin() + b, blocks.begin() + b + block,
+                    std::this_thread::get_id());
+        }
+      },
+      block);
+  pool.resize(num_workers);
+
+  // Then
+  return elements == blocks;
+}
+
+bool it_should_create_zero_state_in_parallel() {
+  // Given
+  constexpr size_t num_qubits = 20;
+
+  // When
+  const auto state = DenseState(num_qubits);
+
+  // Then
+  if (state.get(0) != Complex(1)) {
+    return false;
+  }
+  for (size_t i = 1; i < state.size(); i++) {
+    if (state.get(i) != Complex(0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool it_should_report_node_bandwidth() {
+  // Given
+  constexpr size_t bytes = size_t(1) << 26;
+
+  // When
+  auto perf_test = pt_start("bandwidth of each node");
+  const auto bandwidth = Numa::node_bandwidth(bytes);
+  pt_stop(perf_test);
+  for (size_t node = 0; node < bandwidth.size(); node++) {
+    print_info("Node " + std::to_string(node) + ": " +
+               std::to_string(bandwidth[node]) + " GB/s");
+  }
+
+  // Then
+  return bandwidth.size() == Numa::nodes().size() &&
+         std::all_of(bandwidth.begin(), bandwidth.end(),
+                     [](double gb_per_s) { return gb_per_s > 0; });
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_list_nodes", it_should_list_nodes, failed, total, true);
+
+  run_test("it_should_pin_thread", it_should_pin_thread, failed, total, true);
+
+  run_test("it_should_first_touch_zeros", it_should_first_touch_zeros, failed,
+           total, true);
+
+  run_test("it_should_keep_static_chunks_on_their_thread",
+           it_should_keep_static_chunks_on_their_thread, failed, total, true);
+
+  run_test("it_should_cut_static_chunks_alike",
+           it_should_cut_static_chunks_alike, failed, total, true);
+
+  run_test("it_should_create_zero_state_in_parallel",
+           it_should_create_zero_state_in_parallel, failed, total, true);
+
+  run_test("it_should_report_node_bandwidth", it_should_report_node_bandwidth,
+           failed, total, false);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,225 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "dense_state.h"
+#include "hilbert_namespace_test.h"
+#include "reduction.h"
+#include "simd.h"
+#include "thread_pool.h"
+#include <cmath>
+#include <complex>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * `size` random floats in [-1, 1).
+ */
+std::vector<float> random_floats(const size_t size, const unsigned seed) {
+  std::mt19937 gen(seed);
+  std::uniform_real_distribution<float> dist(-1, 1);
+  std::vector<float> values(size);
+  for (auto &v : values) {
+    v = dist(gen);
+  }
+  return values;
+}
+
+bool close_to(const double actual, const long double expected) {
+  return std::abs(actual - static_cast<double>(expected)) <=
+         1e-13 * (1 + std::abs(static_cast<double>(expected)));
+}
+
+bool it_should_sum_in_double_precision() {
+  // Given: many terms, so that a float accumulator would drift.
+  constexpr size_t size = 1000003;
+  const auto values = random_floats(size, 1);
+  long double expected = 0;
+  for (const auto v : values) {
+    expected += v;
+  }
+
+  // When
+  const auto actual = Reduction::sum(values.data(), size);
+
+  // Then
+  return close_to(actual, expected);
+}
+
+bool it_should_compute_norm_inner_product_and_mass() {
+  // Given
+  constexpr size_t size = 10007;
+  const auto a = random_floats(size, 2);
+  const auto b = random_floats(size, 3);
+  const auto c = random_floats(size, 4);
+  const auto d = random_floats(size, 5);
+  constexpr size_t mask = 0b101;
+  constexpr size_t value = 0b100;
+  long double norm = 0, mass = 0, product_real = 0, product_imag = 0;
+  for (size_t i = 0; i < size; i++) {
+    const long double ai = a[i], bi = b[i], ci = c[i], di = d[i];
+    norm += ai * ai + bi * bi;
+    if ((i & mask) == value) {
+      mass += ai * ai + bi * bi;
+    }
+    product_real += ai * ci + bi * di;
+    product_imag += ai * di - bi * ci;
+  }
+
+  // When
+  const auto actual_norm = Reduction::norm(a.data(), b.data(), size);
+  const auto actual_mass =
+      Reduction::mass(a.data(), b.data(), size, mask, value);
+  const auto actual_product =
+      Reduction::inner_product(a.data(), b.data(), c.data(), d.data(), size);
+
+  // Then
+  return close_to(actual_norm, std::sqrt(norm)) &&
+         close_to(actual_mass, mass) &&
+         close_to(actual_product.real(), product_real) &&
+         close_to(actual_product.imag(), product_imag);
+}
+
+bool it_should_not_depend_on_thread_count() {
+  // Given
+  constexpr size_t size = (size_t(1) << 20) + 5;
+  const auto real = random_floats(size, 6);
+  const auto imag = random_floats(size, 7);
+  auto &pool = ThreadPool::instance();
+  const auto initial = pool.num_workers();
+
+  // When
+  std::vector<double> norms;
+  std::vector<std::complex<double>> sums;
+  for (const size_t workers : {0, 1, 2, 5, 7}) {
+    pool.resize(workers);
+    norms.push_back(Reduction::norm(real.data(), imag.data(), size));
+    sums.push_back(Reduction::sum(real.data(), imag.data(), size));
+  }
+  pool.resize(initial);
+
+  // Then: bit for bit.
+  for (size_t i = 1; i < norms.size(); i++) {
+    if (norms[i] != norms[0] || sums[i] != sums[0]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool it_should_not_depend_on_instruction_set() {
+  // Given: single-precision inputs, whose products are exact in double.
+  constexpr size_t size = (size_t(1) << 14) + 13;
+  const auto real = random_floats(size, 8);
+  const auto imag = random_floats(size, 9);
+  const auto initial = simd::isa();
+
+  // When
+  std::vector<double> masses;
+  std::vector<std::complex<double>> products;
+  for (const auto isa : {Isa::Scalar, Isa::Sse, Isa::Avx2, Isa::Avx512}) {
+    if (!simd::is_supported(isa)) {
+      continue;
+    }
+    simd::set_isa(isa);
+    masses.push_back(
+        Reduction::mass(real.data(), imag.data(), size, 0b1010, 0b1000));
+    products.push_back(Reduction::inner_product(
+        real.data(), imag.data(), imag.data(), real.data(), size));
+  }
+  simd::set_isa(initial);
+
+  // Then: bit for bit.
+  for (size_t i = 1; i < masses.size(); i++) {
+    if (masses[i] != masses[0] || products[i] != products[0]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool it_should_reduce_large_vectors_quickly() {
+  // Given
+  constexpr size_t size = size_t(1) << 26;
+  const auto real = random_floats(size, 10);
+  const auto imag = random_floats(size, 11);
+  const auto bytes = 2 * size * sizeof(float);
+
+  // When
+  auto perf_test_sum = pt_start(std::to_string(size) + " elements sum", bytes);
+  const auto sum = Reduction::sum(real.data(), imag.data(), size);
+  pt_stop(perf_test_sum);
+
+  auto perf_test_product =
+      pt_start(std::to_string(size) + " elements inner product", 2 * bytes);
+  const auto product = Reduction::inner_product(real.data(), imag.data(),
+                                                real.data(), imag.data(), size);
+  pt_stop(perf_test_product);
+
+  // Then: the inputs average to zero, and <x|x> is real.
+  return std::abs(sum) < 1e-2 * size && product.imag() == 0 &&
+         product.real() > 0;
+}
+
+bool it_should_reduce_large_state() {
+  // Given
+  constexpr size_t num_qubits = 26;
+  auto state = DenseState(num_qubits);
+  for (size_t t = 0; t < num_qubits; t++) {
+    state.apply_gate(*ComplexVectMatrix::hadamard_2x2(), t);
+  }
+  const auto bytes = 2 * state.size() * sizeof(__complex_precision);
+
+  // When
+  auto perf_test_norm =
+      pt_start(std::to_string(num_qubits) + " qubits norm", bytes);
+  const auto norm = state.norm();
+  pt_stop(perf_test_norm);
+
+  auto perf_test_probability =
+      pt_start(std::to_string(num_qubits) + " qubits probability", bytes);
+  const auto probability = state.probability(num_qubits - 1);
+  pt_stop(perf_test_probability);
+
+  // Then
+  print_info("Norm error: " + std::to_string(std::abs(norm - 1)));
+  return std::abs(norm - 1) < 1e-5 && std::abs(probability - 0.5) < 1e-5;
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_sum_in_double_precision",
+           it_should_sum_in_double_precision, failed, total, true);
+
+  run_test("it_should_compute_norm_inner_product_and_mass",
+           it_should_compute_norm_inner_product_and_mass, failed, total, true);
+
+  run_test("it_should_not_depend_on_thread_count",
+           it_should_not_depend_on_thread_count, failed, total, true);
+
+  run_test("it_should_not_depend_on_instruction_set",
+           it_should_not_depend_on_instruction_set, failed, total, true);
+
+  run_test("it_should_reduce_large_vectors_quickly",
+           it_should_reduce_large_vectors_quickly, failed, total, false);
+
+  run_test("it_should_reduce_large_state", it_should_reduce_large_state,
+           failed, total, false);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "algebra_engine.h"
+#include "hilbert_namespace_test.h"
+#include "scratch_arena.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+
+bool is_aligned(const __complex_precision *p) {
+  return reinterpret_cast<std::uintptr_t>(p) % 64 == 0;
+}
+
+bool it_should_align_and_pad_buffers() {
+  // Given
+  ScratchArena arena;
+  auto *dirty = arena.allocate(64);
+  std::fill(dirty, dirty + 64, 1);
+  arena.reset();
+
+  // When
+  auto *first = arena.allocate(5);
+  auto *second = arena.allocate(17);
+
+  // Then
+  return is_aligned(first) && is_aligned(second) &&
+         second - first == ScratchArena::line_elements &&
+         std::all_of(first + 5, first + ScratchArena::line_elements,
+                     [](__complex_precision x) { return x == 0; }) &&
+         std::all_of(second + 17, second + 2 * ScratchArena::line_elements,
+                     [](__complex_precision x) { return x == 0; });
+}
+
+bool it_should_rewind_nested_scopes() {
+  // Given
+  ScratchArena arena;
+  const auto before = arena.allocate(3);
+  __complex_precision *outer = nullptr;
+  __complex_precision *inner = nullptr;
+
+  // When
+  {
+    ScratchArena::Scope outer_scope(arena);
+    outer = arena.allocate(100);
+    {
+      ScratchArena::Scope inner_scope(arena);
+      inner = arena.allocate(100);
+    }
+    if (arena.allocate(100) != inner) {
+      return false;
+    }
+  }
+  auto *after = arena.allocate(100);
+
+  // Then
+  return before != outer && after == outer;
+}
+
+bool it_should_keep_buffers_across_blocks() {
+  // Given
+  ScratchArena arena;
+  constexpr size_t size = ScratchArena::min_block_elements / 2 + 1;
+  std::vector<__complex_precision *> buffers;
+
+  // When
+  for (size_t b = 0; b < 8; b++) {
+    buffers.push_back(arena.allocate(size));
+    std::fill(buffers.back(), buffers.back() + size, b);
+  }
+
+  // Then
+  for (size_t b = 0; b < buffers.size(); b++) {
+    if (!std::all_of(buffers[b], buffers[b] + size,
+                     [b](__complex_precision x) { return x == b; })) {
+      return false;
+    }
+  }
+  return arena.num_blocks() > 1;
+}
+
+bool it_should_stop_growing_once_warm() {
+  // Given
+  ScratchArena arena;
+  constexpr size_t size = ScratchArena::min_block_elements;
+  for (size_t b = 0; b < 4; b++) {
+    (void)arena.allocate(size);
+  }
+  arena.reset();
+  const auto capacity = arena.capacity();
+
+  // When
+  for (size_t round = 0; round < 10; round++) {
+    ScratchArena::Scope scope(arena);
+    for (size_t b = 0; b < 4; b++) {
+      (void)arena.allocate(size);
+    }
+  }
+
+  // Then
+  return arena.num_blocks() == 1 && arena.capacity() == capacity;
+}
+
+bool it_should_give_each_thread_its_arena() {
+  // Given
+  const auto *main_arena = &ScratchArena::local();
+  const ScratchArena *other_arena = nullptr;
+
+  // When
+  std::thread([&other_arena] { other_arena = &ScratchArena::local(); }).join();
+
+  // Then
+  return main_arena == &ScratchArena::local() && other_arena != main_arena;
+}
+
+bool it_should_multiply_into_scratch() {
+  // Given
+  constexpr size_t size = 37;
+  const auto left = random_amplitudes(size, 1)->split();
+  const auto right = random_amplitudes(size, 2)->split();
+  ScratchArena::Scope scope;
+  auto &arena = ScratchArena::local();
+  auto *real = arena.allocate(size);
+  auto *imag = arena.allocate(size);
+
+  // When
+  simd::cvmul(left->real_data(), left->imag_data(), right->real_data(),
+              right->imag_data(), real, imag, left->padded_size());
+  const auto expected = simd::cvmul(*left, *right);
+
+  // Then
+  for (size_t i = 0; i < size; i++) {
+    if (Complex(real[i], imag[i]) != expected->get(i)) {
+      return false;
+    }
+  }
+  return simd::cvsve(real, imag, left->padded_size()) ==
+         simd::cvsve(*expected);
+}
+
+bool it_should_multiply_large_matrices() {
+  // Given
+  constexpr size_t size = 512;
+  const auto amplitudes = random_amplitudes(size * size, 3);
+  ComplexVector elements(size * size);
+  for (size_t i = 0; i < elements.size(); i++) {
+    elements[i] = amplitudes->get(0, i);
+  }
+  const ComplexVectMatrix left(elements, size, size);
+  const auto identity =
+      AlgebraEngine::tensor_product(*ComplexVectMatrix::identity_2x2(), 9)
+          ->to_matrix();
+
+  // When
+  auto perf_test = pt_start("multiplying two 512x512 matrices");
+  const auto product = AlgebraEngine::matrix_multiplication(left, *identity);
+  const auto result = product->to_matrix();
+  pt_stop(perf_test);
+
+  // Then
+  return *result == left;
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_align_and_pad_buffers", it_should_align_and_pad_buffers,
+           failed, total, true);
+
+  run_test("it_should_rewind_nested_scopes", it_should_rewind_nested_scopes,
+           failed, total, true);
+
+  run_test("it_should_keep_buffers_across_blocks",
+           it_should_keep_buffers_across_blocks, failed, total, true);
+
+  run_test("it_should_stop_growing_once_warm",
+           it_should_stop_growing_once_warm, failed, total, true);
+
+  run_test("it_should_give_each_thread_its_arena",
+           it_should_give_each_thread_its_arena, failed, total, true);
+
+  run_test("it_should_multiply_into_scratch", it_should_multiply_into_scratch,
+           failed, total, true);
+
+  run_test("it_should_multiply_large_matrices",
+           it_should_multiply_large_matrices, failed, total, false);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,521 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "complex_vector_split.h"
+#include "dense_state.h"
+#include "hilbert_namespace_test.h"
+#include "simd.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * Random split vector of `size` elements, with values in [-1, 1).
+ */
+ComplexVectSplit random_split(const size_t size, const unsigned seed) {
+  return ComplexVectSplit(*random_amplitudes(size, seed)->split());
+}
+
+/*
+ * Whether `actual` matches `expected` relative to its magnitude, as sums of
+ * many single-precision products drift past a fixed tolerance.
+ */
+bool close_to(const Complex actual, const Complex expected) {
+  return std::abs(actual - expected) <= 1e-5 * (1 + std::abs(expected));
+}
+
+bool it_should_compute_cdotu() {
+  // Given
+  constexpr size_t size = 77;
+  const auto x = random_split(size, 1);
+  const auto y = random_split(size, 2);
+  Complex expected = 0;
+  for (size_t i = 0; i < size; i++) {
+    expected += x.get(i) * y.get(i);
+  }
+
+  // When
+  const auto actual = simd::cdotu(x, y);
+
+  // Then
+  return close_to(actual, expected);
+}
+
+bool it_should_compute_cdotc() {
+  // Given
+  constexpr size_t size = 77;
+  const auto x = random_split(size, 3);
+  const auto y = random_split(size, 4);
+  Complex expected = 0;
+  for (size_t i = 0; i < size; i++) {
+    expected += std::conj(x.get(i)) * y.get(i);
+  }
+
+  // When
+  const auto actual = simd::cdotc(x, y);
+
+  // Then
+  return close_to(actual, expected) && close_to(simd::cdotc(x, x).imag(), 0);
+}
+
+bool it_should_compute_caxpy() {
+  // Given
+  constexpr size_t size = 19;
+  const Complex a(0.5, -2);
+  const auto x = random_split(size, 5);
+  auto y = random_split(size, 6);
+  const auto y_before = *y.get();
+
+  // When
+  simd::caxpy(a, x, y.span());
+
+  // Then
+  for (size_t i = 0; i < size; i++) {
+    if (!approx_equal(y.get(i), a * x.get(i) + y_before[i])) {
+      return false;
+    }
+  }
+  return y.real_data()[size] == 0 && y.imag_data()[size] == 0;
+}
+
+bool it_should_compute_cscal() {
+  // Given
+  constexpr size_t size = 19;
+  const Complex a(-1, 3);
+  auto x = random_split(size, 7);
+  const auto x_before = *x.get();
+
+  // When
+  simd::cscal(a, x.span());
+
+  // Then
+  for (size_t i = 0; i < size; i++) {
+    if (!approx_equal(x.get(i), a * x_before[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool it_should_compute_cnrm2() {
+  // Given
+  const auto x = ComplexVectSplit(std::vector<Complex>(
+      {{3, 4}, {0, 0}, {1, -2}, {2, 0}, {0, 1}, {1, 1}, {0, 0}, {2, 2},
+       {0, 3}}));
+
+  // When
+  const auto norm = simd::cnrm2(x);
+
+  // Then
+  return std::abs(norm - std::sqrt(54.f)) < 1e-5;
+}
+
+bool it_should_compute_large_cdotc() {
+  // Given
+  constexpr size_t size = size_t(1) << 22;
+  const auto x = ComplexVectSplit(std::vector<Complex>(size, {0.5, -0.5}));
+  const auto y = ComplexVectSplit(std::vector<Complex>(size, {1, 1}));
+
+  // When
+  auto perf_test = pt_start("conjugated dot product of " +
+                                std::to_string(size) + " elements",
+                            4 * sizeof(__complex_precision) * size);
+  const auto actual = simd::cdotc(x, y);
+  pt_stop(perf_test);
+
+  // Then
+  return close_to(actual, Complex(0, size));
+}
+
+bool it_should_multiply_split_and_interleaved_alike() {
+  // Given: the same vectors, split and interleaved.
+  constexpr size_t size = size_t(1) << 22;
+  const auto left = random_split(size, 10);
+  const auto right = random_split(size, 11);
+  std::vector<Complex> left_interleaved(size), right_interleaved(size);
+  for (size_t i = 0; i < size; i++) {
+    left_interleaved[i] = left.get(i);
+    right_interleaved[i] = right.get(i);
+  }
+  std::vector<Complex> interleaved(size);
+  const auto bytes = 6 * sizeof(__complex_precision) * size;
+
+  // When
+  auto perf_test_split = pt_start(
+      "split multiplication of " + std::to_string(size) + " elements", bytes);
+  const auto split = simd::cvmul(left, right);
+  pt_stop(perf_test_split);
+
+  auto perf_test_interleaved =
+      pt_start("interleaved multiplication of " + std::to_string(size) +
+                   " elements",
+               bytes);
+  for (size_t i = 0; i < size; i++) {
+    const auto a = left_interleaved[i];
+    const auto b = right_interleaved[i];
+    interleaved[i] = Complex(a.real() * b.real() - a.imag() * b.imag(),
+                             a.real() * b.imag() + a.imag() * b.real());
+  }
+  pt_stop(perf_test_interleaved);
+
+  // Then
+  for (size_t i = 0; i < size; i++) {
+    if (!approx_equal(split->get(i), interleaved[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/*
+ * Applies every gate kernel, on each target, with and without a control, to
+ * a random state of `num_qubits` qubits, on the selected instruction set, or
+ * through the portable kernels when `portable` is set.
+ */
+ComplexVectSplit apply_every_gate(const size_t num_qubits,
+                                  const bool portable = false) {
+  const size_t size = size_t(1) << num_qubits;
+  auto state = random_split(size, static_cast<unsigned>(num_qubits));
+  auto *real = state.real_data();
+  auto *imag = state.imag_data();
+  const std::array<Complex, 4> u = {Complex(0.6, 0.1), Complex(-0.2, 0.7),
+                                    Complex(0.5, -0.3), Complex(0.1, 0.4)};
+  const auto kq = random_split(16, 100);
+
+  for (size_t t = 0; t < num_qubits; t++) {
+    const size_t other = (t + 1) % num_qubits;
+    const size_t control =
+        num_qubits > 2 ? size_t(1) << ((t + 2) % num_qubits) : 0;
+    for (const size_t controls : {size_t(0), control}) {
+      if (portable) {
+        simd::gate_1q_scalar(real, imag, size, t, controls, u);
+        simd::gate_diagonal_scalar(real, imag, size, t, controls,
+                                   Complex(0.8, 0.6), Complex(0, 1));
+        simd::permute_flip_scalar(real, imag, size, t, controls);
+        if (other != t) {
+          simd::permute_swap_scalar(real, imag, size, std::min(t, other),
+                                    std::max(t, other), controls);
+          simd::gate_kq_scalar(real, imag, size, {t, other}, controls,
+                               kq.real_data(), kq.imag_data(), size_t(4));
+        }
+        continue;
+      }
+      simd::gate_1q(real, imag, size, t, controls, u);
+      simd::gate_diagonal(real, imag, size, t, controls, {0.8, 0.6}, {0, 1});
+      simd::permute_flip(real, imag, size, t, controls);
+      if (other != t) {
+        simd::permute_swap(real, imag, size, t, other, controls);
+        simd::gate_kq(real, imag, size, {t, other}, controls, kq.real_data(),
+                      kq.imag_data(), 4);
+      }
+    }
+  }
+  return state;
+}
+
+/*
+ * `apply_every_gate` on a double-precision state.
+ */
+DoubleDenseState apply_every_double_gate(const size_t num_qubits) {
+  const size_t size = size_t(1) << num_qubits;
+  auto state = DoubleDenseState(
+      *random_amplitudes(size, static_cast<unsigned>(num_qubits)));
+  auto *real = state.real_data();
+  auto *imag = state.imag_data();
+  using C = std::complex<double>;
+  const std::array<C, 4> u = {C(0.6, 0.1), C(-0.2, 0.7), C(0.5, -0.3),
+                              C(0.1, 0.4)};
+  const auto kq = random_split(16, 100);
+  const std::vector<double> kq_real(kq.real_span().begin(),
+                                    kq.real_span().end());
+  const std::vector<double> kq_imag(kq.imag_span().begin(),
+                                    kq.imag_span().end());
+
+  for (size_t t = 0; t < num_qubits; t++) {
+    const size_t other = (t + 1) % num_qubits;
+    const size_t control =
+        num_qubits > 2 ? size_t(1) << ((t + 2) % num_qubits) : 0;
+    for (const size_t controls : {size_t(0), control}) {
+      simd::gate_1q(real, imag, size, t, controls, u);
+      simd::gate_diagonal(real, imag, size, t, controls, {0.8, 0.6}, {0, 1});
+      simd::permute_flip(real, imag, size, t, controls);
+      if (other != t) {
+        simd::permute_swap(real, imag, size, t, other, controls);
+        simd::gate_kq(real, imag, size, {t, other}, controls, kq_real.data(),
+                      kq_imag.data(), 4);
+      }
+    }
+  }
+  return state;
+}
+
+bool it_should_select_isa() {
+  // Given
+  const auto initial = simd::isa();
+
+  // When
+  simd::set_isa(Isa::Scalar);
+  const auto selected = simd::isa();
+  bool rejected = false;
+  try {
+    simd::set_isa(Isa::Avx512);
+  } catch (const std::invalid_argument &) {
+    rejected = true;
+  }
+  simd::set_isa(initial);
+
+  // Then
+  return simd::is_supported(initial) && selected == Isa::Scalar &&
+         rejected != simd::is_supported(Isa::Avx512);
+}
+
+bool it_should_parse_isa_names() {
+  // Given
+  const std::array isas = {Isa::Scalar, Isa::Sse, Isa::Avx2, Isa::Avx512};
+
+  // When
+  bool round_trips = true;
+  for (const auto isa : isas) {
+    round_trips &= simd::parse_isa(simd::isa_name(isa)) == isa;
+  }
+  bool rejected = false;
+  try {
+    (void)simd::parse_isa("avx3");
+  } catch (const std::invalid_argument &) {
+    rejected = true;
+  }
+
+  // Then
+  return round_trips && rejected && simd::isa_name(Isa::Avx2) == "avx2";
+}
+
+bool it_should_honour_isa_override() {
+  // Given
+  const char *name = std::getenv("HILBERT_ISA");
+  if (name == nullptr) {
+    print_info("HILBERT_ISA is not set, skipping");
+    return true;
+  }
+
+  // When
+  const auto isa = simd::isa();
+
+  // Then
+  return isa == simd::parse_isa(name);
+}
+
+bool it_should_apply_gates_alike_on_every_isa() {
+  // Given
+  const auto initial = simd::isa();
+
+  for (const auto isa : {Isa::Sse, Isa::Avx2, Isa::Avx512}) {
+    if (!simd::is_supported(isa)) {
+      print_info(std::string(simd::isa_name(isa)) + " is not available");
+      continue;
+    }
+    for (size_t n = 1; n <= 8; n++) {
+      // When
+      simd::set_isa(Isa::Scalar);
+      const auto scalar = apply_every_gate(n);
+      simd::set_isa(isa);
+      const auto vectorised = apply_every_gate(n);
+      simd::set_isa(initial);
+
+      // Then
+      for (size_t i = 0; i < scalar.size(); i++) {
+        if (!approx_equal(scalar.get(i), vectorised.get(i))) {
+          return false;
+        }
+      }
+      for (size_t i = vectorised.size(); i < vectorised.padded_size(); i++) {
+        if (vectorised.real_data()[i] != 0 ||
+            vectorised.imag_data()[i] != 0) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool it_should_apply_gates_alike_through_portable_kernels() {
+  for (size_t n = 1; n <= 8; n++) {
+    // When
+    const auto vectorised = apply_every_gate(n);
+    const auto portable = apply_every_gate(n, true);
+
+    // Then
+    for (size_t i = 0; i < portable.size(); i++) {
+      if (!approx_equal(portable.get(i), vectorised.get(i))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool it_should_sum_leaves_alike_through_portable_kernels() {
+  // Given: a last block that is not full.
+  constexpr size_t length = 1021;
+  const auto values = random_split(length, 11);
+  const auto *real = values.real_data();
+  const auto *imag = values.imag_data();
+
+  // When
+  const auto vectorised = simd::leaf_cdotc(real, imag, imag, real, length);
+  const auto portable =
+      simd::leaf_scalar<std::complex<double>>(length, [=](const size_t i) {
+        // (a - bi)(c + di) = (ac + bd) + i(ad - bc)
+        const double a = real[i], b = imag[i], c = imag[i], d = real[i];
+        return std::complex<double>(a * c + b * d, a * d - b * c);
+      });
+
+  // Then: bit for bit, as single-precision products are exact in double.
+  return vectorised == portable;
+}
+
+bool it_should_apply_double_gates_alike_on_every_isa() {
+  // Given
+  const auto initial = simd::isa();
+
+  for (const auto isa : {Isa::Sse, Isa::Avx2, Isa::Avx512}) {
+    if (!simd::is_supported(isa)) {
+      continue;
+    }
+    for (size_t n = 1; n <= 8; n++) {
+      // When
+      simd::set_isa(Isa::Scalar);
+      const auto scalar = apply_every_double_gate(n);
+      simd::set_isa(isa);
+      const auto vectorised = apply_every_double_gate(n);
+      simd::set_isa(initial);
+
+      // Then
+      for (size_t i = 0; i < scalar.size(); i++) {
+        const auto expected = scalar.get(i);
+        if (std::abs(vectorised.get(i) - expected) >
+            1e-12 * (1 + std::abs(expected))) {
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+bool it_should_mask_tails_on_every_isa() {
+  // Given
+  constexpr size_t length = 13;
+  auto left = random_split(16, 8);
+  auto right = random_split(16, 9);
+  Complex expected_sum = 0;
+  for (size_t i = 0; i < 16; i++) {
+    if (i < length) {
+      expected_sum += left.get(i);
+    } else {
+      left.set(i, {100, 100});
+      right.set(i, {100, 100});
+    }
+  }
+  const auto initial = simd::isa();
+
+  for (const auto isa : {Isa::Scalar, Isa::Sse, Isa::Avx2, Isa::Avx512}) {
+    if (!simd::is_supported(isa)) {
+      continue;
+    }
+
+    // When
+    simd::set_isa(isa);
+    auto product = ComplexVectSplit(std::vector<Complex>(16, {7, 7}));
+    simd::cvmul(left.real_data(), left.imag_data(), right.real_data(),
+                right.imag_data(), product.real_data(), product.imag_data(),
+                length);
+    const auto sum = simd::cvsve(left.real_data(), left.imag_data(), length);
+    simd::set_isa(initial);
+
+    // Then
+    for (size_t i = 0; i < 16; i++) {
+      const auto expected =
+          i < length ? left.get(i) * right.get(i) : Complex(7, 7);
+      if (!approx_equal(product.get(i), expected)) {
+        return false;
+      }
+    }
+    if (!close_to(sum, expected_sum)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_compute_cdotu", it_should_compute_cdotu, failed, total,
+           true);
+
+  run_test("it_should_compute_cdotc", it_should_compute_cdotc, failed, total,
+           true);
+
+  run_test("it_should_compute_caxpy", it_should_compute_caxpy, failed, total,
+           true);
+
+  run_test("it_should_compute_cscal", it_should_compute_cscal, failed, total,
+           true);
+
+  run_test("it_should_compute_cnrm2", it_should_compute_cnrm2, failed, total,
+           true);
+
+  run_test("it_should_select_isa", it_should_select_isa, failed, total, true);
+
+  run_test("it_should_parse_isa_names", it_should_parse_isa_names, failed,
+           total, true);
+
+  run_test("it_should_honour_isa_override", it_should_honour_isa_override,
+           failed, total, true);
+
+  run_test("it_should_apply_gates_alike_on_every_isa",
+           it_should_apply_gates_alike_on_every_isa, failed, total, true);
+
+  run_test("it_should_apply_gates_alike_through_portable_kernels",
+           it_should_apply_gates_alike_through_portable_kernels, failed, total,
+           true);
+
+  run_test("it_should_sum_leaves_alike_through_portable_kernels",
+           it_should_sum_leaves_alike_through_portable_kernels, failed, total,
+           true);
+
+  run_test("it_should_apply_double_gates_alike_on_every_isa",
+           it_should_apply_double_gates_alike_on_every_isa, failed, total,
+           true);
+
+  run_test("it_should_mask_tails_on_every_isa",
+           it_should_mask_tails_on_every_isa, failed, total, true);
+
+  run_test("it_should_compute_large_cdotc", it_should_compute_large_cdotc,
+           failed, total, false);
+
+  run_test("it_should_multiply_split_and_interleaved_alike",
+           it_should_multiply_split_and_interleaved_alike, failed, total,
+           false);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,237 @@
+// Copyright 2025 Lorenzo Fritzsch
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "algebra_engine.h"
+#include "complex_vectorised_matrix.h"
+#include "hilbert_namespace_test.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+bool it_should_cover_every_index_once() {
+  // Given
+  auto pool = ThreadPool(3);
+  constexpr size_t count = 10007;
+  std::vector<std::atomic<int>> visits(count);
+
+  // When
+  pool.parallel_for(count, [&visits](size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+      visits[i]++;
+    }
+  });
+
+  // Then
+  for (const auto &v : visits) {
+    if (v != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool it_should_run_small_loops_on_caller() {
+  // Given
+  auto pool = ThreadPool(3);
+  const auto caller = std::this_thread::get_id();
+  bool on_caller = true;
+
+  // When
+  pool.parallel_for(
+      64,
+      [&on_caller, caller](size_t, size_t) {
+        on_caller = on_caller && std::this_thread::get_id() == caller;
+      },
+      64);
+
+  // Then
+  return on_caller;
+}
+
+bool it_should_run_nested_loops() {
+  // Given
+  auto pool = ThreadPool(3);
+  std::atomic<size_t> sum = 0;
+
+  // When
+  pool.parallel_for(16, [&pool, &sum](size_t start, size_t end) {
+    for (size_t i = start; i < end; i++) {
+      pool.parallel_for(100, [&sum](size_t inner_start, size_t inner_end) {
+        sum += inner_end - inner_start;
+      });
+    }
+  });
+
+  // Then
+  return sum == 1600;
+}
+
+bool it_should_rethrow_from_workers() {
+  // Given
+  auto pool = ThreadPool(3);
+
+  // When
+  try {
+    pool.parallel_for(1000, [](size_t start, size_t end) {
+      if (start <= 500 && 500 < end) {
+        throw std::runtime_error("Chunk failed");
+      }
+    });
+  } catch (const std::runtime_error &) {
+    // Then
+    return true;
+  }
+  return false;
+}
+
+/*
+ * Counts the leaves of a binary tree of the given depth, one task per branch.
+ */
+size_t count_leaves(ThreadPool &pool, const size_t depth) {
+  if (depth == 0) {
+    return 1;
+  }
+  auto left = pool.submit([&pool, depth] {
+    return count_leaves(pool, depth - 1);
+  });
+  const auto right = count_leaves(pool, depth - 1);
+  return pool.wait(left) + right;
+}
+
+bool it_should_run_nested_tasks() {
+  // Given
+  auto pool = ThreadPool(3);
+
+  // When
+  const auto leaves = count_leaves(pool, 12);
+
+  // Then
+  return leaves == 4096;
+}
+
+bool it_should_rethrow_from_tasks() {
+  // Given
+  auto pool = ThreadPool(3);
+  auto future = pool.submit([]() -> int {
+    throw std::runtime_error("Task failed");
+  });
+
+  // When
+  try {
+    pool.wait(future);
+  } catch (const std::runtime_error &) {
+    // Then
+    return true;
+  }
+  return false;
+}
+
+bool it_should_run_static_loops_while_workers_wait() {
+  // Given
+  auto pool = ThreadPool(1);
+  std::promise<void> release;
+  auto released = release.get_future();
+  std::atomic<bool> waiting = false;
+  auto task = pool.submit([&pool, &released, &waiting] {
+    waiting = true;
+    pool.wait(released);
+  });
+  while (!waiting) {
+    std::this_thread::yield();
+  }
+  std::atomic<size_t> sum = 0;
+
+  // When
+  pool.parallel_for(
+      1000, [&sum](size_t start, size_t end) { sum += end - start; }, 1,
+      Schedule::Static);
+  release.set_value();
+  pool.wait(task);
+
+  // Then
+  return sum == 1000;
+}
+
+bool it_should_resize() {
+  // Given
+  auto pool = ThreadPool(1);
+  std::atomic<size_t> sum = 0;
+
+  // When
+  pool.resize(4);
+  pool.parallel_for(1000, [&sum](size_t start, size_t end) {
+    sum += end - start;
+  });
+
+  // Then
+  return pool.num_workers() == 4 && sum == 1000;
+}
+
+bool it_should_materialise_small_matrices_quickly() {
+  // Given
+  constexpr size_t iterations = 20000;
+  auto h = ComplexVectMatrix(ComplexMatrix({{1, 1}, {1, -1}}));
+  bool all_equal = true;
+
+  // When
+  auto perf_test = pt_start(std::to_string(iterations) + " 2x2 products");
+  for (size_t i = 0; i < iterations; i++) {
+    auto product = AlgebraEngine::matrix_multiplication(h, h)->to_matrix();
+    all_equal = all_equal && approx_equal(product->get(0, 0), Complex(2));
+  }
+  pt_stop(perf_test);
+
+  // Then
+  return all_equal;
+}
+
+int main() {
+  int total = 0;
+  int failed = 0;
+
+  run_test("it_should_cover_every_index_once",
+           it_should_cover_every_index_once, failed, total, true);
+
+  run_test("it_should_run_small_loops_on_caller",
+           it_should_run_small_loops_on_caller, failed, total, true);
+
+  run_test("it_should_run_nested_loops", it_should_run_nested_loops, failed,
+           total, true);
+
+  run_test("it_should_rethrow_from_workers", it_should_rethrow_from_workers,
+           failed, total, true);
+
+  run_test("it_should_run_nested_tasks", it_should_run_nested_tasks, failed,
+           total, true);
+
+  run_test("it_should_rethrow_from_tasks", it_should_rethrow_from_tasks,
+           failed, total, true);
+
+  run_test("it_should_run_static_loops_while_workers_wait",
+           it_should_run_static_loops_while_workers_wait, failed, total, true);
+
+  run_test("it_should_resize", it_should_resize, failed, total, true);
+
+  run_test("it_should_materialise_small_matrices_quickly",
+           it_should_materialise_small_matrices_quickly, failed, total, false);
+
+  test_resumen(failed, total);
+  return failed == 0 ? 0 : 1;
+}